@@ -25,42 +25,63 @@ const char* Game_States::play_state_string(Play_State _play_state)
     }
 }
 
+int Game_States::pack(char cmd, Play_State ps, unsigned int version)
+{
+    return (int) ((unsigned char) cmd | ((unsigned int) ps & 0xff) << 8 | (version & 0xffff) << 16);
+}
+
+// -1 keeps the old value
+void Game_States::update_state(int cmd, int ps)
+{
+    for (;;)
+    {
+        int old_word = state_word;
+        int new_word = pack(cmd < 0 ? (char) (old_word & 0xff) : (char) cmd,
+                            (Play_State) (ps < 0 ? (old_word >> 8) & 0xff : ps),
+                            ((unsigned int) old_word >> 16) + 1);
+        if (state_word.testAndSetOrdered(old_word, new_word))
+            return;
+    }
+}
+
+Game_States::State Game_States::get_state() const
+{
+    int word = state_word;
+    State state;
+    state.refbox_cmd = (char) (word & 0xff);
+    state.play_state = (Play_State) ((word >> 8) & 0xff);
+    state.version = (unsigned int) word >> 16;
+    return state;
+}
+
+unsigned int Game_States::get_version() const
+{
+    return (unsigned int) (int) state_word >> 16;
+}
+
 const char* Game_States::play_state_string() const
 {
-    game_state_mutex.lock();
-        const char* tmp = play_state_string(play_state);
-    game_state_mutex.unlock();
-    return tmp;
+    return play_state_string(get_play_state());
 }
 
 char Game_States::get_refbox_cmd() const
 {
-    game_state_mutex.lock();
-        char tmp = this->refbox_cmd;
-    game_state_mutex.unlock();
-    return tmp;
+    return get_state().refbox_cmd;
 }
 
 void Game_States::set_refbox_cmd(char cmd)
 {
-    game_state_mutex.lock();
-        this->refbox_cmd = cmd;
-    game_state_mutex.unlock();
+    update_state((unsigned char) cmd, -1);
 }
 
 Game_States::Play_State Game_States::get_play_state() const
 {
-    game_state_mutex.lock();
-        Play_State tmp = this->play_state;
-    game_state_mutex.unlock();
-    return tmp;
+    return get_state().play_state;
 }
 
 void Game_States::set_play_state(Play_State ps)
 {
-    game_state_mutex.lock();
-        this->play_state = ps;
-    game_state_mutex.unlock();
+    update_state(-1, ps);
 }
 
 //timer_game
@@ -2,6 +2,7 @@
 #define GAME_STATES_H
 
 #include <QMutex>
+#include <QAtomicInt>
 
 #include "timer.h"
 
@@ -13,7 +14,6 @@ namespace BSmart
         Game_States()
         {
             game_time =  FIRST_HALF;
-            play_state = HALTED;
             goals.yellow = 0;
             goals.blue = 0;
             cards.yellow_yellow = 0;
@@ -25,7 +25,7 @@ namespace BSmart
             timer_timeout_blue = Timer();
             timouts_yellow = 0;
             timouts_blue = 0;
-            refbox_cmd = 'H';
+            state_word = pack('H', HALTED, 0);
             QMutex game_state_mutex();
         }
 
@@ -58,9 +58,21 @@ namespace BSmart
              PENALTY_SHOOTOUT
         };
 
+        //refbox command and play state, read without locking
+        struct State
+        {
+            char refbox_cmd;
+            Play_State play_state;
+            //changes with every set, wraps around
+            unsigned int version;
+        };
+        State get_state() const;
+        unsigned int get_version() const;
+
         char get_refbox_cmd() const;
         void set_refbox_cmd(char);
         const char* play_state_string() const;
+        static const char* play_state_string(Play_State);
         Play_State get_play_state() const;
         void set_play_state(Play_State);
 
@@ -96,7 +108,11 @@ namespace BSmart
     private:
         mutable QMutex game_state_mutex;
 
-        static const char* play_state_string(Play_State);
+        //refbox_cmd (bits 0-7), play_state (8-15) and version (16-31),
+        //written with compare and swap, so readers never block
+        QAtomicInt state_word;
+        static int pack(char, Play_State, unsigned int);
+        void update_state(int cmd, int play_state);
 
         //timers for game, actual timout and counters for taken timouts, current refbox_cmd
         Timer timer_game;
@@ -104,9 +120,7 @@ namespace BSmart
         Timer timer_timeout_blue;
         int timouts_yellow;
         int timouts_blue;
-        char refbox_cmd;
 
-        Play_State play_state;
         Game_Time game_time;
 
         //int timeouts_left;
@@ -203,6 +203,200 @@ namespace BSmart
             return false;
     }
 
+    //two doubles in one SSE register (GCC vector extension), the batch
+    //tests below work on two circles at a time
+    typedef double Double_2 __attribute__((vector_size(16)));
+    typedef long long Mask_2 __attribute__((vector_size(16)));
+
+    /**
+     * Up to CAPACITY circles with the coordinates in separate arrays, so
+     * that the batch tests below run over them in vector registers instead
+     * of one circle after another. CAPACITY covers the robots of both
+     * teams. add also fills the second slot of a pair, so the last pair
+     * never holds unset values.
+     */
+    struct Circle_Batch
+    {
+        enum { CAPACITY = 32 };
+
+        Circle_Batch(): size(0) {}
+
+        void clear() { size = 0; }
+
+        //false if the batch is full
+        bool add(double x_, double y_, double radius_)
+        {
+            if(size == CAPACITY)
+                return false;
+            x[size] = x[size | 1] = x_;
+            y[size] = y[size | 1] = y_;
+            radius[size] = radius[size | 1] = radius_;
+            ++size;
+            return true;
+        }
+
+        bool add(const Circle& circle)
+        {
+            return add(circle.x, circle.y, circle.radius);
+        }
+
+        double x[CAPACITY] __attribute__((aligned(16)));
+        double y[CAPACITY] __attribute__((aligned(16)));
+        double radius[CAPACITY] __attribute__((aligned(16)));
+        int size;
+    };
+
+    /**
+     * The intersections of a line with every circle of a Circle_Batch.
+     * Bit i of in_box is test_intersection(circle i, line), bit i of
+     * crossing is set if additionally intersection_point(circle i, line)
+     * is true. The intersection points of circle i are then
+     * line.p1 + (line.p2 - line.p1) * s for s = first[i] and s = second[i],
+     * first[i] <= second[i].
+     */
+    struct Batch_Intersections
+    {
+        int size;
+        unsigned int in_box;
+        unsigned int crossing;
+        double first[Circle_Batch::CAPACITY];
+        double second[Circle_Batch::CAPACITY];
+    };
+
+    inline Batch_Intersections intersection_points(const Line& line,
+                                                   const Circle_Batch& circles)
+    {
+        const double vx = line.p2.x - line.p1.x;
+        const double vy = line.p2.y - line.p1.y;
+        const double vv = vx*vx + vy*vy;
+        const double min_x = std::min(line.p1.x, line.p2.x);
+        const double max_x = std::max(line.p1.x, line.p2.x);
+        const double min_y = std::min(line.p1.y, line.p2.y);
+        const double max_y = std::max(line.p1.y, line.p2.y);
+
+        // the bounding boxes two circles at a time, without branches
+        const Double_2 box_min_x = {min_x, min_x};
+        const Double_2 box_max_x = {max_x, max_x};
+        const Double_2 box_min_y = {min_y, min_y};
+        const Double_2 box_max_y = {max_y, max_y};
+        unsigned int box = 0;
+        unsigned int bit = 1;
+        const int n = circles.size;
+        for(int i = 0; i < n; i += 2, bit <<= 2)
+        {
+            const Double_2 x = *(const Double_2*)(circles.x + i);
+            const Double_2 y = *(const Double_2*)(circles.y + i);
+            const Double_2 r = *(const Double_2*)(circles.radius + i);
+            const Mask_2 in_box = (x + r >= box_min_x) & (x - r <= box_max_x)
+                                  & (y + r >= box_min_y) & (y - r <= box_max_y);
+            box |= ((unsigned int)in_box[0] & bit) | ((unsigned int)in_box[1] & bit << 1);
+        }
+        if(n < Circle_Batch::CAPACITY)
+            box &= (1u << n) - 1;
+
+        // the roots only for the few circles near the line
+        Batch_Intersections result;
+        result.size = n;
+        result.in_box = box;
+        result.crossing = 0;
+        if(vv == 0.0)
+            return result;
+        for(; box; box &= box - 1)
+        {
+            const int i = __builtin_ctz(box);
+            const double r = circles.radius[i];
+            const double dx = line.p1.x - circles.x[i];
+            const double dy = line.p1.y - circles.y[i];
+            const double dv = dx*vx + dy*vy;
+            const double denominator = (vv*(r*r - (dx*dx + dy*dy)) + dv*dv) / (vv*vv);
+            if(denominator < 0.0)
+                continue;
+            const double term = - dv/vv;
+            const double sqrtValue = sqrt(denominator);
+            result.first[i] = term - sqrtValue;
+            result.second[i] = term + sqrtValue;
+            result.crossing |= 1u << i;
+        }
+        return result;
+    }
+
+    /**
+     * The circle the segment line.p1 -> line.p2 of intersection_points
+     * runs into first strictly between its ends, -1 if none.
+     * fraction gets s of that point.
+     */
+    inline int first_crossing(const Batch_Intersections& hits, double* fraction)
+    {
+        int index = -1;
+        double best = 1.0;
+        for(unsigned int crossing = hits.crossing; crossing; crossing &= crossing - 1)
+        {
+            const int i = __builtin_ctz(crossing);
+            double s = hits.first[i];
+            if(s <= 0.0)
+                s = hits.second[i];
+            if(s > 0.0 && s < best)
+            {
+                best = s;
+                index = i;
+            }
+        }
+        if(index >= 0 && fraction)
+            *fraction = best;
+        return index;
+    }
+
+    /**
+     * Bit i is set if the center of circle i is closer to point than
+     * distance, compared squared.
+     */
+    inline unsigned int centers_within(const Double_Vector& point,
+                                       const Circle_Batch& circles,
+                                       double distance)
+    {
+        const Double_2 p_x = {point.x, point.x};
+        const Double_2 p_y = {point.y, point.y};
+        const Double_2 limit = {distance*distance, distance*distance};
+        unsigned int mask = 0;
+        unsigned int bit = 1;
+        const int n = circles.size;
+        for(int i = 0; i < n; i += 2, bit <<= 2)
+        {
+            const Double_2 dx = p_x - *(const Double_2*)(circles.x + i);
+            const Double_2 dy = p_y - *(const Double_2*)(circles.y + i);
+            const Mask_2 near = (dx*dx + dy*dy) < limit;
+            mask |= ((unsigned int)near[0] & bit) | ((unsigned int)near[1] & bit << 1);
+        }
+        if(n < Circle_Batch::CAPACITY)
+            mask &= (1u << n) - 1;
+        return mask;
+    }
+
+    /**
+     * The angle between a and b is smaller than the one whose cosine is
+     * cos_limit (0 <= cos_limit <= 1), from the dot product instead of
+     * acos. False if a or b is zero.
+     */
+    inline bool angle_smaller(const Double_Vector& a, const Double_Vector& b,
+                              double cos_limit)
+    {
+        const double dot = a.x*b.x + a.y*b.y;
+        return dot > 0.0
+               && dot*dot > cos_limit*cos_limit * (a.x*a.x + a.y*a.y) * (b.x*b.x + b.y*b.y);
+    }
+
+    /**
+     * The angle between a and b is greater than the one whose cosine is
+     * cos_limit (0 <= cos_limit <= 1). False if a or b is zero.
+     */
+    inline bool angle_greater(const Double_Vector& a, const Double_Vector& b,
+                              double cos_limit)
+    {
+        const double dot = a.x*b.x + a.y*b.y;
+        return dot < 0.0
+               || dot*dot < cos_limit*cos_limit * (a.x*a.x + a.y*a.y) * (b.x*b.x + b.y*b.y);
+    }
+
     // Ortoganal distance
 /*    inline double distance(const Line& line, const Double_Vector& point)
     {
@@ -113,6 +113,16 @@ void Multicast_Socket::bind(const char* bind_addr, const uint16_t bind_port) thr
     }
 }
 
+void Multicast_Socket::set_target(const char* target_addr, const uint16_t target_port) throw(IO_Exception)
+{
+    target.sin_family = AF_INET;
+    if (! inet_aton(target_addr, &target.sin_addr))
+    {
+        throw IO_Exception("Bad address", errno);
+    }
+    target.sin_port = htons(target_port);
+}
+
 ssize_t Multicast_Socket::write(
     const void* buffer,
     const size_t buflen) throw (IO_Exception)
@@ -29,6 +29,9 @@ namespace BSmart
 
         void bind(const char* addr, const uint16_t port) throw(BSmart::IO_Exception);
 
+        // only set the address for write, for sockets which do not read
+        void set_target(const char* addr, const uint16_t port) throw(BSmart::IO_Exception);
+
         // write data to socket. returns number of bytes written
         // or -1 on failure.
         ssize_t write(const void* buffer, const size_t buflen) throw(BSmart::IO_Exception);
@@ -2,24 +2,24 @@
 #include "ui_GuiPropertiesDlg.h"
 #include <stdlib.h>
 
-GuiPropertiesDlg::GuiPropertiesDlg(QWidget *parent) :
-		QDialog(parent) {
+GuiPropertiesDlg::GuiPropertiesDlg(ConfigFile& config_, QWidget *parent) :
+		QDialog(parent), config(config_) {
 	ui.setupUi(this);
 
 	string value;
-	Global::config.readInto(value, "ssl_vision_ip");
+	config.readInto(value, "ssl_vision_ip");
 	ui.sslv_ip_Edit->setText(value.c_str());
-	Global::config.readInto(value, "ssl_vision_port");
+	config.readInto(value, "ssl_vision_port");
 	ui.sslv_port_Edit->setText(value.c_str());
 
-	Global::config.readInto(value, "refbox_ip");
+	config.readInto(value, "refbox_ip");
 	ui.refbox_ip_Edit->setText(value.c_str());
-	Global::config.readInto(value, "refbox_port");
+	config.readInto(value, "refbox_port");
 	ui.refbox_port_Edit->setText(value.c_str());
 
-	Global::config.readInto(value, "cam_height");
+	config.readInto(value, "cam_height");
 	ui.cam_height_Edit->setText(value.c_str());
-	Global::config.readInto(value, "cam_width");
+	config.readInto(value, "cam_width");
 	ui.cam_width_Edit->setText(value.c_str());
 
 	connect(ui.saveBtn, SIGNAL ( clicked() ), this, SLOT ( configUpdate() ));
@@ -38,7 +38,7 @@ void GuiPropertiesDlg::configUpdate() {
 
 	value = ui.sslv_ip_Edit->text().toStdString();
 	if (isIpAddress(value)) {
-		Global::config.add("ssl_vision_ip", value);
+		config.add("ssl_vision_ip", value);
 		ui.sslv_ip_Edit->setStyleSheet(validStyle);
 	} else {
 		isValid = false;
@@ -47,7 +47,7 @@ void GuiPropertiesDlg::configUpdate() {
 
 	value = ui.sslv_port_Edit->text().toStdString();
 	if (isPort(value)) {
-		Global::config.add("ssl_vision_port", value);
+		config.add("ssl_vision_port", value);
 		ui.sslv_port_Edit->setStyleSheet(validStyle);
 	} else {
 		isValid = false;
@@ -56,7 +56,7 @@ void GuiPropertiesDlg::configUpdate() {
 
 	value = ui.refbox_ip_Edit->text().toStdString();
 	if (isIpAddress(value)) {
-		Global::config.add("refbox_ip", value);
+		config.add("refbox_ip", value);
 		ui.refbox_ip_Edit->setStyleSheet(validStyle);
 	} else {
 		isValid = false;
@@ -65,7 +65,7 @@ void GuiPropertiesDlg::configUpdate() {
 
 	value = ui.refbox_port_Edit->text().toStdString();
 	if (isPort(value)) {
-		Global::config.add("refbox_port", value);
+		config.add("refbox_port", value);
 		ui.refbox_port_Edit->setStyleSheet(validStyle);
 	} else {
 		isValid = false;
@@ -74,7 +74,7 @@ void GuiPropertiesDlg::configUpdate() {
 
 	value = ui.cam_height_Edit->text().toStdString();
 	if (isNum(value)) {
-		Global::config.add("cam_height", value);
+		config.add("cam_height", value);
 		ui.cam_height_Edit->setStyleSheet(validStyle);
 	} else {
 		isValid = false;
@@ -83,14 +83,14 @@ void GuiPropertiesDlg::configUpdate() {
 
 	value = ui.cam_width_Edit->text().toStdString();
 	if (isNum(value)) {
-		Global::config.add("cam_width", value);
+		config.add("cam_width", value);
 		ui.cam_width_Edit->setStyleSheet(validStyle);
 	} else {
 		isValid = false;
 		ui.cam_width_Edit->setStyleSheet(nonValidStyle);
 	}
 
-	Global::saveConfig();
+	Global::saveConfig(config);
 
 	if (isValid)
 		this->close();
@@ -12,11 +12,13 @@ class GuiPropertiesDlg : public QDialog
 {
     Q_OBJECT
 public:
-    GuiPropertiesDlg(QWidget *parent = 0);
+    // changes are saved to config, they are used after a restart
+    GuiPropertiesDlg(ConfigFile& config, QWidget *parent = 0);
     ~GuiPropertiesDlg();
 
 private:
     Ui::GuiPropertiesDlgClass ui;
+    ConfigFile& config;
 
     void init();
     bool isIpAddress(string ip);
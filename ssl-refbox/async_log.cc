@@ -0,0 +1,208 @@
+#include "async_log.h"
+#include <sstream>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Async_Log::logger(Logger::getLogger("Async_Log"));
+
+volatile bool Async_Log::started = false;
+volatile bool Async_Log::stopping = false;
+Async_Log::Writer* Async_Log::writer = 0;
+QMutex Async_Log::rings_mutex;
+QMutex Async_Log::flush_mutex;
+std::vector<Async_Log::Ring*> Async_Log::rings;
+__thread Async_Log::Ring* Async_Log::ring = 0;
+
+Health_Counter* Health_Counter::first = 0;
+
+void Log_Arg::write(std::ostream& out) const {
+	switch (type) {
+	case INTEGER:
+		out << integer;
+		break;
+	case REAL:
+		out << real;
+		break;
+	case TEXT:
+		out << text;
+		break;
+	default:
+		break;
+	}
+}
+
+void Async_Log::start() {
+	if (started)
+		return;
+	started = true;
+	stopping = false;
+	writer = new Writer();
+	writer->start();
+}
+
+/**
+ * Messages added by other threads after the last flush are lost, so the
+ * pipeline threads should not log any more
+ */
+void Async_Log::stop() {
+	if (!started)
+		return;
+	stopping = true;
+	writer->wait();
+	delete writer;
+	writer = 0;
+	started = false;
+	flush();
+}
+
+void Async_Log::debug(const LoggerPtr& logger, const char* format, const Log_Arg& a0, const Log_Arg& a1,
+		const Log_Arg& a2, const Log_Arg& a3, const Log_Arg& a4, const Log_Arg& a5) {
+	if (logger->isDebugEnabled())
+		add(LEVEL_DEBUG, logger, format, a0, a1, a2, a3, a4, a5);
+}
+
+void Async_Log::info(const LoggerPtr& logger, const char* format, const Log_Arg& a0, const Log_Arg& a1,
+		const Log_Arg& a2, const Log_Arg& a3, const Log_Arg& a4, const Log_Arg& a5) {
+	if (logger->isInfoEnabled())
+		add(LEVEL_INFO, logger, format, a0, a1, a2, a3, a4, a5);
+}
+
+void Async_Log::warn(const LoggerPtr& logger, const char* format, const Log_Arg& a0, const Log_Arg& a1,
+		const Log_Arg& a2, const Log_Arg& a3, const Log_Arg& a4, const Log_Arg& a5) {
+	if (logger->isWarnEnabled())
+		add(LEVEL_WARN, logger, format, a0, a1, a2, a3, a4, a5);
+}
+
+/**
+ * The ring of a thread is created with its first message and lives until
+ * the end of the program
+ */
+Async_Log::Ring* Async_Log::thread_ring() {
+	if (!ring) {
+		ring = new Ring();
+		ring->head = 0;
+		ring->tail = 0;
+		ring->dropped = 0;
+		ring->dropped_reported = 0;
+		rings_mutex.lock();
+		rings.push_back(ring);
+		rings_mutex.unlock();
+	}
+	return ring;
+}
+
+void Async_Log::add(Level level, const LoggerPtr& logger, const char* format, const Log_Arg& a0,
+		const Log_Arg& a1, const Log_Arg& a2, const Log_Arg& a3, const Log_Arg& a4, const Log_Arg& a5) {
+	Ring* r = thread_ring();
+	unsigned long head = r->head;
+	if (head - r->tail >= RING_SIZE) {
+		r->dropped = r->dropped + 1;
+		return;
+	}
+	Record& record = r->records[head % RING_SIZE];
+	record.logger = &logger;
+	record.level = level;
+	record.format = format;
+	record.args[0] = a0;
+	record.args[1] = a1;
+	record.args[2] = a2;
+	record.args[3] = a3;
+	record.args[4] = a4;
+	record.args[5] = a5;
+	// the record is complete before it is counted
+	__sync_synchronize();
+	r->head = head + 1;
+}
+
+void Async_Log::write(const Record& record) {
+	std::ostringstream o;
+	int arg = 0;
+	for (const char* c = record.format; *c; ++c) {
+		if (c[0] == '{' && c[1] == '}' && arg < MAX_ARGS && !record.args[arg].empty()) {
+			record.args[arg++].write(o);
+			++c;
+		} else {
+			o << *c;
+		}
+	}
+	const LoggerPtr& logger = *record.logger;
+	switch (record.level) {
+	case LEVEL_DEBUG:
+		LOG4CXX_DEBUG( logger, o.str());
+		break;
+	case LEVEL_INFO:
+		LOG4CXX_INFO( logger, o.str());
+		break;
+	case LEVEL_WARN:
+		LOG4CXX_WARN( logger, o.str());
+		break;
+	}
+}
+
+void Async_Log::flush() {
+	flush_mutex.lock();
+	rings_mutex.lock();
+	std::vector<Ring*> current = rings;
+	rings_mutex.unlock();
+	for (unsigned int i = 0; i < current.size(); ++i) {
+		Ring* r = current[i];
+		unsigned long head = r->head;
+		__sync_synchronize();
+		for (unsigned long n = r->tail; n != head; ++n)
+			write(r->records[n % RING_SIZE]);
+		// the records are written before they may be reused
+		__sync_synchronize();
+		r->tail = head;
+		unsigned long dropped = r->dropped;
+		if (dropped != r->dropped_reported) {
+			std::ostringstream o;
+			o << dropped - r->dropped_reported << " log messages dropped, the log of a thread was full";
+			LOG4CXX_WARN( logger, o.str());
+			r->dropped_reported = dropped;
+		}
+	}
+	flush_mutex.unlock();
+}
+
+void Async_Log::report_health() {
+	for (Health_Counter* counter = Health_Counter::first; counter; counter = counter->next) {
+		long long total = counter->total;
+		if (total == counter->reported)
+			continue;
+		std::ostringstream o;
+		o << counter->name << ": " << total - counter->reported << " in the last " << HEALTH_INTERVAL_MS / 1000
+				<< " s, " << total << " in total (" << counter->help << ")";
+		LOG4CXX_WARN( logger, o.str());
+		counter->reported = total;
+	}
+}
+
+void Async_Log::Writer::run() {
+	int since_health = 0;
+	while (!stopping) {
+		msleep(FLUSH_INTERVAL_MS);
+		flush();
+		since_health += FLUSH_INTERVAL_MS;
+		if (since_health >= HEALTH_INTERVAL_MS) {
+			since_health = 0;
+			report_health();
+		}
+	}
+}
+
+Health_Counter::Health_Counter(const char* name_, const char* help_) :
+	name(name_), help(help_) {
+	total = 0;
+	reported = 0;
+	// static objects are constructed before main, no other thread runs yet
+	next = first;
+	first = this;
+}
+
+void Health_Counter::write_all(std::ostream& out) {
+	for (Health_Counter* counter = first; counter; counter = counter->next) {
+		out << "# HELP ssl_refbox_" << counter->name << "_total " << counter->help << "\n";
+		out << "# TYPE ssl_refbox_" << counter->name << "_total counter\n";
+		out << "ssl_refbox_" << counter->name << "_total " << counter->total << "\n";
+	}
+}
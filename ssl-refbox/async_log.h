@@ -0,0 +1,154 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <QMutex>
+#include <QThread>
+#include <vector>
+#include <ostream>
+#include <log4cxx/logger.h>
+
+/**
+ * @class Log_Arg
+ * @brief A number or a literal, kept unformatted until the message is written
+ */
+class Log_Arg
+{
+public:
+    Log_Arg() : type(NONE) {}
+    Log_Arg(int v) : type(INTEGER) { integer = v; }
+    Log_Arg(unsigned int v) : type(INTEGER) { integer = v; }
+    Log_Arg(long v) : type(INTEGER) { integer = v; }
+    Log_Arg(unsigned long v) : type(INTEGER) { integer = v; }
+    Log_Arg(long long v) : type(INTEGER) { integer = v; }
+    Log_Arg(double v) : type(REAL) { real = v; }
+    //has to live until the message is written, e.g. a literal
+    Log_Arg(const char* v) : type(TEXT) { text = v; }
+
+    bool empty() const { return type == NONE; }
+    void write(std::ostream&) const;
+
+private:
+    enum Type {
+        NONE, INTEGER, REAL, TEXT
+    };
+
+    Type type;
+    union {
+        long long integer;
+        double real;
+        const char* text;
+    };
+};
+
+/**
+ * @class Async_Log
+ * @brief Logging for the filter, rules and vision loops. The caller stores
+ * the format literal and its arguments in a ring of its thread, without
+ * locks and allocation (except once for the ring of a new thread). A
+ * writer thread formats the messages, replaces every {} of the format by
+ * the next argument and passes them to log4cxx. Messages of a full ring
+ * are dropped and counted.
+ */
+class Async_Log
+{
+public:
+    enum {
+        RING_SIZE = 1024,
+        MAX_ARGS = 6,
+        FLUSH_INTERVAL_MS = 50,
+        //health counters are reported at most this often
+        HEALTH_INTERVAL_MS = 5000
+    };
+
+    //starts the writer thread
+    static void start();
+    //stops the writer thread and writes the rest, before main returns
+    static void stop();
+    //writes all pending messages
+    static void flush();
+
+    static void debug(const log4cxx::LoggerPtr& logger, const char* format, const Log_Arg& a0 = Log_Arg(),
+            const Log_Arg& a1 = Log_Arg(), const Log_Arg& a2 = Log_Arg(), const Log_Arg& a3 = Log_Arg(),
+            const Log_Arg& a4 = Log_Arg(), const Log_Arg& a5 = Log_Arg());
+    static void info(const log4cxx::LoggerPtr& logger, const char* format, const Log_Arg& a0 = Log_Arg(),
+            const Log_Arg& a1 = Log_Arg(), const Log_Arg& a2 = Log_Arg(), const Log_Arg& a3 = Log_Arg(),
+            const Log_Arg& a4 = Log_Arg(), const Log_Arg& a5 = Log_Arg());
+    static void warn(const log4cxx::LoggerPtr& logger, const char* format, const Log_Arg& a0 = Log_Arg(),
+            const Log_Arg& a1 = Log_Arg(), const Log_Arg& a2 = Log_Arg(), const Log_Arg& a3 = Log_Arg(),
+            const Log_Arg& a4 = Log_Arg(), const Log_Arg& a5 = Log_Arg());
+
+private:
+    enum Level {
+        LEVEL_DEBUG, LEVEL_INFO, LEVEL_WARN
+    };
+
+    struct Record {
+        //the static logger of the calling class
+        const log4cxx::LoggerPtr* logger;
+        Level level;
+        const char* format;
+        Log_Arg args[MAX_ARGS];
+    };
+
+    struct Ring {
+        Record records[RING_SIZE];
+        volatile unsigned long head; // written by the thread of the ring
+        volatile unsigned long tail; // written by flush
+        volatile unsigned long dropped;
+        unsigned long dropped_reported;
+    };
+
+    class Writer : public QThread
+    {
+    public:
+        void run();
+    };
+
+    static void add(Level, const log4cxx::LoggerPtr&, const char* format, const Log_Arg& a0, const Log_Arg& a1,
+            const Log_Arg& a2, const Log_Arg& a3, const Log_Arg& a4, const Log_Arg& a5);
+    static Ring* thread_ring();
+    static void write(const Record&);
+    static void report_health();
+
+    static log4cxx::LoggerPtr logger;
+    static volatile bool started;
+    static volatile bool stopping;
+    static Writer* writer;
+    static QMutex rings_mutex;
+    static QMutex flush_mutex;
+    static std::vector<Ring*> rings;
+    static __thread Ring* ring;
+};
+
+/**
+ * @class Health_Counter
+ * @brief Counts numeric problems (NaN, zero weights) of a loop instead of
+ * printing each of them. The changes are logged every
+ * Async_Log::HEALTH_INTERVAL_MS and the totals are part of the metrics.
+ * Only for objects with static storage duration.
+ */
+class Health_Counter
+{
+public:
+    Health_Counter(const char* name, const char* help);
+
+    void count() { __sync_fetch_and_add(&total, 1); }
+    long long get() const { return total; }
+
+    //Prometheus text format of all counters
+    static void write_all(std::ostream&);
+
+private:
+    friend class Async_Log;
+
+    const char* name;
+    const char* help;
+    volatile long long total;
+    long long reported;
+    Health_Counter* next;
+
+    //zero before any constructor runs
+    static Health_Counter* first;
+};
+
+#endif //ASYNC_LOG_H
@@ -6,6 +6,26 @@ Field_Hardware::Field_Hardware()
     ;
 }
 
+static BSmart::Circle_Batch make_goalpost_batch ( const Field_Goalpost* goalposts )
+{
+    BSmart::Circle_Batch batch;
+    for ( int i = 0; i < Field_Hardware::NUMBER_FIELD_GOALPOSTS; ++i )
+        batch.add ( goalposts[i].circle );
+    return batch;
+}
+
+const BSmart::Circle_Batch& Field_Hardware::goalpost_batch_ball()
+{
+    static const BSmart::Circle_Batch batch = make_goalpost_batch ( field_goalposts_ball );
+    return batch;
+}
+
+const BSmart::Circle_Batch& Field_Hardware::goalpost_batch_robot()
+{
+    static const BSmart::Circle_Batch batch = make_goalpost_batch ( field_goalposts_robot );
+    return batch;
+}
+
 const Field_Bar
 Field_Hardware::field_bars_ball[Field_Hardware::NUMBER_FIELD_BARS] = {
     //border left
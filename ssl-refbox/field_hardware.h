@@ -4,6 +4,7 @@
 #include <libbsmart/line.h>
 #include <libbsmart/circle.h>
 #include <libbsmart/pose.h>
+#include <libbsmart/math.h>
 
 class Field_Bar;
 class Field_Goalpost;
@@ -33,6 +34,10 @@ public:
 	static const Field_Bar field_bars_robot[NUMBER_FIELD_BARS];
 	static const Field_Goalpost field_goalposts_robot[NUMBER_FIELD_GOALPOSTS];
 
+	//the circles of the goalposts above, for the batch tests
+	static const BSmart::Circle_Batch& goalpost_batch_ball();
+	static const BSmart::Circle_Batch& goalpost_batch_robot();
+
 };
 
 struct Hitpoint {
@@ -3,10 +3,16 @@
 #include <iostream>
 #include <cmath>
 
-Filter_Data::Filter_Data()
+Filter_Data::Filter_Data ( int number_of_ids_ )
 {
     QMutex samples_mutex();
 
+    number_of_ids = number_of_ids_;
+    if ( number_of_ids < 1 || number_of_ids > NUMBER_OF_IDS )
+        number_of_ids = NUMBER_OF_IDS;
+    active_robots.clear();
+    active_robots.reserve ( NUMBER_OF_TEAMS * NUMBER_OF_IDS );
+
     for ( int team = 0; team < NUMBER_OF_TEAMS; ++team ) {
         for ( int id = 0; id < NUMBER_OF_IDS; ++id ) {
             visibility[team][id] = 0.49;
@@ -14,8 +20,28 @@ Filter_Data::Filter_Data()
     }
     visibility_threshhold = 0.5;
     ball_samples = Ball_Sample_List ( BALL_SAMPLES, Ball_Sample() );
-    broken_rules.clear();
+    broken_rule_sequence = 0;
     internal_play_states = BSmart::Int_Vector ( 0, 0 );
+    timestamp = 0;
+    frame = 0;
+    received_us = 0;
+}
+
+void Filter_Data::set_parameters ( const Filter_Parameters& parameters_ )
+{
+    samples_mutex.lock();
+    parameters = parameters_;
+    samples_mutex.unlock();
+}
+
+int Filter_Data::get_number_of_ids()
+{
+    return number_of_ids;
+}
+
+bool Filter_Data::is_valid_robot ( int team, int id )
+{
+    return team >= 0 && team < NUMBER_OF_TEAMS && id >= 0 && id < number_of_ids;
 }
 
 void Filter_Data::set_ball_samples ( const Ball_Sample_List& balls )
@@ -64,11 +90,12 @@ Ball_Percept_List Filter_Data::get_current_ball_percepts()
     return tmp;
 }
 
-void Filter_Data::move_balls ( double ms, const Robot_Sample_List& robots )
+void Filter_Data::move_balls ( double ms, const Robot_Sample_List& robots,
+                               Filter_Random& random_generator )
 {
     samples_mutex.lock();
-    for ( int i = 0; i < BALL_SAMPLES; ++i ) {
-        ball_samples[i].move ( ms, robots );
+    for ( unsigned int i = 0; i < ball_samples.size(); ++i ) {
+        ball_samples[i].move ( ms, robots, parameters, random_generator );
     }
     samples_mutex.unlock();
 }
@@ -145,10 +172,9 @@ Robot_Sample_List Filter_Data::get_current_robot_obstacles()
     obstacles.clear();
 
     samples_mutex.lock();
-    for ( int team = 0; team < NUMBER_OF_TEAMS; ++team )
-        for ( int id = 0; id < NUMBER_OF_IDS; ++id )
-            if ( visibility[team][id] > visibility_threshhold )
-                obstacles.push_back ( robot_models[team][id] );
+    obstacles.reserve ( active_robots.size() );
+    for ( unsigned int i = 0; i < active_robots.size(); ++i )
+        obstacles.push_back ( robot_models[active_robots[i].x][active_robots[i].y] );
     samples_mutex.unlock();
 
     return obstacles;
@@ -158,10 +184,15 @@ void Filter_Data::reduce_visibility()
 {
     samples_mutex.lock();
     for ( int team = 0; team < NUMBER_OF_TEAMS; ++team )
-        for ( int id = 0; id < NUMBER_OF_IDS; ++id ) {
-            visibility[team][id] -= 0.025;//subtracted from visibility every cycle
+        for ( int id = 0; id < number_of_ids; ++id ) {
+            if ( visibility[team][id] == 0. )
+                continue;
+            bool was_seen = visibility[team][id] > visibility_threshhold;
+            visibility[team][id] -= parameters.visibility_decrement;//subtracted from visibility every cycle
             if ( visibility[team][id] < 0. )
                 visibility[team][id] = 0.;
+            if ( was_seen && visibility[team][id] <= visibility_threshhold )
+                deactivate_robot ( team, id );
         }
     samples_mutex.unlock();
 }
@@ -172,9 +203,12 @@ void Filter_Data::set_robot_seen ( int team, int id )
     assert ( id >= 0 && id < NUMBER_OF_IDS );
 
     samples_mutex.lock();
-    visibility[team][id] += 0.2;//added to Visibility, can be large for good vision
+    bool was_seen = visibility[team][id] > visibility_threshhold;
+    visibility[team][id] += parameters.visibility_increment;//added to Visibility, can be large for good vision
     if ( visibility[team][id] > 1. )
         visibility[team][id] = 1.;
+    if ( !was_seen && visibility[team][id] > visibility_threshhold )
+        activate_robot ( team, id );
     samples_mutex.unlock();
 }
 
@@ -189,16 +223,50 @@ bool Filter_Data::get_robot_seen ( int team, int id )
     return tmp;
 }
 
-void Filter_Data::move_robots ( double ms, const Robot_Sample_List& robots )
+std::vector<BSmart::Int_Vector> Filter_Data::get_active_robots()
 {
     samples_mutex.lock();
-    for ( int team = 0; team < NUMBER_OF_TEAMS; ++team ) {
-        for ( int id = 0; id < NUMBER_OF_IDS; ++id ) {
-            if ( visibility[team][id] > visibility_threshhold ) {
-                for ( int i = 0; i < ROBOT_SAMPLES; ++i ) {
-                    robot_samples[team][id][i].move ( ms, robots );
-                }
-            }
+    std::vector<BSmart::Int_Vector> tmp = active_robots;
+    samples_mutex.unlock();
+    return tmp;
+}
+
+// samples_mutex has to be locked by the caller
+void Filter_Data::activate_robot ( int team, int id )
+{
+    // keep the list sorted by team and id, so iteration order stays the same
+    // as with the old nested loops
+    std::vector<BSmart::Int_Vector>::iterator it = active_robots.begin();
+    while ( it != active_robots.end()
+            && ( it->x < team || ( it->x == team && it->y < id ) ) )
+        ++it;
+    active_robots.insert ( it, BSmart::Int_Vector ( team, id ) );
+}
+
+// samples_mutex has to be locked by the caller
+void Filter_Data::deactivate_robot ( int team, int id )
+{
+    for ( std::vector<BSmart::Int_Vector>::iterator it = active_robots.begin();
+            it != active_robots.end(); ++it ) {
+        if ( it->x == team && it->y == id ) {
+            active_robots.erase ( it );
+            return;
+        }
+    }
+}
+
+void Filter_Data::move_robots ( double ms, const Robot_Sample_List& robots,
+                               Filter_Random& random_generator, bool seen_only )
+{
+    samples_mutex.lock();
+    for ( unsigned int r = 0; r < active_robots.size(); ++r ) {
+        int team = active_robots[r].x;
+        int id = active_robots[r].y;
+        if ( seen_only && current_robot_percepts[team][id].empty() )
+            continue;
+        Robot_Sample_List& samples = robot_samples[team][id];
+        for ( unsigned int i = 0; i < samples.size(); ++i ) {
+            samples[i].move ( ms, robots, parameters, random_generator );
         }
     }
     samples_mutex.unlock();
@@ -234,17 +302,85 @@ int Filter_Data::get_frame()
     return tmp;
 }
 
-void Filter_Data::set_broken_rules ( std::vector<Broken_Rule> broken_rules_ )
+void Filter_Data::set_received_us ( long long received_us_ )
 {
     samples_mutex.lock();
-    broken_rules = broken_rules_;
+    received_us = received_us_;
+    samples_mutex.unlock();
+}
+
+/**
+ * Only the filter thread may publish. The snapshot is taken under one lock
+ * and copied into the buffer of every reader.
+ */
+void Filter_Data::publish_world_snapshot()
+{
+    World_Snapshot& snapshot = snapshots[0].back();
+    samples_mutex.lock();
+    snapshot.ball_model = ball_model;
+    snapshot.ball_percepts = current_ball_percepts;
+    snapshot.robot_models.clear();
+    snapshot.robot_percepts.clear();
+    for ( unsigned int i = 0; i < active_robots.size(); ++i ) {
+        int team = active_robots[i].x;
+        int id = active_robots[i].y;
+        snapshot.robot_models.push_back ( robot_models[team][id] );
+        snapshot.robot_percepts.insert ( snapshot.robot_percepts.end(),
+                                         current_robot_percepts[team][id].begin(),
+                                         current_robot_percepts[team][id].end() );
+    }
+    snapshot.timestamp = timestamp;
+    snapshot.frame = frame;
+    snapshot.received_us = received_us;
+    samples_mutex.unlock();
+
+    for ( int reader = 1; reader < SNAPSHOT_READERS; ++reader )
+        snapshots[reader].back() = snapshot;
+    for ( int reader = 0; reader < SNAPSHOT_READERS; ++reader )
+        snapshots[reader].publish();
+}
+
+const World_Snapshot& Filter_Data::acquire_world_snapshot ( Snapshot_Reader reader )
+{
+    snapshots[reader].acquire();
+    return snapshots[reader].front();
+}
+
+unsigned long Filter_Data::add_broken_rule_event ( Broken_Rule& broken_rule, bool update )
+{
+    samples_mutex.lock();
+    unsigned long sequence = ++broken_rule_sequence;
+    if ( !update )
+        broken_rule.id = sequence;
+    Broken_Rule_Event& event = broken_rule_events[sequence % BROKEN_RULE_EVENTS];
+    event.sequence = sequence;
+    event.update = update;
+    event.broken_rule = broken_rule;
+    samples_mutex.unlock();
+    return sequence;
+}
+
+bool Filter_Data::get_broken_rule_events ( unsigned long since,
+        std::vector<Broken_Rule_Event>& events )
+{
+    samples_mutex.lock();
+    bool complete = true;
+    unsigned long first = since + 1;
+    if ( broken_rule_sequence >= BROKEN_RULE_EVENTS
+            && first <= broken_rule_sequence - BROKEN_RULE_EVENTS ) {
+        first = broken_rule_sequence - BROKEN_RULE_EVENTS + 1;
+        complete = false;
+    }
+    for ( unsigned long sequence = first; sequence <= broken_rule_sequence; ++sequence )
+        events.push_back ( broken_rule_events[sequence % BROKEN_RULE_EVENTS] );
     samples_mutex.unlock();
+    return complete;
 }
 
-std::vector<Broken_Rule> Filter_Data::get_broken_rules()
+unsigned long Filter_Data::get_broken_rule_sequence()
 {
     samples_mutex.lock();
-    std::vector<Broken_Rule> tmp = broken_rules;
+    unsigned long tmp = broken_rule_sequence;
     samples_mutex.unlock();
     return tmp;
 }
@@ -6,6 +6,7 @@
 #include "sample.h"
 #include "field_hardware.h"
 #include "percept.h"
+#include "triple_buffer.h"
 #include <limits>
 #include <libbsmart/systemcall.h>
 
@@ -19,18 +20,55 @@ struct Broken_Rule {
 	BSmart::Line line_for_smth;
 	BSmart::Int_Vector standing;
 	int frame_broken; // first frame where rule was broken
+	unsigned long id; // sequence number of the event which added it
+};
+
+// change of the broken rules, update: an entry with the same id changed
+struct Broken_Rule_Event {
+	unsigned long sequence;
+	bool update;
+	Broken_Rule broken_rule;
+};
+
+// consistent copy of the filter results of one cycle
+struct World_Snapshot {
+	Ball_Sample ball_model;
+	Robot_Sample_List robot_models; // only seen robots, sorted by team and id
+	BSmart::Time_Value timestamp;
+	int frame;
+	long long received_us; // monotonic us the frame was received, 0: unknown
+	// percepts of the cycle, for the GUI, not recorded by Tracked_State_Log
+	Ball_Percept_List ball_percepts;
+	Robot_Percept_List robot_percepts; // of the seen robots
+
+	World_Snapshot() : timestamp(0), frame(0), received_us(0) {}
 };
 
 class Filter_Data {
 public:
+	// threads reading the published snapshots, one buffer each
+	enum Snapshot_Reader {
+		RULES_READER = 0,
+		GUI_READER,
+		SNAPSHOT_READERS
+	};
+
 	enum {
 		NUMBER_OF_TEAMS = 2,
-		NUMBER_OF_IDS = 12,
+		NUMBER_OF_IDS = 16, // storage for all ids on the wire (0..15)
 		ROBOT_SAMPLES = 50,
+		BROKEN_RULE_EVENTS = 256,
 		BALL_SAMPLES = 250
 	};
 
-	Filter_Data();
+	Filter_Data(int number_of_ids_ = NUMBER_OF_IDS);
+
+	//motion noise and visibility, set before the filter starts
+	void set_parameters(const Filter_Parameters&);
+
+	//ids 0..get_number_of_ids()-1 are tracked, everything above is dropped
+	int get_number_of_ids();
+	bool is_valid_robot(int, int);
 
 	//Balls
 	void set_ball_samples(const Ball_Sample_List&);
@@ -40,7 +78,7 @@ public:
 	void set_current_ball_percepts(const Ball_Percept_List& ball_percepts);
 	Ball_Percept_List get_current_ball_percepts();
 
-	void move_balls(double, const Robot_Sample_List&);
+	void move_balls(double, const Robot_Sample_List&, Filter_Random&);
 
 	//Robots
 //	void set_robot_samples(int, int, const Robot_Sample_List&);
@@ -58,8 +96,11 @@ public:
 	void reduce_visibility();
 	void set_robot_seen(int, int);
 	bool get_robot_seen(int, int);
+	//dense list of (team, id) of all currently seen robots
+	std::vector<BSmart::Int_Vector> get_active_robots();
 
-	void move_robots(double, const Robot_Sample_List&);
+	//seen_only: only robots with percepts in the last cycle
+	void move_robots(double, const Robot_Sample_List&, Filter_Random&, bool seen_only = false);
 
 	void set_timestamp(const BSmart::Time_Value&);
 	BSmart::Time_Value get_timestamp();
@@ -67,9 +108,21 @@ public:
 	void set_frame(const int&);
 	int get_frame();
 
-	//updates for broken rules for GUI
-	void set_broken_rules(std::vector<Broken_Rule>);
-	std::vector<Broken_Rule> get_broken_rules();
+	//for the end to end latency of the snapshot
+	void set_received_us(long long);
+
+	//filter thread, end of every cycle: copy the results for the readers
+	void publish_world_snapshot();
+	//newest published snapshot, valid until the next call of the same reader,
+	//never waits for the filter
+	const World_Snapshot& acquire_world_snapshot(Snapshot_Reader);
+
+	//broken rules for GUI as a stream of events with increasing sequence numbers,
+	//a new entry gets its sequence number as id
+	unsigned long add_broken_rule_event(Broken_Rule&, bool update);
+	//events after sequence since, false if older ones have been dropped already
+	bool get_broken_rule_events(unsigned long since, std::vector<Broken_Rule_Event>&);
+	unsigned long get_broken_rule_sequence();
 
 	void set_internal_play_states(BSmart::Int_Vector);
 	BSmart::Int_Vector get_internal_play_states();
@@ -87,12 +140,21 @@ private:
 
 	double visibility[NUMBER_OF_TEAMS][NUMBER_OF_IDS];
 	double visibility_threshhold;
+	Filter_Parameters parameters;
+	int number_of_ids;
+	std::vector<BSmart::Int_Vector> active_robots;
+	void activate_robot(int, int);
+	void deactivate_robot(int, int);
 
 	BSmart::Time_Value timestamp;
 	int frame;
+	long long received_us;
+
+	Triple_Buffer<World_Snapshot> snapshots[SNAPSHOT_READERS];
 
-	//rule system results
-	std::vector<Broken_Rule> broken_rules;
+	//rule system results, ring of the last events
+	Broken_Rule_Event broken_rule_events[BROKEN_RULE_EVENTS];
+	unsigned long broken_rule_sequence;
 	BSmart::Int_Vector internal_play_states;
 };
 
@@ -0,0 +1,76 @@
+#include "filter_parameters.h"
+
+double Filter_Parameters::* const Filter_Parameters::members[COUNT] = { &Filter_Parameters::std_dev_ball,
+		&Filter_Parameters::std_dev_robot, &Filter_Parameters::alpha_slow_ball, &Filter_Parameters::alpha_fast_ball,
+		&Filter_Parameters::alpha_slow_robots, &Filter_Parameters::alpha_fast_robots, &Filter_Parameters::ball_noise,
+		&Filter_Parameters::ball_speed_noise, &Filter_Parameters::ball_friction, &Filter_Parameters::robot_noise,
+		&Filter_Parameters::robot_speed_noise, &Filter_Parameters::visibility_increment,
+		&Filter_Parameters::visibility_decrement, &Filter_Parameters::kalman_acceleration,
+		&Filter_Parameters::kalman_angular_acceleration, &Filter_Parameters::kalman_position_noise,
+		&Filter_Parameters::kalman_rotation_noise, &Filter_Parameters::seed_spread,
+		&Filter_Parameters::seed_rotation_spread, &Filter_Parameters::reseed_distance,
+		&Filter_Parameters::reseed_ms, &Filter_Parameters::cycle_budget_us };
+
+const char* const Filter_Parameters::names[COUNT] = { "std_dev_ball", "std_dev_robot", "alpha_slow_ball",
+		"alpha_fast_ball", "alpha_slow_robots", "alpha_fast_robots", "ball_noise", "ball_speed_noise",
+		"ball_friction", "robot_noise", "robot_speed_noise", "visibility_increment", "visibility_decrement",
+		"kalman_acceleration", "kalman_angular_acceleration", "kalman_position_noise", "kalman_rotation_noise",
+		"seed_spread", "seed_rotation_spread", "reseed_distance", "reseed_ms",
+		"cycle_budget_us" };
+
+Filter_Parameters::Filter_Parameters() {
+	robot_tracker = PARTICLE_TRACKER;
+	std_dev_ball = 5;
+	std_dev_robot = 5;
+	alpha_slow_ball = 0.4;
+	alpha_fast_ball = 0.8;
+	alpha_slow_robots = 0.2;
+	alpha_fast_robots = 0.5;
+	ball_noise = 2.;
+	ball_speed_noise = 0.02;
+	ball_friction = 0.9999;
+	robot_noise = 5.;
+	robot_speed_noise = 0.1;
+	visibility_increment = 0.2;
+	visibility_decrement = 0.025;
+	kalman_acceleration = 4.;
+	kalman_angular_acceleration = 20.;
+	kalman_position_noise = 5.;
+	kalman_rotation_noise = 0.05;
+	seed_spread = 20.;
+	seed_rotation_spread = 0.1;
+	reseed_distance = 500.;
+	reseed_ms = 500.;
+	cycle_budget_us = 10000.;
+}
+
+void Filter_Parameters::read(const ConfigFile& config) {
+	for (int i = 0; i < COUNT; ++i)
+		value(i) = config.read<double>(std::string("filter_") + names[i], value(i));
+	std::string tracker = config.read<std::string>("filter_robot_tracker", tracker_name(robot_tracker));
+	robot_tracker = tracker == tracker_name(KALMAN_TRACKER) ? KALMAN_TRACKER : PARTICLE_TRACKER;
+}
+
+const char* Filter_Parameters::tracker_name(Robot_Tracker tracker) {
+	return tracker == KALMAN_TRACKER ? "kalman" : "particle";
+}
+
+const char* Filter_Parameters::name(int i) {
+	return names[i];
+}
+
+double& Filter_Parameters::value(int i) {
+	return this->*members[i];
+}
+
+double Filter_Parameters::value(int i) const {
+	return this->*members[i];
+}
+
+int Filter_Parameters::find(const std::string& name) {
+	for (int i = 0; i < COUNT; ++i) {
+		if (name == names[i])
+			return i;
+	}
+	return -1;
+}
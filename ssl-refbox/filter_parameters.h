@@ -0,0 +1,75 @@
+#ifndef FILTER_PARAMETERS_H
+#define FILTER_PARAMETERS_H
+
+#include <string>
+#include "../ConfigFile/ConfigFile.h"
+
+/**
+ * @brief Tuning constants of the particle filter, the samples and the
+ * visibility of robots. The defaults are the hand-tuned values, every value
+ * can be set in the config as filter_<name>.
+ */
+struct Filter_Parameters {
+    // estimator of the robots, the ball always has the particle filter
+    enum Robot_Tracker {
+        PARTICLE_TRACKER,
+        KALMAN_TRACKER
+    };
+    Robot_Tracker robot_tracker;
+
+    // weighting, particle_filter.cc
+    double std_dev_ball;
+    double std_dev_robot;
+    // augmentation with samples at the percepts
+    double alpha_slow_ball;
+    double alpha_fast_ball;
+    double alpha_slow_robots;
+    double alpha_fast_robots;
+    // motion model, sample.cc: noise in mm and m/s, speed factor per ms
+    double ball_noise;
+    double ball_speed_noise;
+    double ball_friction;
+    double robot_noise;
+    double robot_speed_noise;
+    // filter_data.cc, per cycle
+    double visibility_increment;
+    double visibility_decrement;
+    // kalman_robot_tracker.cc: process noise in m/s^2 and rad/s^2,
+    // measurement noise in mm and rad
+    double kalman_acceleration;
+    double kalman_angular_acceleration;
+    double kalman_position_noise;
+    double kalman_rotation_noise;
+    // samples seeded around the first percept, in mm and rad, and again
+    // after reseed_ms without percepts or a percept reseed_distance (mm)
+    // away from the model
+    double seed_spread;
+    double seed_rotation_spread;
+    double reseed_distance;
+    double reseed_ms;
+    // particle_filter.cc: us of one filter cycle before the quality is
+    // reduced, 0: no budget
+    double cycle_budget_us;
+
+    Filter_Parameters();
+
+    void read(const ConfigFile&);
+    // "particle" or "kalman", config filter_robot_tracker
+    static const char* tracker_name(Robot_Tracker);
+
+    // access by name for parameter sweeps
+    enum {
+        COUNT = 22
+    };
+    static const char* name(int);
+    double& value(int);
+    double value(int) const;
+    // index of the name, -1 if unknown
+    static int find(const std::string&);
+
+private:
+    static double Filter_Parameters::* const members[COUNT];
+    static const char* const names[COUNT];
+};
+
+#endif //FILTER_PARAMETERS_H
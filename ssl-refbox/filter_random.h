@@ -0,0 +1,28 @@
+#ifndef FILTER_RANDOM_H
+#define FILTER_RANDOM_H
+
+#include <cstdlib>
+
+/**
+ * @class Filter_Random
+ * @brief Random numbers of one particle filter and the samples it moves.
+ * Every filter has its own state instead of the one of rand(), so a replay
+ * with a fixed seed gives the same samples in every run and in any number
+ * of threads.
+ */
+class Filter_Random
+{
+public:
+    explicit Filter_Random(unsigned int seed_ = 1) : state(seed_) {}
+
+    void seed(unsigned int seed_) { state = seed_; }
+    //0 .. RAND_MAX, like rand()
+    int next() { return rand_r(&state); }
+    //0 .. 1
+    double uniform() { return next() / (double) RAND_MAX; }
+
+private:
+    unsigned int state;
+};
+
+#endif //FILTER_RANDOM_H
@@ -8,38 +8,46 @@
 #include "glextra.h"
 #include "gamearea.h"
 #include "particle_filter.h"
+#include "global.h"
+#include "rule_profiler.h"
+#include "latency_histogram.h"
+#include "trace.h"
 
 Gamearea::Gamearea ( QWidget* p ) :
-        QGLWidget ( p ), m_timer ( -1 )
+        QGLWidget ( p ), m_timer ( -1 ), status_font ( GLUT_BITMAP_TIMES_ROMAN_10 )
 {
     setMouseTracking ( true );
-    rules_wait_condition = new QWaitCondition();
-    new_data_wait_condition = new QWaitCondition();
-    pf_data = new Pre_Filter_Data();
-    filter_data = new Filter_Data();
-    gamestate = new BSmart::Game_States();
-    vision = new SSLVision ( pf_data, gamestate, new_data_wait_condition );
-    refbox_listener = new RefboxListener ( gamestate );
-    particle_filter = new Particle_Filter_Mother ( pf_data, filter_data,
-            rules_wait_condition, new_data_wait_condition );
-    pf_tester = new PF_Tester ( pf_data, gamestate );
-    rules = new SSL_Refbox_Rules ( rules_wait_condition, filter_data, gamestate );
-    glextra = GLExtra ( filter_data );
-
-    connect ( pf_tester, SIGNAL ( new_frame() ), this, SLOT ( show_world() ) );
-    connect ( rules, SIGNAL ( new_filter_data() ), this, SLOT ( show_world() ) );
-    connect ( pf_tester, SIGNAL ( new_frame() ), particle_filter, SLOT ( new_frame() ) );
-    connect ( vision, SIGNAL ( new_refbox_cmd ( char ) ), refbox_listener,
-              SLOT ( new_refbox_cmd ( char ) ) );
-
-    vision->start(); //34-36%
-    //    pf_tester->start(); //64%
-    refbox_listener->start(); //2%
-    particle_filter->start(); //67%
-    rules->start();
-
+    pipeline = 0;
+    glextra = 0;
+    refresh_interval = 1000 / 60;
+    dirty = false;
     start_time = BSmart::Systemcall::get_current_system_time();
     show_rule_data = true;
+    show_particles = false;
+    status_valid = false;
+    status_version = 0;
+}
+
+/**
+ * @brief Create and start the pipeline shown in this widget, has to be
+ * called before the widget is shown
+ */
+void Gamearea::start_pipeline ( const ConfigFile& config, const QString& start_log )
+{
+    int refresh_rate = config.read<int> ( "gui_refresh_rate", 60 );
+    if ( refresh_rate > 0 )
+        refresh_interval = 1000 / refresh_rate;
+
+    Trace::set_thread_name ( "gui" );
+    pipeline = new Pipeline ( config, start_log );
+    glextra = new GLExtra ( pipeline->filter_data );
+    show_particles = config.read<bool> ( "show_particles", false );
+    glextra->set_show_particles ( show_particles );
+
+    connect ( pipeline->pf_tester, SIGNAL ( new_frame() ), this, SLOT ( show_world() ) );
+    connect ( pipeline->rules, SIGNAL ( new_filter_data() ), this, SLOT ( show_world() ) );
+
+    pipeline->start();
 }
 
 Gamearea::~Gamearea()
@@ -48,10 +56,13 @@ Gamearea::~Gamearea()
         glDeleteLists ( m_field, 1 );
     if ( glIsList ( world_model ) )
         glDeleteLists ( world_model, 1 );
+    delete glextra;
 }
 
 void Gamearea::paintGL()
 {
+    dirty = false;
+    long long start = Rule_Profiler::now();
 
     glClear ( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
@@ -65,22 +76,25 @@ void Gamearea::paintGL()
     //... Field Objects
     glCallList ( m_field );
 
-    //transform world_model into showable
-    glextra.bglDrawFilterData();
+    if ( glextra ) {
+        //transform world_model into showable
+        glextra->bglDrawFilterData();
 
-    if ( show_rule_data ) {
-        glextra.bglDrawRulesystemData();
-    }
-
-    glPushMatrix();
+        if ( show_rule_data ) {
+            glextra->bglDrawRulesystemData();
+        }
 
-    //draw current game state
-    glColor3f ( 1.0, 1.0, 1.0 );
-    bitmap_output ( GLUT_BITMAP_TIMES_ROMAN_10 );
+        //draw current game state
+        glColor3f ( 1.0, 1.0, 1.0 );
+        bitmap_output();
+    }
 
     glPopMatrix();
 
-    glPopMatrix();
+    long long end = Rule_Profiler::now();
+    Metrics::repaint.record ( end - start );
+    if ( Trace::enabled() )
+        Trace::complete ( "repaint", start, end, -1, -1 );
 }
 
 void Gamearea::initializeGL()
@@ -115,11 +129,12 @@ void Gamearea::initializeGL()
     glPopMatrix();
     glEndList();
 
-    // OpenGL should refresh
+    // OpenGL should refresh, at most every refresh_interval
     setAutoBufferSwap ( true );
-    m_timer = startTimer ( 10000 );
+    m_timer = startTimer ( refresh_interval );
 
     emit showLogControl ( false );
+    emit change_show_particles ( show_particles ? "No Particles" : "Show Particles" );
 }
 
 void Gamearea::resizeGL ( int width, int height )
@@ -137,55 +152,35 @@ void Gamearea::resizeGL ( int width, int height )
     emit resizeSlider ( width );
 }
 
-///Draws next frame (calls paintGL() properly)
+///Draws next frame (calls paintGL() properly), if there is new data or the
+///game state changed, e.g. by a referee command while no frames arrive
 void Gamearea::timerEvent ( QTimerEvent* )
 {
-    glDraw();
+    if ( dirty || ( pipeline && pipeline->gamestate->get_version() != status_version ) )
+        glDraw();
 }
 
 //output of current refbox_cmd
-void Gamearea::bitmap_output ( void *font )
+void Gamearea::bitmap_output()
 {
-    char refbox_cmd[2];
-    refbox_cmd[0] = gamestate->get_refbox_cmd();
-    refbox_cmd[1] = 0;
-
-    std::string string = "";
-    string += "Current Refbox Command: ";
-    string += refbox_cmd;
-
-    glPushMatrix();
-    GLfloat x = -BSmart::Field::half_field_width;
-    GLfloat y = 2162.;
-    glRasterPos2f ( x, y );
-
-    int len, i;
-    len = string.size();
-    for ( i = 0; i < len; i++ ) {
-        glutBitmapCharacter ( font, string[i] );
+    BSmart::Game_States::State state = pipeline->gamestate->get_state();
+    if ( !status_valid || state.version != status_version ) {
+        status_cmd = "Current Refbox Command: ";
+        status_cmd += state.refbox_cmd;
+        status_play_state = "external Play_State: ";
+        status_play_state += BSmart::Game_States::play_state_string ( state.play_state );
+        status_version = state.version;
+        status_valid = true;
     }
-    glPopMatrix();
-
-    string = "external Play_State: ";
-    std::string play_state ( gamestate->play_state_string() );
-    string += play_state;
-
-    glPushMatrix();
-    x = -1500.;
-    y = 2162.;
-    glRasterPos2f ( x, y );
-
-    len = string.size();
-    for ( i = 0; i < len; i++ ) {
-        glutBitmapCharacter ( font, string[i] );
-    }
-    glPopMatrix();
+    status_font.draw ( -BSmart::Field::half_field_width, 2162., status_cmd );
+    status_font.draw ( -1500., 2162., status_play_state );
 }
 
-//Slot called from other threads to update gui
+//Slot called from other threads to update gui, once per frame. Only marks
+//the world as changed, timerEvent draws the latest data at the refresh rate
 void Gamearea::show_world()
 {
-    glDraw();
+    dirty = true;
 }
 
 //Slot called from guiactions to switch on/off Rule System Data
@@ -200,4 +195,15 @@ void Gamearea::show_rules_changed()
         QString tmp = "No Rules";
         emit change_show_rules ( tmp );
     }
+    dirty = true;
+}
+
+//Slot called from guiactions to switch on/off the particle clouds
+void Gamearea::show_particles_changed()
+{
+    show_particles = !show_particles;
+    if ( glextra )
+        glextra->set_show_particles ( show_particles );
+    dirty = true;
+    emit change_show_particles ( show_particles ? "No Particles" : "Show Particles" );
 }
@@ -1,16 +1,8 @@
 #ifndef GAMEAREA_H
 #define GAMEAREA_H
 #include <QtOpenGL/QGLWidget>
-#include <QWaitCondition>
-#include <libbsmart/game_states.h>
-#include "sslvision.h"
-#include "pre_filter_data.h"
-#include "refboxlistener.h"
-#include "filter_data.h"
-#include "particle_filter.h"
-#include "pf_tester.h"
+#include "pipeline.h"
 #include "glextra.h"
-#include "ssl_refbox_rules.h"
 
 class Gamearea : public QGLWidget
 {
@@ -23,36 +15,41 @@ public:
 	void initializeGL();
 	void resizeGL(int, int);
 	void timerEvent(QTimerEvent*);
-	void bitmap_output(void*);
-    QWaitCondition* rules_wait_condition;
-    QWaitCondition* new_data_wait_condition;
-    Pre_Filter_Data* pf_data;
-    BSmart::Game_States* gamestate;
-    SSLVision* vision;
-    RefboxListener* refbox_listener;
-    Filter_Data* filter_data;
-    Particle_Filter_Mother* particle_filter;
-    PF_Tester* pf_tester;
-    SSL_Refbox_Rules* rules;
+	void bitmap_output();
+    void start_pipeline(const ConfigFile&, const QString& start_log = "");
+    Pipeline* pipeline;
 
 public slots:
     //draw
     void show_world();
     void show_rules_changed();
+    void show_particles_changed();
 
 signals:
     //optimize Slider size
     void resizeSlider(int);
     void showLogControl(bool);
     void change_show_rules(QString);
+    void change_show_particles(QString);
 
 private:
     int m_timer;
+    //ms between repaints, gui_refresh_rate
+    int refresh_interval;
+    //new data since the last paintGL
+    bool dirty;
     GLuint  m_field;
     GLuint  world_model;
-    GLExtra glextra;
+    GLExtra* glextra;
+    Glyph_Cache status_font;
 
     BSmart::Time_Value start_time;
     bool show_rule_data;
+    bool show_particles;
+    //texts of bitmap_output, rebuilt when the game state version changes
+    bool status_valid;
+    unsigned int status_version;
+    std::string status_cmd;
+    std::string status_play_state;
 };
 #endif /* GAMEAREA_H */
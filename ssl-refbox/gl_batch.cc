@@ -0,0 +1,96 @@
+#include <GL/gl.h>
+#include <cmath>
+#include <libbsmart/math.h>
+#include "gl_batch.h"
+
+GL_Batch::GL_Batch(GLenum mode_) :
+	mode(mode_) {
+	color[0] = color[1] = color[2] = 1.f;
+}
+
+void GL_Batch::set_color(float r, float g, float b) {
+	color[0] = r;
+	color[1] = g;
+	color[2] = b;
+}
+
+/**
+ * The tables for the two segment counts used by the GUI are computed on the
+ * first use, by the GUI thread only
+ */
+const std::vector<double>& GL_Batch::unit_circle(int segments) {
+	static std::vector<double> circle, ring;
+	std::vector<double>& table = segments == RING_SEGMENTS ? ring : circle;
+	if (table.empty()) {
+		int n = segments == RING_SEGMENTS ? RING_SEGMENTS : CIRCLE_SEGMENTS;
+		for (int i = 0; i <= n; ++i) {
+			table.push_back(cos(i * 2 * BSmart::pi / n));
+			table.push_back(sin(i * 2 * BSmart::pi / n));
+		}
+	}
+	return table;
+}
+
+inline void GL_Batch::add_vertex(double x, double y, double z) {
+	vertices.push_back(x);
+	vertices.push_back(y);
+	vertices.push_back(z);
+	colors.insert(colors.end(), color, color + 3);
+}
+
+/**
+ * Filled circle as triangles around the center
+ */
+void GL_Batch::add_circle(double x, double y, double z, double radius, double rotation, int segments) {
+	const std::vector<double>& table = unit_circle(segments);
+	double c = cos(rotation) * radius;
+	double s = sin(rotation) * radius;
+	for (unsigned int i = 2; i < table.size(); i += 2) {
+		add_vertex(x, y, z);
+		add_vertex(x + table[i - 2] * c - table[i - 1] * s, y + table[i - 2] * s + table[i - 1] * c, z);
+		add_vertex(x + table[i] * c - table[i + 1] * s, y + table[i] * s + table[i + 1] * c, z);
+	}
+}
+
+void GL_Batch::add_circle_outline(double x, double y, double z, double radius, double rotation, bool spoke,
+		int segments) {
+	const std::vector<double>& table = unit_circle(segments);
+	double c = cos(rotation) * radius;
+	double s = sin(rotation) * radius;
+	if (spoke) {
+		add_vertex(x, y, z);
+		add_vertex(x + c, y + s, z);
+	}
+	for (unsigned int i = 2; i < table.size(); i += 2) {
+		add_vertex(x + table[i - 2] * c - table[i - 1] * s, y + table[i - 2] * s + table[i - 1] * c, z);
+		add_vertex(x + table[i] * c - table[i + 1] * s, y + table[i] * s + table[i + 1] * c, z);
+	}
+}
+
+void GL_Batch::add_rect(double x1, double y1, double x2, double y2, double z) {
+	add_vertex(x1, y1, z);
+	add_vertex(x2, y1, z);
+	add_vertex(x2, y2, z);
+	add_vertex(x1, y1, z);
+	add_vertex(x2, y2, z);
+	add_vertex(x1, y2, z);
+}
+
+void GL_Batch::add_line(double x1, double y1, double x2, double y2, double z) {
+	add_vertex(x1, y1, z);
+	add_vertex(x2, y2, z);
+}
+
+void GL_Batch::draw() {
+	if (!vertices.empty()) {
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+		glColorPointer(3, GL_FLOAT, 0, &colors[0]);
+		glDrawArrays(mode, 0, vertices.size() / 3);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}
+	vertices.clear();
+	colors.clear();
+}
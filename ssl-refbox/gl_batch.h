@@ -0,0 +1,52 @@
+#ifndef GL_BATCH_H
+#define GL_BATCH_H
+
+//NOTE Not including <GL/gl.h> to allow for OS X compatability..
+#ifndef GL_TRUE
+#error You must include <GL/gl.h> before including this file!
+#endif
+
+#include <vector>
+
+/**
+ * @class GL_Batch
+ * @brief Vertex and color array of many objects of one frame, drawn with a
+ * single glDrawArrays instead of a glBegin/glEnd block per object.
+ * Circles use a precomputed unit circle, a rotation costs one sin and cos
+ * per object.
+ */
+class GL_Batch
+{
+public:
+    // GL_TRIANGLES for filled, GL_LINES for outlined objects
+    GL_Batch(GLenum mode);
+
+    void set_color(float r, float g, float b);
+
+    void add_circle(double x, double y, double z, double radius, double rotation = 0., int segments = CIRCLE_SEGMENTS);
+    //outlines with spoke: line from the center to the first point, shows the rotation
+    void add_circle_outline(double x, double y, double z, double radius, double rotation = 0.,
+                            bool spoke = false, int segments = CIRCLE_SEGMENTS);
+    void add_rect(double x1, double y1, double x2, double y2, double z = 0.);
+    void add_line(double x1, double y1, double x2, double y2, double z = 0.);
+
+    //draws and clears the batch
+    void draw();
+
+    enum {
+        CIRCLE_SEGMENTS = 12,
+        RING_SEGMENTS = 24
+    };
+
+private:
+    void add_vertex(double x, double y, double z);
+    // cos and sin of the segments, segments + 1 entries
+    static const std::vector<double>& unit_circle(int segments);
+
+    GLenum mode;
+    GLfloat color[3];
+    std::vector<GLfloat> vertices;
+    std::vector<GLfloat> colors;
+};
+
+#endif //GL_BATCH_H
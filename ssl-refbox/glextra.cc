@@ -7,6 +7,7 @@
 #include <iostream>
 #include <GL/glut.h>
 #include <stdio.h>
+#include <algorithm>
 
 #include <libbsmart/field.h>
 #include <libbsmart/math.h>
@@ -16,42 +17,31 @@
 using namespace log4cxx;
 LoggerPtr GLExtra::logger(Logger::getLogger("GLExtra"));
 
-/**
- * @brief Initialize GLExtra
- */
-GLExtra::GLExtra() {
-	current_ball_percepts.clear();
-	ball_samples.clear();
-	ball_model = Ball_Sample();
-	tmp_perc_robots.clear();
-	current_robot_percepts.clear();
-	tmp_sample_robots.clear();
-	robot_samples.clear();
-	robot_models.clear();
-	broken_rule_vector.clear();
-}
-
 /**
  * @brief Initialize GLExtra
  * @param filter_data_
  */
-GLExtra::GLExtra(Filter_Data* filter_data_) {
+GLExtra::GLExtra(Filter_Data* filter_data_) :
+	robot_batch(GL_TRIANGLES), particle_batch(GL_TRIANGLES), outline_batch(GL_LINES), thick_line_batch(GL_LINES), mark_batch(GL_TRIANGLES),
+			ball_batch(GL_TRIANGLES), number_font(GLUT_BITMAP_HELVETICA_18), rule_font(GLUT_BITMAP_TIMES_ROMAN_24),
+			play_state_font(GLUT_BITMAP_TIMES_ROMAN_10) {
 	filter_data = filter_data_;
 	current_ball_percepts.clear();
 	ball_samples.clear();
 	ball_model = Ball_Sample();
-	tmp_perc_robots.clear();
 	current_robot_percepts.clear();
-	tmp_sample_robots.clear();
 	robot_samples.clear();
 	robot_models.clear();
 	broken_rule_vector.clear();
+	broken_rule_sequence = 0;
+	show_particles = false;
 	internal_play_states = BSmart::Int_Vector(0, 0);
-	gamestate = new BSmart::Game_States;
+	defense_overlay = 0;
 }
 
 GLExtra::~GLExtra() {
-	;
+	if (defense_overlay != 0)
+		glDeleteLists(defense_overlay, 2);
 }
 
 /**
@@ -229,26 +219,17 @@ void GLExtra::draw_marks() {
  * @brief Draw filter data (objects that move like robots, ball)
  */
 void GLExtra::bglDrawFilterData() {
-	tmp_perc_robots.clear();
-	current_robot_percepts.clear();
-	tmp_sample_robots.clear();
-	//    robot_samples.clear();
-	robot_models.clear();
-
-	//get data
-	current_ball_percepts = filter_data->get_current_ball_percepts();
-	//    ball_samples = filter_data->get_ball_samples();
-	ball_model = filter_data->get_ball_model();
-	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-			if (filter_data->get_robot_seen(team, id)) {
-				tmp_perc_robots = filter_data->get_current_robot_percepts(team, id);
-				current_robot_percepts.insert(current_robot_percepts.end(), tmp_perc_robots.begin(),
-						tmp_perc_robots.end());
-
-				robot_models.push_back(filter_data->get_robot_model(team, id));
-			}
-		}
+	//get data, one snapshot of the last filter cycle
+	const World_Snapshot& world = filter_data->acquire_world_snapshot(Filter_Data::GUI_READER);
+	current_ball_percepts = world.ball_percepts;
+	current_robot_percepts = world.robot_percepts;
+	ball_model = world.ball_model;
+	robot_models = world.robot_models;
+	cur_timestamp = world.timestamp;
+	std::vector<BSmart::Int_Vector> active_robots;
+	active_robots.reserve(robot_models.size());
+	for (Robot_Sample_List::iterator it = robot_models.begin(); it != robot_models.end(); it++) {
+		active_robots.push_back(BSmart::Int_Vector(it->team, it->id));
 	}
 
 	//draw data
@@ -264,8 +245,9 @@ void GLExtra::bglDrawFilterData() {
 			rotation = it->rotation;
 		}
 //		printf("p ",rotation);
-		draw_robot(it->x, it->y, it->color, rotation, -1, -1, false);
+		draw_robot(it->x, it->y, it->color, rotation, false);
 	}
+	robot_batch.draw();
 
 	//robot samples
 	/*
@@ -282,10 +264,8 @@ Gegenstand ein paar Frames nicht gesehen wird (kein Percept), kann die
 ungefähre Position auch in den folgenden Frames geschätzt werden.
 Durch höhere Streuung wegen fehlender Gewichtung natürlich ungenauer.
 	 */
-	for (Robot_Sample_List::iterator it = robot_samples.begin(); it != robot_samples.end(); it++) {
-		draw_robot(it->pos.x, it->pos.y, SSLRefbox::Colors::WHITE, it->pos.rotation, -1, -1, false);
-		LOG4CXX_DEBUG(logger,
-				"Whoohu, there was a sample. Dont know what it is actually and it does not appear in log file play mode...");
+	if (show_particles) {
+		draw_particles(active_robots);
 	}
 
 	//robot models
@@ -297,27 +277,24 @@ Kollisionsinformation. Dieses Model wird dann im Folgenden für die
 Regelüberprüfungen verwendet, pro Objekt gibt es nur ein Model.
 	 */
 	bool last_touched;
-	glLineWidth(2);
 	for (Robot_Sample_List::iterator it = robot_models.begin(); it != robot_models.end(); it++) {
 		last_touched = ((it->team == ball_model.last_touched_robot.x) && (it->id == ball_model.last_touched_robot.y));
 //		printf("m ",it->pos.rotation);
-		draw_robot(it->pos.x, it->pos.y, SSLRefbox::Colors::RED, it->pos.rotation, it->team, it->id, last_touched);
+		draw_robot(it->pos.x, it->pos.y, SSLRefbox::Colors::RED, it->pos.rotation, last_touched);
 	}
+	glLineWidth(2);
+	outline_batch.draw();
 	glLineWidth(1);
+	mark_batch.draw();
+	for (Robot_Sample_List::iterator it = robot_models.begin(); it != robot_models.end(); it++) {
+		draw_robot_number(it->pos.x, it->pos.y, it->team, it->id);
+	}
 
 	//current ball percepts
 	for (Ball_Percept_List::iterator it = current_ball_percepts.begin(); it != current_ball_percepts.end(); it++) {
 		draw_ball(it->x, it->y, 0., SSLRefbox::Colors::ORANGE);
 	}
 
-	/*
-	 //ball samples
-	 for (Ball_Sample_List::iterator it = ball_samples.begin(); it != ball_samples.end(); it++)
-	 {
-	 draw_ball(it->pos.x, it->pos.y, it->pos.z, SSLRefbox::Colors::WHITE);
-	 }
-	 */
-
 	//shadow for ball_model
 	BSmart::Pose shadow = BSmart::Pose(1., -1.);
 	shadow.normalize(ball_model.pos.z);
@@ -325,105 +302,132 @@ Regelüberprüfungen verwendet, pro Objekt gibt es nur ein Model.
 
 	//ball model
 	draw_ball(ball_model.pos.x, ball_model.pos.y, ball_model.pos.z, SSLRefbox::Colors::RED);
+	ball_batch.draw();
+
+}
 
+/**
+ * @brief Switch the particle clouds of the ball and the active robots on or off
+ */
+void GLExtra::set_show_particles(bool show) {
+	show_particles = show;
 }
 
 /**
- * @brief Draw a robot with given color to given position and mark, if it was last touched robot.
+ * @brief Draw every sample of the ball and the active robots as a small square
+ * The brightness is the weight relative to the heaviest sample of the object,
+ * the hue the status (ball) or the team (robots). All squares go into one batch.
+ */
+void GLExtra::draw_particles(const std::vector<BSmart::Int_Vector>& active_robots) {
+	// same order as Sample::Status
+	static const float status_colors[Sample::STATUS_NUM][3] = { { 1., 1., 1. }, // unknown
+			{ 1., 0.5, 0. }, // rolling
+			{ 0., 1., 1. }, // chipped
+			{ 0., 0.5, 1. }, // flying
+			{ 1., 0., 0. }, // kicked
+			{ 1., 0., 1. }, // bounced
+			{ 0.5, 1., 0. } // lying
+	};
+	static const double ball_size = BSmart::Field::ball_radius;
+	static const double robot_size = 30.;
+
+	ball_samples = filter_data->get_ball_samples();
+	double max_weight = 0.;
+	for (Ball_Sample_List::iterator it = ball_samples.begin(); it != ball_samples.end(); it++)
+		max_weight = std::max(max_weight, it->weighting);
+	for (Ball_Sample_List::iterator it = ball_samples.begin(); it != ball_samples.end(); it++) {
+		float brightness = max_weight > 0. ? 0.25 + 0.75 * it->weighting / max_weight : 1.;
+		int status = (it->status >= 0 && it->status < Sample::STATUS_NUM) ? it->status : 0;
+		particle_batch.set_color(status_colors[status][0] * brightness, status_colors[status][1] * brightness,
+				status_colors[status][2] * brightness);
+		particle_batch.add_rect(it->pos.x - ball_size / 2, it->pos.y - ball_size / 2, it->pos.x + ball_size / 2,
+				it->pos.y + ball_size / 2);
+	}
+
+	for (unsigned int i = 0; i < active_robots.size(); ++i) {
+		int team = active_robots[i].x;
+		robot_samples = filter_data->get_robot_samples(team, active_robots[i].y);
+		max_weight = 0.;
+		for (Robot_Sample_List::iterator it = robot_samples.begin(); it != robot_samples.end(); it++)
+			max_weight = std::max(max_weight, it->weighting);
+		for (Robot_Sample_List::iterator it = robot_samples.begin(); it != robot_samples.end(); it++) {
+			float brightness = max_weight > 0. ? 0.25 + 0.75 * it->weighting / max_weight : 1.;
+			if (team == 0)
+				particle_batch.set_color(brightness, brightness, 0.); // yellow
+			else
+				particle_batch.set_color(0., 0.3 * brightness, brightness); // blue
+			particle_batch.add_rect(it->pos.x - robot_size / 2, it->pos.y - robot_size / 2,
+					it->pos.x + robot_size / 2, it->pos.y + robot_size / 2);
+		}
+	}
+	particle_batch.draw();
+}
+
+/**
+ * @brief Add a robot with given color at given position to the batches of this frame and mark it,
+ * if it was last touched robot.
  * @param x x_position
  * @param y y_position
  * @param color SSLRefbox::Colors::Color, also important for team, sample and model
- * @param team team
- * @param id robot id
  * @param last_touched is this the bot that was last touched?
  */
-void GLExtra::draw_robot(int x, int y, SSLRefbox::Colors::Color color, double rotation, int team, int id,
-		bool last_touched) {
-	glPushMatrix();
-	glTranslatef(x, y, 0.);
-
+void GLExtra::draw_robot(int x, int y, SSLRefbox::Colors::Color color, double rotation, bool last_touched) {
 	switch (color) {
 	case SSLRefbox::Colors::YELLOW:
-		glColor3d(1., 1., 0.);
-		glBegin(GL_TRIANGLE_FAN);
-		glVertex3d(0., 0., 0.);
+		robot_batch.set_color(1., 1., 0.);
+		robot_batch.add_circle(x, y, 0., BSmart::Field::robot_radius, rotation);
 		break;
 
 	case SSLRefbox::Colors::BLUE:
-		glColor3d(0., 0., 1.);
-		glBegin(GL_TRIANGLE_FAN);
-		glVertex3d(0., 0., 0.);
+		robot_batch.set_color(0., 0., 1.);
+		robot_batch.add_circle(x, y, 0., BSmart::Field::robot_radius, rotation);
 		break;
 
 	case SSLRefbox::Colors::WHITE: //white: sample
-		glColor3d(1., 1., 1.);
-		glBegin(GL_LINE_STRIP);
-		if (rotation != 0)
-			glVertex3d(0., 0., 0.);
+		outline_batch.set_color(1., 1., 1.);
+		outline_batch.add_circle_outline(x, y, 0., BSmart::Field::robot_radius, rotation, rotation != 0);
 		break;
 
 	case SSLRefbox::Colors::RED: //red: model
-		glColor3d(1., 0., 0.);
-		glBegin(GL_LINE_STRIP);
-		if (rotation != 0)
-			glVertex3d(0., 0., 0.);
+		outline_batch.set_color(1., 0., 0.);
+		outline_batch.add_circle_outline(x, y, 0., BSmart::Field::robot_radius, rotation, rotation != 0);
 		break;
 
 	default: //black: default, should not happen
 		std::ostringstream o;
 		o << "unknown robot at (" << x << "|" << y << ") color: " << color << std::endl;
 		LOG4CXX_WARN(logger, o.str());
-		glColor3d(0., 0., 0.);
-		glBegin(GL_TRIANGLE_FAN);
+		robot_batch.set_color(0., 0., 0.);
+		robot_batch.add_circle(x, y, 0., BSmart::Field::robot_radius, rotation);
 	}
 
-	double f = rotation;
-//	if (abs(f) > 7) {
-//		printf("%f aaaaaaaaa\n", f);
-//	} else
-//		printf("%f\n", f);
-	for (int i = 0; i <= 12; ++i) {
-		glVertex3d(cos(f) * BSmart::Field::robot_radius, sin(f) * BSmart::Field::robot_radius, 0);
-		f = f + (2 * BSmart::pi / 12);
-	}
-	glEnd();
-
 	// mark robot that last touched ball with a grey square
 	if (last_touched) {
-		glColor3d(0.6, 0.6, 0.6); //grey
-		glBegin(GL_QUADS); // Draw a square
-		glVertex3f(-BSmart::Field::robot_radius / 2, BSmart::Field::robot_radius / 2, 0.0f); // top left
-		glVertex3f(BSmart::Field::robot_radius / 2, BSmart::Field::robot_radius / 2, 0.0f); // top right
-		glVertex3f(BSmart::Field::robot_radius / 2, -BSmart::Field::robot_radius / 2, 0.0f); // bottom right
-		glVertex3f(-BSmart::Field::robot_radius / 2, -BSmart::Field::robot_radius / 2, 0.0f); // bottom left
-		glEnd();
+		mark_batch.set_color(0.6, 0.6, 0.6); //grey
+		mark_batch.add_rect(x - BSmart::Field::robot_radius / 2, y - BSmart::Field::robot_radius / 2,
+				x + BSmart::Field::robot_radius / 2, y + BSmart::Field::robot_radius / 2);
 	}
+}
 
-	glPopMatrix();
-
-	//print the number
-	if (id != -1) {
-		std::string string = "";
-		int len = int_to_string(string, id);
-
-		glPushMatrix();
-		if (team == 1) {
-			glColor3d(1., 1., 1.); //white
-		} else if (team == 0) {
-			glColor3d(0., 0., 0.); //black
-		}
-		int bitmapWidth = glutBitmapWidth(GLUT_BITMAP_HELVETICA_18, '0') * len;
-		// center number in robot
-		glRasterPos2f(x - (BSmart::Field::robot_radius - bitmapWidth) / 2, y - 55);
-		for (int j = 0; j < len; j++) {
-			glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, string[j]);
-		}
-		glPopMatrix();
+/**
+ * @brief Print the id into a robot, after the batches are drawn
+ */
+void GLExtra::draw_robot_number(int x, int y, int team, int id) {
+	std::string string = "";
+	int_to_string(string, id);
+
+	if (team == 1) {
+		glColor3d(1., 1., 1.); //white
+	} else if (team == 0) {
+		glColor3d(0., 0., 0.); //black
 	}
+	int bitmapWidth = number_font.width(string);
+	// center number in robot
+	number_font.draw(x - (BSmart::Field::robot_radius - bitmapWidth) / 2, y - 55, string);
 }
 
 /**
- * @brief Draw ball onto surface with given position and color
+ * @brief Add a ball with given position and color to the ball batch of this frame
  * Color can be one of ORANGE (Percepts), WHITE (Filter Samples), MAGENTA (Ball shadow) or RED (Filter Model)
  * @param x
  * @param y
@@ -431,44 +435,32 @@ void GLExtra::draw_robot(int x, int y, SSLRefbox::Colors::Color color, double ro
  * @param color
  */
 void GLExtra::draw_ball(double x, double y, double z, SSLRefbox::Colors::Color color) {
-	glPushMatrix();
-	glTranslatef(x, y, z + BSmart::Field::ball_radius);
-
 	// handle color
 	switch (color) {
 	case SSLRefbox::Colors::ORANGE: // Percepts
-		glColor3d(0.96875, 0.55078125, 0.09765625);
+		ball_batch.set_color(0.96875, 0.55078125, 0.09765625);
 		break;
 
 	case SSLRefbox::Colors::WHITE: // Filter Samples
-		glColor3d(1., 1., 1.);
+		ball_batch.set_color(1., 1., 1.);
 		break;
 
 	case SSLRefbox::Colors::MAGENTA: // Ball shadow
-		glColor3d(1., 0.250980392, 1.);
+		ball_batch.set_color(1., 0.250980392, 1.);
 		break;
 
 	case SSLRefbox::Colors::RED: // Filter Model
-		glColor3d(1., 0., 0.);
+		ball_batch.set_color(1., 0., 0.);
 		break;
 
 	default: //default, should not happen
 		std::ostringstream o;
 		o << "unknown ball at (" << x << "|" << y << ") color: " << color << std::endl;
 		LOG4CXX_WARN(logger, o.str());
-		glColor3d(0., 0., 0.); //black, default
-	}
-
-	glBegin(GL_TRIANGLE_FAN);
-	glVertex3d(0., 0., 0.);
-	double f = 0.;
-	for (int i = 0; i <= 12; ++i) {
-		glVertex3d(cos(f) * BSmart::Field::ball_radius, sin(f) * BSmart::Field::ball_radius, 0);
-		f = f + (2 * BSmart::pi / 12);
+		ball_batch.set_color(0., 0., 0.); //black, default
 	}
-	glEnd();
 
-	glPopMatrix();
+	ball_batch.add_circle(x, y, z + BSmart::Field::ball_radius, BSmart::Field::ball_radius);
 }
 
 /**
@@ -504,6 +496,36 @@ int GLExtra::int_to_string(std::string& string, int i) {
 	return len;
 }
 
+/**
+ * Apply the broken rule events since the last frame and forget the rules
+ * older than 5 seconds, which are not drawn any more
+ */
+void GLExtra::update_broken_rules() {
+	std::vector<Broken_Rule_Event> events;
+	if (!filter_data->get_broken_rule_events(broken_rule_sequence, events))
+		broken_rule_vector.clear(); // missed some, start with the ones we have
+	for (std::vector<Broken_Rule_Event>::iterator event = events.begin(); event != events.end(); ++event) {
+		broken_rule_sequence = event->sequence;
+		std::vector<Broken_Rule>::iterator brit = broken_rule_vector.begin();
+		if (event->update) {
+			while (brit != broken_rule_vector.end() && brit->id != event->broken_rule.id)
+				++brit;
+		} else {
+			brit = broken_rule_vector.end();
+		}
+		if (brit != broken_rule_vector.end())
+			*brit = event->broken_rule;
+		else
+			broken_rule_vector.push_back(event->broken_rule);
+	}
+	for (std::vector<Broken_Rule>::iterator brit = broken_rule_vector.begin(); brit != broken_rule_vector.end();) {
+		if ((cur_timestamp - brit->when_broken) > 5000)
+			brit = broken_rule_vector.erase(brit);
+		else
+			++brit;
+	}
+}
+
 /**
  * Draw the following parts of GUI:
  * <ul>
@@ -518,102 +540,50 @@ int GLExtra::int_to_string(std::string& string, int i) {
  *
  */
 void GLExtra::bglDrawRulesystemData() {
-	broken_rule_vector.clear();
-	broken_rule_vector = filter_data->get_broken_rules();
 	internal_play_states = filter_data->get_internal_play_states();
-	cur_timestamp = filter_data->get_timestamp();
-	int rule_counter = 0;
-	glLineWidth(2);
+	update_broken_rules();
+	std::vector<std::string> rule_strings;
+	bool defense_area[2] = { false, false };
 
+	outline_batch.set_color(1., 0., 0.);
+	thick_line_batch.set_color(1., 0., 0.);
 	for (std::vector<Broken_Rule>::reverse_iterator brit = broken_rule_vector.rbegin();
 			brit != broken_rule_vector.rend(); ++brit) {
-		if ((cur_timestamp - brit->when_broken) > 5000) {
-			break;
-		}
 
 		//rule_breaker (the robot, who broke the rule)
 		for (Robot_Sample_List::iterator it = robot_models.begin(); it != robot_models.end(); it++) {
 			if ((it->team == brit->rule_breaker.x) && (it->id == brit->rule_breaker.y)) {
-				glPushMatrix();
-				glTranslatef(it->pos.x, it->pos.y, 0.);
-
-				double f = 0.;
-				glColor3d(1., 0., 0.);
-				glBegin(GL_LINE_STRIP);
-				for (int i = 0; i <= 24; ++i) {
-					glVertex3d(cos(f) * (BSmart::Field::robot_radius + 100.),
-							sin(f) * (BSmart::Field::robot_radius + 100.), 0);
-					f = f + (2 * BSmart::pi / 24);
-				}
-				glEnd();
-				glPopMatrix();
+				outline_batch.add_circle_outline(it->pos.x, it->pos.y, 0., BSmart::Field::robot_radius + 100., 0.,
+						false, GL_Batch::RING_SEGMENTS);
 			}
 		}
 
 		//freekick_pos
 		if (brit->freekick_pos.x != -1) {
-			glPushMatrix();
-			glLineWidth(3);
-			glTranslatef(brit->freekick_pos.x, brit->freekick_pos.y, 0.);
-			glColor3d(1., 0., 0.);
 			int l = 90;
-			glBegin(GL_LINES);
-			glVertex3d(-l, -l, 0.);
-			glVertex3d(l, l, 0.);
-			glVertex3d(-l, l, 0.);
-			glVertex3d(l, -l, 0.);
-			glEnd();
-			glLineWidth(2);
-			glPopMatrix();
+			thick_line_batch.add_line(brit->freekick_pos.x - l, brit->freekick_pos.y - l, brit->freekick_pos.x + l,
+					brit->freekick_pos.y + l);
+			thick_line_batch.add_line(brit->freekick_pos.x - l, brit->freekick_pos.y + l, brit->freekick_pos.x + l,
+					brit->freekick_pos.y - l);
 		}
 
 		//circle around ball
 		if (brit->circle_around_ball) {
-			glPushMatrix();
-			glTranslatef(ball_model.pos.x, ball_model.pos.y, 0.);
-
-			double f = 0.;
-			glColor3d(1., 0., 0.);
-			glBegin(GL_LINE_STRIP);
-			for (int i = 0; i <= 12; ++i) {
-				glVertex3d(cos(f) * (500.), sin(f) * (500.), 0);
-				f = f + (2 * BSmart::pi / 12);
-			}
-			glEnd();
-			glPopMatrix();
+			outline_batch.add_circle_outline(ball_model.pos.x, ball_model.pos.y, 0., 500.);
 		}
 
 		//defense area
-		if (brit->defense_area == 0) {
-			glPushMatrix();
-			draw_defense_area(200);
-			glPopMatrix();
-		} else if (brit->defense_area == 1) {
-			glPushMatrix();
-			glScalef(-1.0, 1.0, 1.0);
-			draw_defense_area(200);
-			glPopMatrix();
+		if (brit->defense_area == 0 || brit->defense_area == 1) {
+			defense_area[brit->defense_area] = true;
 		}
 
 		//line for smth (something?!)
 		if (brit->line_for_smth.p1.x != -1) {
-			glPushMatrix();
-			glLineWidth(3);
-			glColor3d(1., 0., 0.);
-			glBegin(GL_LINES);
-			glVertex3d(brit->line_for_smth.p1.x, brit->line_for_smth.p1.y, 0.);
-			glVertex3d(brit->line_for_smth.p2.x, brit->line_for_smth.p2.y, 0.);
-			glEnd();
-			glLineWidth(2);
-			glPopMatrix();
+			thick_line_batch.add_line(brit->line_for_smth.p1.x, brit->line_for_smth.p1.y, brit->line_for_smth.p2.x,
+					brit->line_for_smth.p2.y);
 		}
 
 		//string output for rules
-		glPushMatrix();
-		glColor3d(1., 1., 1.);
-		GLfloat x = (-BSmart::Field::half_field_width + 100);
-		GLfloat y = (BSmart::Field::half_field_height - 200) - (rule_counter * 250);
-		glRasterPos2f(x, y);
 		std::string tmp = "";
 
 		std::string string;
@@ -648,56 +618,57 @@ void GLExtra::bglDrawRulesystemData() {
 			int_to_string(tmp, brit->rule_breaker.y);
 			string += tmp;
 		}
+		rule_strings.push_back(string);
+	}
+
+	glLineWidth(2);
+	outline_batch.draw();
+	glLineWidth(3);
+	thick_line_batch.draw();
+	glLineWidth(1);
 
-		int len, i;
-		len = string.size();
-		void *font = GLUT_BITMAP_TIMES_ROMAN_24;
-		for (i = 0; i < len; i++) {
-			glutBitmapCharacter(font, string[i]);
+	if (defense_area[0] || defense_area[1]) {
+		if (defense_overlay == 0)
+			create_defense_overlay();
+		glColor3d(1., 0., 0.);
+		for (int side = 0; side < 2; ++side) {
+			if (defense_area[side])
+				glCallList(defense_overlay + side);
 		}
-		glPopMatrix();
+	}
 
-		rule_counter++;
+	glColor3d(1., 1., 1.);
+	for (unsigned int i = 0; i < rule_strings.size(); ++i) {
+		GLfloat x = (-BSmart::Field::half_field_width + 100);
+		GLfloat y = (BSmart::Field::half_field_height - 200) - (i * 250);
+		rule_font.draw(x, y, rule_strings[i]);
 	}
 
 	//Draw Play_States
-	gamestate->set_play_state((BSmart::Game_States::Play_State) internal_play_states.x);
-	std::string play_state_intern(gamestate->play_state_string());
+	std::string play_state_intern(
+			BSmart::Game_States::play_state_string((BSmart::Game_States::Play_State) internal_play_states.x));
+	play_state_font.draw(-1480., 2052., "internal Play_State: " + play_state_intern);
 
-	std::string string = "internal Play_State: ";
-	string += play_state_intern;
+	std::string play_state_intern_next(
+			BSmart::Game_States::play_state_string((BSmart::Game_States::Play_State) internal_play_states.y));
+	play_state_font.draw(1020., 2052., "next internal Play_State: " + play_state_intern_next);
+}
 
+/**
+ * @brief Compile the defense areas of a broken rule (200 mm wider) into two lists, left and right
+ */
+void GLExtra::create_defense_overlay() {
+	defense_overlay = glGenLists(2);
+	glNewList(defense_overlay, GL_COMPILE);
 	glPushMatrix();
-	glColor3d(1., 1., 1.);
-	GLfloat x = -1480.;
-	GLfloat y = 2052.;
-	glRasterPos2f(x, y);
-
-	int len, i;
-	len = string.size();
-	for (i = 0; i < len; i++) {
-		glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_10, string[i]);
-	}
+	draw_defense_area(200);
 	glPopMatrix();
+	glEndList();
 
-	gamestate->set_play_state((BSmart::Game_States::Play_State) internal_play_states.y);
-	std::string play_state_intern_next(gamestate->play_state_string());
-
-	string = "next internal Play_State: ";
-	string += play_state_intern_next;
-
+	glNewList(defense_overlay + 1, GL_COMPILE);
 	glPushMatrix();
-	glColor3d(1., 1., 1.);
-	x = 1020.;
-	y = 2052.;
-	glRasterPos2f(x, y);
-
-	len = string.size();
-	for (i = 0; i < len; i++) {
-		glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_10, string[i]);
-	}
+	glScalef(-1.0, 1.0, 1.0);
+	draw_defense_area(200);
 	glPopMatrix();
-
-	glLineWidth(1);
+	glEndList();
 }
-
@@ -11,6 +11,8 @@
 #endif
 
 #include <GL/glu.h>
+#include "gl_batch.h"
+#include "glyph_cache.h"
 #include "pre_filter_data.h"
 #include "filter_data.h"
 #include "colors.h"
@@ -42,7 +44,6 @@ public:
     Q_ALL = Q_I | Q_II | Q_III | Q_IV   //full  circle
     }; /* enum Quadrant */
 
-    GLExtra();
     GLExtra(Filter_Data*);
     ~GLExtra();
 
@@ -53,6 +54,9 @@ public:
 
     void bglDrawRulesystemData();
 
+    //samples of the ball and the robots, off by default
+    void set_show_particles(bool);
+
 private:
     static log4cxx::LoggerPtr logger;
     ///Plot all symmetric points to given (x,y). \see bglBresCircle
@@ -82,26 +86,44 @@ private:
     //ball_model
     Ball_Sample ball_model;
     //robot_percepts
-    Robot_Percept_List tmp_perc_robots;
     Robot_Percept_List current_robot_percepts;
     //robot_samples
-    Robot_Sample_List tmp_sample_robots;
     Robot_Sample_List robot_samples;
     //robot_models
     Robot_Sample_List robot_models;
 
     long long cur_timestamp;
 
-    void draw_robot(int, int, SSLRefbox::Colors::Color, double rotation = 0, int team = -1, int id = -1, bool last_touched = false);
+    void draw_robot(int, int, SSLRefbox::Colors::Color, double rotation = 0, bool last_touched = false);
+
+    void draw_robot_number(int, int, int team, int id);
 
     void draw_ball(double, double, double, SSLRefbox::Colors::Color);
 
+    bool show_particles;
+    void draw_particles(const std::vector<BSmart::Int_Vector>& active_robots);
+
+    //geometry of one frame, drawn with one call per batch
+    GL_Batch robot_batch;
+    GL_Batch particle_batch;
+    GL_Batch outline_batch;
+    GL_Batch thick_line_batch;
+    GL_Batch mark_batch;
+    GL_Batch ball_batch;
+    Glyph_Cache number_font;
+    Glyph_Cache rule_font;
+    Glyph_Cache play_state_font;
+    //highlighted defense areas, Bresenham points compiled once
+    GLuint defense_overlay;
+    void create_defense_overlay();
+
     int int_to_string(std::string& string, int i);
 
-    //container for RulesystemData
+    //container for RulesystemData, kept up to date by the broken rule events
     std::vector<Broken_Rule> broken_rule_vector;
+    unsigned long broken_rule_sequence;
+    void update_broken_rules();
     BSmart::Int_Vector internal_play_states;
-    BSmart::Game_States* gamestate;
 };
 
 #endif /* _BSMARTGUI_GL_EXTRA_H_ */
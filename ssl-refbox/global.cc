@@ -4,6 +4,7 @@
  */
 #include "global.h"
 #include "../ConfigFile/ConfigFile.h"
+#include "filter_parameters.h"
 #include <iostream>
 #include <stdlib.h>
 #include <string.h>
@@ -18,16 +19,10 @@ using namespace std;
 LoggerPtr logger42(Logger::getLogger("Global"));
 
 /**
- * @brief global reference to the config file
+ * @brief path of the loaded config file, saveConfig writes to it
  */
-ConfigFile Global::config;
 string Global::configFilePath;
 
-/**
- * @brief global reference to the log file to load on start
- */
-char* Global::logFile;
-
 /**
  * @brief A list of all rule names
  */
@@ -83,17 +78,18 @@ const std::string Global::rulenames[42] = { "Robot Number exceeded", //1
  * 3. In /etc/
  * The config file has to be called ssl-autonomous-refbox.conf
  * @param custConfig custom config file to try first
+ * @param config filled with the settings of the file
  */
-void Global::loadConfig(string custConfig) {
+void Global::loadConfig(string custConfig, ConfigFile& config) {
 	if (custConfig.empty()) {
-		setConfigPath();
+		setConfigPath(config);
 	} else {
 		configFilePath = custConfig;
 	}
 
 	std::ifstream in(configFilePath.c_str());
 	if (in) {
-		in >> Global::config;
+		in >> config;
 		LOG4CXX_INFO( logger42, "ConfigFile " + configFilePath + " loaded.");
 	} else {
 		LOG4CXX_DEBUG( logger42, "ConfigFile " + configFilePath + " not found.");
@@ -103,11 +99,11 @@ void Global::loadConfig(string custConfig) {
 /**
  * @brief Save config file.
  */
-bool Global::saveConfig() {
+bool Global::saveConfig(const ConfigFile& config) {
 
 	std::ofstream out(configFilePath.c_str());
 	if (out) {
-		out << Global::config;
+		out << config;
 		LOG4CXX_INFO( logger42, "ConfigFile " + configFilePath + " saved.");
 		return true;
 	}
@@ -118,7 +114,7 @@ bool Global::saveConfig() {
  * @brief set config path, if there no config a new config file will be created
  * The config file has to be called ssl-autonomous-refbox.conf
  */
-void Global::setConfigPath() {
+void Global::setConfigPath(ConfigFile& config) {
 	string configFile = "ssl-autonomous-refbox.conf";
 
 	string home = getenv("HOME");
@@ -134,14 +130,14 @@ void Global::setConfigPath() {
 		LOG4CXX_INFO( logger42, "ConfigFile " + configFilePath + " found.");
 	} else {
 		LOG4CXX_INFO( logger42, "No ConfigFile found.");
-		createDefaultConfigFile(configFilePath);
+		createDefaultConfigFile(configFilePath, config);
 	}
 }
 
 /**
  * @brief create a config file with default values
  */
-void Global::createDefaultConfigFile(string path) {
+void Global::createDefaultConfigFile(string path, ConfigFile& config) {
 	config.add("ssl_vision_ip", "224.5.23.2");
 	config.add("ssl_vision_port", "10002	");
 
@@ -151,6 +147,46 @@ void Global::createDefaultConfigFile(string path) {
 	config.add("cam_height", "580");
 	config.add("cam_width", "780");
 
+	// GUI repaints per second at most, new data in between is drawn with the next repaint
+	config.add("gui_refresh_rate", "60");
+
+	// draw the samples of the particle filter at start, can be switched in the GUI
+	config.add("show_particles", "0");
+
+	// robot ids 0..robot_ids-1 are tracked, max_robots per team are allowed
+	config.add("robot_ids", "16");
+	config.add("max_robots", "6");
+
+	// rule check: prolog, native or compare (both engines, divergences are logged)
+	config.add("rule_engine", "prolog");
+
+	// time every rule and predicate call of the rules thread, dump with SIGUSR1
+	config.add("rule_profile", "0");
+
+	// file for the input of the rules in every cycle, replay with --replay-rules, empty: off
+	config.add("record_tracked_state", "");
+
+	// latency histograms of the pipeline on http://127.0.0.1:<port>/metrics, 0: off
+	config.add("metrics_port", "0");
+
+	// timeline of the pipeline threads for chrome://tracing, written on SIGUSR2 and at exit, empty: off
+	config.add("trace_file", "");
+
+	// particle filter tuning, filter_<name> for every value of Filter_Parameters
+	Filter_Parameters parameters;
+	for (int i = 0; i < Filter_Parameters::COUNT; ++i)
+		config.add(string("filter_") + Filter_Parameters::name(i), parameters.value(i));
+
+	// estimator of the robots: particle or kalman, the ball always has the particle filter
+	config.add("filter_robot_tracker", Filter_Parameters::tracker_name(parameters.robot_tracker));
+
+	// file for the input of the particle filter in every cycle, replay with --sweep, empty: off
+	config.add("record_percepts", "");
+
+	// values tried by --sweep, e.g. sweep_std_dev_ball = 3 5 8, empty: filter_<name> only
+	for (int i = 0; i < Filter_Parameters::COUNT; ++i)
+		config.add(string("sweep_") + Filter_Parameters::name(i), "");
+
 	struct stat st;
 	if (stat(path.c_str(), &st) != 0) {
 		char* confPath = new char[path.length()];
@@ -158,7 +194,7 @@ void Global::createDefaultConfigFile(string path) {
 		mkdir(dirname(confPath), S_IRWXU | S_IRWXG | S_IRWXO);
 	}
 
-	if (saveConfig()) {
+	if (saveConfig(config)) {
 		LOG4CXX_INFO( logger42, "Default ConfigFile " + path + " created.");
 	} else {
 		LOG4CXX_ERROR( logger42, "Default ConfigFile " + path + " could not be created.");
@@ -17,15 +17,14 @@ using namespace std;
 class Global {
 private:
 	static log4cxx::LoggerPtr logger;
-	static void setConfigPath();
-	static void createDefaultConfigFile(string path);
+	static void setConfigPath(ConfigFile& config);
+	static void createDefaultConfigFile(string path, ConfigFile& config);
 	static string configFilePath;
 
 public:
     static const std::string rulenames[42];
-	static ConfigFile config;
-	static char* logFile;
-	static void loadConfig(string);
-	static bool saveConfig();
+	// the config belongs to the caller, every pipeline gets its own copy
+	static void loadConfig(string, ConfigFile& config);
+	static bool saveConfig(const ConfigFile& config);
 };
 #endif
@@ -0,0 +1,61 @@
+#include <GL/gl.h>
+#include <GL/glut.h>
+#include "glyph_cache.h"
+
+Glyph_Cache::Glyph_Cache(void* font_) :
+	font(font_) {
+	base = 0;
+	for (int i = 0; i < GLYPHS; ++i)
+		widths[i] = 0;
+}
+
+Glyph_Cache::~Glyph_Cache() {
+	if (base != 0)
+		glDeleteLists(base, GLYPHS);
+}
+
+void Glyph_Cache::create() {
+	base = glGenLists(GLYPHS);
+	for (int i = 0; i < GLYPHS; ++i) {
+		glNewList(base + i, GL_COMPILE);
+		if (i >= ' ')
+			glutBitmapCharacter(font, i);
+		glEndList();
+		widths[i] = glutBitmapWidth(font, i);
+	}
+}
+
+void Glyph_Cache::draw(float x, float y, const std::string& string) {
+	if (base == 0)
+		create();
+	glRasterPos2f(x, y);
+	// there are lists for ASCII only, other bytes (UTF-8, Latin-1) are drawn as '?'
+	const std::string* ascii = &string;
+	std::string replaced;
+	for (unsigned int i = 0; i < string.size(); ++i) {
+		if ((unsigned char) string[i] >= GLYPHS) {
+			replaced = string;
+			for (unsigned int j = i; j < replaced.size(); ++j) {
+				if ((unsigned char) replaced[j] >= GLYPHS)
+					replaced[j] = '?';
+			}
+			ascii = &replaced;
+			break;
+		}
+	}
+	glPushAttrib(GL_LIST_BIT);
+	glListBase(base);
+	glCallLists(ascii->size(), GL_UNSIGNED_BYTE, ascii->data());
+	glPopAttrib();
+}
+
+int Glyph_Cache::width(const std::string& string) {
+	if (base == 0)
+		create();
+	int sum = 0;
+	for (unsigned int i = 0; i < string.size(); ++i) {
+		unsigned char c = string[i];
+		sum += widths[c < GLYPHS ? c : '?'];
+	}
+	return sum;
+}
@@ -0,0 +1,46 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+//NOTE Not including <GL/gl.h> to allow for OS X compatability..
+#ifndef GL_TRUE
+#error You must include <GL/gl.h> before including this file!
+#endif
+
+#include <string>
+
+/**
+ * @class Glyph_Cache
+ * @brief The ASCII characters of one GLUT bitmap font, compiled into display
+ * lists, so a string is drawn with one glCallLists. Other bytes are drawn
+ * as '?'.
+ * The lists are created with the first draw, which has to happen with the GL
+ * context of the widget current.
+ */
+class Glyph_Cache
+{
+public:
+    Glyph_Cache(void* font);
+    ~Glyph_Cache();
+
+    //draws at the raster position (x, y) with the current color
+    void draw(float x, float y, const std::string&);
+    //width in pixels
+    int width(const std::string&);
+
+private:
+    enum {
+        GLYPHS = 128
+    };
+
+    //a copy would delete the lists twice
+    Glyph_Cache(const Glyph_Cache&);
+    Glyph_Cache& operator=(const Glyph_Cache&);
+
+    void create();
+
+    void* font;
+    GLuint base;
+    int widths[GLYPHS];
+};
+
+#endif //GLYPH_CACHE_H
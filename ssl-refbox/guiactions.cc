@@ -11,8 +11,8 @@
 #include <ctime>
 #include "GuiPropertiesDlg.h"
 
-GuiActions::GuiActions(Ui::GuiControls* gui, QObject* win) :
-		QObject(win), m_gui(gui) {
+GuiActions::GuiActions(Ui::GuiControls* gui, ConfigFile& config_, QObject* win) :
+		QObject(win), m_gui(gui), config(config_) {
 	brokenRulesModel = new QStandardItemModel(0, 5);
 	brokenRulesModel->setHorizontalHeaderItem(0, new QStandardItem(QString("Time")));
 	brokenRulesModel->setHorizontalHeaderItem(1, new QStandardItem(QString("Rulename")));
@@ -30,64 +30,69 @@ void GuiActions::connectActions() {
 	connect(m_gui->actionOPen, SIGNAL ( triggered() ), this, SLOT ( showPropertiesDlg() ));
 
 	//Buttons for load/start logfile
-	connect(m_gui->record_log, SIGNAL ( clicked() ), m_gui->gamearea->vision, SLOT ( record() ));
-	connect(m_gui->load_log, SIGNAL ( clicked() ), m_gui->gamearea->vision, SLOT ( play_record() ));
-	connect(m_gui->gamearea->vision, SIGNAL ( change_record_button ( QString ) ), this,
+	connect(m_gui->record_log, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision, SLOT ( record() ));
+	connect(m_gui->load_log, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision, SLOT ( play_record() ));
+	connect(m_gui->gamearea->pipeline->vision, SIGNAL ( change_record_button ( QString ) ), this,
 			SLOT ( change_record_button ( QString ) ));
-	connect(m_gui->gamearea->vision, SIGNAL ( change_play_button ( QString ) ), this,
+	connect(m_gui->gamearea->pipeline->vision, SIGNAL ( change_play_button ( QString ) ), this,
 			SLOT ( change_play_button ( QString ) ));
 
 	//Buttons for logfile control
-	connect(m_gui->log_forward, SIGNAL ( clicked() ), m_gui->gamearea->vision->log_control, SLOT ( log_forward() ));
-	connect(m_gui->log_play, SIGNAL ( clicked() ), m_gui->gamearea->vision->log_control, SLOT ( log_play() ));
-	connect(m_gui->log_backward, SIGNAL ( clicked() ), m_gui->gamearea->vision->log_control, SLOT ( log_backward() ));
-	connect(m_gui->log_pause, SIGNAL ( clicked() ), m_gui->gamearea->vision->log_control, SLOT ( log_pause() ));
-	connect(m_gui->log_faster, SIGNAL ( clicked() ), m_gui->gamearea->vision->log_control, SLOT ( log_faster() ));
-	connect(m_gui->log_slower, SIGNAL ( clicked() ), m_gui->gamearea->vision->log_control, SLOT ( log_slower() ));
+	connect(m_gui->log_forward, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision->log_control, SLOT ( log_forward() ));
+	connect(m_gui->log_play, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision->log_control, SLOT ( log_play() ));
+	connect(m_gui->log_backward, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision->log_control, SLOT ( log_backward() ));
+	connect(m_gui->log_pause, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision->log_control, SLOT ( log_pause() ));
+	connect(m_gui->log_faster, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision->log_control, SLOT ( log_faster() ));
+	connect(m_gui->log_slower, SIGNAL ( clicked() ), m_gui->gamearea->pipeline->vision->log_control, SLOT ( log_slower() ));
 	connect(m_gui->log_frame_back, SIGNAL ( clicked() ), this, SLOT ( log_frame_back() ));
 	connect(m_gui->log_frame_forward, SIGNAL ( clicked() ), this, SLOT ( log_frame_forward() ));
 
 	//Slider control
-	connect(m_gui->gamearea->vision, SIGNAL ( initializeSlider ( int,int,int,int,int ) ), this,
+	connect(m_gui->gamearea->pipeline->vision, SIGNAL ( initializeSlider ( int,int,int,int,int ) ), this,
 			SLOT ( initializeSlider ( int, int, int, int, int ) ));
-//        connect(m_gui->gamearea->vision, SIGNAL(update_frame(int)), m_gui->horizontalSlider,              SLOT(setValue(int)));
+//        connect(m_gui->gamearea->pipeline->vision, SIGNAL(update_frame(int)), m_gui->horizontalSlider,              SLOT(setValue(int)));
 	connect(m_gui->horizontalSlider, SIGNAL ( actionTriggered ( int ) ), this, SLOT ( slider_action ( int ) ));
-	connect(this, SIGNAL ( goto_frame ( int ) ), m_gui->gamearea->vision->log_control, SLOT ( goto_frame ( int ) ));
-	connect(m_gui->horizontalSlider, SIGNAL ( sliderPressed() ), m_gui->gamearea->vision->log_control,
+	connect(this, SIGNAL ( goto_frame ( int ) ), m_gui->gamearea->pipeline->vision->log_control, SLOT ( goto_frame ( int ) ));
+	connect(m_gui->horizontalSlider, SIGNAL ( sliderPressed() ), m_gui->gamearea->pipeline->vision->log_control,
 			SLOT ( log_pause() ));
-	connect(m_gui->horizontalSlider, SIGNAL ( sliderReleased() ), m_gui->gamearea->vision->log_control,
+	connect(m_gui->horizontalSlider, SIGNAL ( sliderReleased() ), m_gui->gamearea->pipeline->vision->log_control,
 			SLOT ( log_resume() ));
 	connect(m_gui->gamearea, SIGNAL ( resizeSlider ( int ) ), this, SLOT ( resizeSlider ( int ) ));
 
 	//Log Control
-	connect(m_gui->gamearea->vision, SIGNAL ( showLogControl ( bool ) ), m_gui->logControl,
+	connect(m_gui->gamearea->pipeline->vision, SIGNAL ( showLogControl ( bool ) ), m_gui->logControl,
 			SLOT ( setVisible ( bool ) ));
 	connect(m_gui->gamearea, SIGNAL ( showLogControl ( bool ) ), m_gui->logControl, SLOT ( setVisible ( bool ) ));
-	connect(m_gui->gamearea->vision, SIGNAL ( update_frame ( int ) ), this, SLOT ( update_frame ( int ) ));
+	connect(m_gui->gamearea->pipeline->vision, SIGNAL ( update_frame ( int ) ), this, SLOT ( update_frame ( int ) ));
 
 	//QLCDNumber control
-	//    connect(m_gui->gamearea->vision, SIGNAL(update_frame(int)), m_gui->log_frameNumber, SLOT(display(int)));
-	connect(m_gui->gamearea->vision, SIGNAL ( log_size ( int ) ), m_gui->log_totalFrames, SLOT ( display ( int ) ));
-	connect(m_gui->gamearea->vision->log_control, SIGNAL ( update_speed ( QString ) ), m_gui->log_speed,
+	//    connect(m_gui->gamearea->pipeline->vision, SIGNAL(update_frame(int)), m_gui->log_frameNumber, SLOT(display(int)));
+	connect(m_gui->gamearea->pipeline->vision, SIGNAL ( log_size ( int ) ), m_gui->log_totalFrames, SLOT ( display ( int ) ));
+	connect(m_gui->gamearea->pipeline->vision->log_control, SIGNAL ( update_speed ( QString ) ), m_gui->log_speed,
 			SLOT ( setText ( QString ) ));
 
 	//Ball Status
-	connect(m_gui->gamearea->particle_filter, SIGNAL ( change_ball_status ( QString ) ), this,
+	connect(m_gui->gamearea->pipeline->particle_filter, SIGNAL ( change_ball_status ( QString ) ), this,
 			SLOT ( change_ball_status ( QString ) ));
-	connect(m_gui->gamearea->particle_filter, SIGNAL ( change_ball_last_touched ( QString ) ), this,
+	connect(m_gui->gamearea->pipeline->particle_filter, SIGNAL ( change_ball_last_touched ( QString ) ), this,
 			SLOT ( change_ball_last_touched ( QString ) ));
 
 	//Rule System Data
 	connect(m_gui->show_rules, SIGNAL ( clicked() ), m_gui->gamearea, SLOT ( show_rules_changed() ));
 	connect(m_gui->gamearea, SIGNAL ( change_show_rules ( QString ) ), this, SLOT ( change_show_rules ( QString ) ));
 
+	//Particle clouds
+	connect(m_gui->show_particles, SIGNAL ( clicked() ), m_gui->gamearea, SLOT ( show_particles_changed() ));
+	connect(m_gui->gamearea, SIGNAL ( change_show_particles ( QString ) ), this,
+			SLOT ( change_show_particles ( QString ) ));
+
 	// frame text box
 	connect(m_gui->log_frameNumber, SIGNAL ( textChanged() ), this, SLOT ( gotoFrameInTextBox() ));
-	connect(m_gui->gamearea->vision->log_control, SIGNAL ( enable_log_frameNumber( bool ) ), this,
+	connect(m_gui->gamearea->pipeline->vision->log_control, SIGNAL ( enable_log_frameNumber( bool ) ), this,
 			SLOT ( setLogFrameNumberEnabled(bool) ));
 
 	// broken rules
-	connect(m_gui->gamearea->rules, SIGNAL ( new_broken_rule( Broken_Rule* ) ), this,
+	connect(m_gui->gamearea->pipeline->rules, SIGNAL ( new_broken_rule( Broken_Rule* ) ), this,
 			SLOT ( insert_into_lst_broken_rules( Broken_Rule* ) ));
 	connect(m_gui->tbl_brokenRules, SIGNAL ( clicked ( QModelIndex ) ), this,
 			SLOT ( brokenRuleRowSelected( QModelIndex ) ));
@@ -159,8 +164,8 @@ void GuiActions::change_ball_last_touched(QString text) {
 }
 
 void GuiActions::update_frame(int frame) {
-	if (m_gui->gamearea->vision->log_control->get_play_speed() != 0.0) {
-		if (frame % ((int) m_gui->gamearea->vision->log_control->get_play_speed() * 10) == 0)
+	if (m_gui->gamearea->pipeline->vision->log_control->get_play_speed() != 0.0) {
+		if (frame % ((int) m_gui->gamearea->pipeline->vision->log_control->get_play_speed() * 10) == 0)
 			force_update_frame(frame);
 	}
 }
@@ -174,7 +179,7 @@ void GuiActions::slider_action(int action) {
 	if (action != 0) {
 		emit goto_frame(m_gui->horizontalSlider->value());
 		m_gui->log_frameNumber->setPlainText(
-				QString::number(m_gui->gamearea->vision->log_control->get_current_frame()));
+				QString::number(m_gui->gamearea->pipeline->vision->log_control->get_current_frame()));
 	}
 }
 
@@ -188,9 +193,9 @@ void GuiActions::gotoFrameInTextBox() {
 
 	bool suc = 0;
 	int frame = frameStr.toInt(&suc, 10);
-//	if(m_gui->gamearea->vision->log_control->get_play_speed()==0.0 && suc) {
+//	if(m_gui->gamearea->pipeline->vision->log_control->get_play_speed()==0.0 && suc) {
 	emit goto_frame(frame);
-	force_update_frame(m_gui->gamearea->vision->log_control->get_current_frame());
+	force_update_frame(m_gui->gamearea->pipeline->vision->log_control->get_current_frame());
 //	}
 }
 
@@ -198,18 +203,22 @@ void GuiActions::change_show_rules(QString text) {
 	m_gui->show_rules->setText(text);
 }
 
+void GuiActions::change_show_particles(QString text) {
+	m_gui->show_particles->setText(text);
+}
+
 void GuiActions::setLogFrameNumberEnabled(bool b) {
 	m_gui->log_frameNumber->setEnabled(b);
 }
 
 void GuiActions::log_frame_back() {
-	m_gui->gamearea->vision->log_control->log_frame_back();
-	force_update_frame(m_gui->gamearea->vision->log_control->get_current_frame());
+	m_gui->gamearea->pipeline->vision->log_control->log_frame_back();
+	force_update_frame(m_gui->gamearea->pipeline->vision->log_control->get_current_frame());
 }
 
 void GuiActions::log_frame_forward() {
-	m_gui->gamearea->vision->log_control->log_frame_forward();
-	force_update_frame(m_gui->gamearea->vision->log_control->get_current_frame());
+	m_gui->gamearea->pipeline->vision->log_control->log_frame_forward();
+	force_update_frame(m_gui->gamearea->pipeline->vision->log_control->get_current_frame());
 }
 
 void GuiActions::insert_into_lst_broken_rules(Broken_Rule *brokenRule) {
@@ -269,16 +278,16 @@ void GuiActions::brokenRuleRowSelected(QModelIndex index) {
 	 * 5. manage recording in the meantime
 	 */
 
-//	m_gui->gamearea->vision->play_record(logFile);
+//	m_gui->gamearea->pipeline->vision->play_record(logFile);
 
 	int frame = brokenRulesModel->data(brokenRulesModel->index(index.row(), 4)).toInt();
 	frame -= 100;
 	if(frame < 0) frame = 0;
 	emit goto_frame(frame);
-	force_update_frame(m_gui->gamearea->vision->log_control->get_current_frame());
+	force_update_frame(m_gui->gamearea->pipeline->vision->log_control->get_current_frame());
 }
 
 void GuiActions::showPropertiesDlg() {
-	GuiPropertiesDlg *propDlg = new GuiPropertiesDlg();
+	GuiPropertiesDlg *propDlg = new GuiPropertiesDlg(config);
 	propDlg->show();
 }
@@ -1,6 +1,7 @@
 #include <QObject>
 #include <QStandardItemModel>
 #include "filter_data.h"
+#include "../ConfigFile/ConfigFile.h"
 namespace Ui { class GuiControls; }
 
 class GuiActions : public QObject
@@ -9,7 +10,7 @@ Q_OBJECT
 Ui::GuiControls* m_gui;
 
 public:
-    GuiActions(Ui::GuiControls*, QObject* = 0);
+    GuiActions(Ui::GuiControls*, ConfigFile&, QObject* = 0);
     ~GuiActions();
     void connectActions();
 
@@ -27,6 +28,7 @@ public slots:
     void update_frame(int);
     void slider_action(int);
     void change_show_rules(QString);
+    void change_show_particles(QString);
     void gotoFrameInTextBox ();
     void setLogFrameNumberEnabled(bool);
     void force_update_frame ( int );
@@ -37,4 +39,5 @@ public slots:
     void brokenRuleRowSelected(QModelIndex);
 private:
     QStandardItemModel *brokenRulesModel;
+    ConfigFile& config;
 };
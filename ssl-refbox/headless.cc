@@ -0,0 +1,59 @@
+#include "headless.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include <fstream>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Headless::logger(Logger::getLogger("Headless"));
+
+volatile sig_atomic_t Headless::stop_requested = 0;
+
+Headless::Headless(const ConfigFile& config_, const QString& start_log_) :
+	config(config_), start_log(start_log_) {
+	pipeline = NULL;
+}
+
+/**
+ * The threads of the pipeline run until the end of the process, like with
+ * the GUI
+ */
+int Headless::run(std::ostream& decisions) {
+	if (!start_log.isEmpty() && !std::ifstream(start_log.toAscii().constData())) {
+		LOG4CXX_ERROR( logger, std::string("Could not read log file ") + start_log.toAscii().constData());
+		return 1;
+	}
+
+	signal(SIGINT, request_stop);
+	signal(SIGTERM, request_stop);
+
+	pipeline = new Pipeline(config, start_log);
+	pipeline->rules->set_report(&decisions);
+	connect(pipeline->vision, SIGNAL ( play_record_ended() ), this, SLOT ( play_record_ended() ));
+	QTimer* stop_timer = new QTimer(this);
+	connect(stop_timer, SIGNAL ( timeout() ), this, SLOT ( check_stop() ));
+	stop_timer->start(STOP_POLL_MS);
+
+	pipeline->start();
+	if (start_log.isEmpty())
+		LOG4CXX_INFO( logger, "Running on live vision, stop with SIGINT or SIGTERM");
+	else
+		LOG4CXX_INFO( logger, std::string("Running on ") + start_log.toAscii().constData());
+	return QCoreApplication::exec();
+}
+
+void Headless::play_record_ended() //SLOT
+{
+	LOG4CXX_INFO( logger, "End of the log file");
+	QTimer::singleShot(DRAIN_MS, QCoreApplication::instance(), SLOT ( quit() ));
+}
+
+void Headless::check_stop() //SLOT
+{
+	if (stop_requested)
+		QCoreApplication::quit();
+}
+
+void Headless::request_stop(int) {
+	stop_requested = 1;
+}
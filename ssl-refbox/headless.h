@@ -0,0 +1,53 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QObject>
+#include <QString>
+#include <ostream>
+#include <csignal>
+#include "pipeline.h"
+#include "../ConfigFile/ConfigFile.h"
+#include <log4cxx/logger.h>
+
+/**
+ * @class Headless
+ * @brief The pipeline without GUI, OpenGL and display (--headless), on live
+ * vision or a log file. The decisions are the report lines of the rules
+ * (see SSL_Refbox_Rules::set_replay), the metrics are served on metrics_port
+ * like with the GUI. Needs a QCoreApplication for the signals between the
+ * pipeline threads.
+ */
+class Headless : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum {
+        //the filter and rules get this long for the last frames of the log
+        DRAIN_MS = 500,
+        //SIGINT and SIGTERM are handled in the event loop this often
+        STOP_POLL_MS = 100
+    };
+
+    // start_log is played instead of live vision, if not empty
+    Headless(const ConfigFile&, const QString& start_log);
+
+    // until SIGINT, SIGTERM or the end of start_log, exit code
+    int run(std::ostream& decisions);
+
+private slots:
+    void play_record_ended();
+    void check_stop();
+
+private:
+    static log4cxx::LoggerPtr logger;
+
+    static volatile sig_atomic_t stop_requested;
+    static void request_stop(int);
+
+    const ConfigFile& config;
+    QString start_log;
+    Pipeline* pipeline;
+};
+
+#endif //HEADLESS_H
@@ -0,0 +1,120 @@
+#include "kalman_robot_tracker.h"
+#include <libbsmart/math.h>
+#include <cmath>
+
+// uncertainty of the velocity of a new track: 2 m/s and 10 rad/s
+static const double START_SPEED_VARIANCE = 2. * 2.;
+static const double START_TURN_VARIANCE = 0.01 * 0.01;
+
+void Kalman_Robot_Tracker::Axis::reset(double pos_, double pos_var, double vel_var) {
+	pos = pos_;
+	vel = 0.;
+	p00 = pos_var;
+	p01 = 0.;
+	p11 = vel_var;
+}
+
+void Kalman_Robot_Tracker::Axis::predict(double dt, double q) {
+	pos += vel * dt;
+	// F P F^T + G q G^T with F = [1 dt; 0 1], G = [dt^2/2; dt]
+	const double dt2 = dt * dt;
+	p00 += dt * (2. * p01 + dt * p11) + q * dt2 * dt2 / 4.;
+	p01 += dt * p11 + q * dt2 * dt / 2.;
+	p11 += q * dt2;
+}
+
+void Kalman_Robot_Tracker::Axis::update(double innovation, double r) {
+	// only the position is measured, H = [1 0]
+	const double s = p00 + r;
+	const double k0 = p00 / s;
+	const double k1 = p01 / s;
+	pos += k0 * innovation;
+	vel += k1 * innovation;
+	p11 -= k1 * p01;
+	p01 -= k0 * p01;
+	p00 -= k0 * p00;
+}
+
+Kalman_Robot_Tracker::Kalman_Robot_Tracker(const Filter_Parameters& parameters) {
+	// 1 m/s^2 = 0.001 mm/ms^2, 1 rad/s^2 = 0.000001 rad/ms^2
+	const double acceleration = parameters.kalman_acceleration * 0.001;
+	const double angular_acceleration = parameters.kalman_angular_acceleration * 0.000001;
+	q_position = acceleration * acceleration;
+	q_rotation = angular_acceleration * angular_acceleration;
+	r_position = parameters.kalman_position_noise * parameters.kalman_position_noise;
+	r_rotation = parameters.kalman_rotation_noise * parameters.kalman_rotation_noise;
+	reseed_distance = parameters.reseed_distance;
+	reseed_ms = parameters.reseed_ms;
+
+	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
+		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
+			Track& track = tracks[team][id];
+			track.valid = false;
+			track.unseen_ms = 0.;
+			track.x.reset(0., 0., 0.);
+			track.y.reset(0., 0., 0.);
+			track.rotation.reset(0., 0., 0.);
+		}
+	}
+}
+
+void Kalman_Robot_Tracker::start(Track& track, const Robot_Percept& percept) {
+	track.valid = true;
+	track.unseen_ms = 0.;
+	track.x.reset(percept.x, r_position, START_SPEED_VARIANCE);
+	track.y.reset(percept.y, r_position, START_SPEED_VARIANCE);
+	track.rotation.reset(percept.rotation_known ? percept.rotation : 0., percept.rotation_known ? r_rotation
+			: BSmart::pi * BSmart::pi, START_TURN_VARIANCE);
+}
+
+void Kalman_Robot_Tracker::predict(double ms) {
+	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
+		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
+			Track& track = tracks[team][id];
+			if (!track.valid)
+				continue;
+			track.unseen_ms += ms;
+			track.x.predict(ms, q_position);
+			track.y.predict(ms, q_position);
+			track.rotation.predict(ms, q_rotation);
+			track.rotation.pos = BSmart::normalize(track.rotation.pos);
+		}
+	}
+}
+
+bool Kalman_Robot_Tracker::update(int team, int id, const Robot_Percept& percept) {
+	Track& track = tracks[team][id];
+	if (!track.valid || track.unseen_ms > reseed_ms) {
+		start(track, percept);
+		return false;
+	}
+	const double dx = percept.x - track.x.pos;
+	const double dy = percept.y - track.y.pos;
+	if (dx * dx + dy * dy > reseed_distance * reseed_distance) {
+		start(track, percept);
+		return false;
+	}
+
+	track.unseen_ms = 0.;
+	track.x.update(dx, r_position);
+	track.y.update(dy, r_position);
+	if (percept.rotation_known) {
+		track.rotation.update(BSmart::normalize(percept.rotation - track.rotation.pos), r_rotation);
+		track.rotation.pos = BSmart::normalize(track.rotation.pos);
+	}
+	return true;
+}
+
+bool Kalman_Robot_Tracker::valid(int team, int id) const {
+	return tracks[team][id].valid;
+}
+
+Robot_Sample Kalman_Robot_Tracker::model(int team, int id) const {
+	const Track& track = tracks[team][id];
+	Robot_Sample robot(BSmart::Pose(track.x.pos, track.y.pos, track.rotation.pos), BSmart::Pose(track.x.vel,
+			track.y.vel, track.rotation.vel));
+	robot.team = team;
+	robot.id = id;
+	robot.weighting = 1.;
+	return robot;
+}
@@ -0,0 +1,69 @@
+#ifndef KALMAN_ROBOT_TRACKER_H
+#define KALMAN_ROBOT_TRACKER_H
+
+#include "filter_data.h"
+#include "filter_parameters.h"
+#include "percept.h"
+
+/**
+ * @class Kalman_Robot_Tracker
+ * @brief Constant velocity Kalman filter for every robot, used instead of
+ * the robot particles with filter_robot_tracker = kalman.
+ * x, y and the rotation are independent filters over position and
+ * velocity, the rotation innovation is normalized to [-pi, pi], which is
+ * the extended filter for the angle. A track starts at the first percept
+ * and again after reseed_ms without percepts or a percept further away
+ * than reseed_distance (robot taken off or placed).
+ * Positions in mm and rad, velocities in mm/ms and rad/ms like
+ * Robot_Sample::speed.
+ */
+class Kalman_Robot_Tracker
+{
+public:
+    explicit Kalman_Robot_Tracker(const Filter_Parameters&);
+
+    //every track by ms
+    void predict(double ms);
+    //true if the percept was used for the running track
+    bool update(int team, int id, const Robot_Percept&);
+    //false if the robot has no track yet
+    bool valid(int team, int id) const;
+    //position, speed, team and id of the estimate
+    Robot_Sample model(int team, int id) const;
+
+private:
+    // position and velocity along one axis with their covariance
+    struct Axis {
+        double pos;
+        double vel;
+        double p00, p01, p11;
+
+        void reset(double pos_, double pos_var, double vel_var);
+        // q: variance of the acceleration
+        void predict(double dt, double q);
+        // innovation: measured - predicted position, r: its variance
+        void update(double innovation, double r);
+    };
+
+    struct Track {
+        bool valid;
+        double unseen_ms;
+        Axis x;
+        Axis y;
+        Axis rotation;
+    };
+
+    void start(Track&, const Robot_Percept&);
+
+    Track tracks[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+
+    // converted to mm/ms^2 and rad/ms^2, as variances
+    double q_position;
+    double q_rotation;
+    double r_position;
+    double r_rotation;
+    double reseed_distance;
+    double reseed_ms;
+};
+
+#endif //KALMAN_ROBOT_TRACKER_H
@@ -0,0 +1,89 @@
+#include "latency_histogram.h"
+#include "async_log.h"
+
+Latency_Histogram Metrics::vision_receive("ssl_refbox_vision_receive_seconds",
+		"Vision frame received until handed to the particle filter");
+Latency_Histogram Metrics::filter_queue_wait("ssl_refbox_filter_queue_wait_seconds",
+		"Frame handed to the particle filter until its cycle starts");
+Latency_Histogram Metrics::filter_motion_update("ssl_refbox_filter_motion_update_seconds",
+		"Particle filter motion update");
+Latency_Histogram Metrics::filter_sensor_update("ssl_refbox_filter_sensor_update_seconds",
+		"Particle filter sensor update");
+Latency_Histogram Metrics::filter_resample("ssl_refbox_filter_resample_seconds", "Particle filter resampling");
+Latency_Histogram Metrics::filter_create_models("ssl_refbox_filter_create_models_seconds",
+		"Particle filter model creation and ball status");
+Latency_Histogram Metrics::rule_evaluation("ssl_refbox_rule_evaluation_seconds", "One cycle of the rules thread");
+Latency_Histogram Metrics::repaint("ssl_refbox_repaint_seconds", "Drawing of the game area");
+Latency_Histogram Metrics::end_to_end("ssl_refbox_end_to_end_seconds",
+		"Vision frame received until the rules are evaluated on it");
+
+volatile int Metrics::filter_quality = 0;
+
+void Metrics::write(std::ostream& out) {
+	vision_receive.write(out);
+	filter_queue_wait.write(out);
+	filter_motion_update.write(out);
+	filter_sensor_update.write(out);
+	filter_resample.write(out);
+	filter_create_models.write(out);
+	rule_evaluation.write(out);
+	repaint.write(out);
+	end_to_end.write(out);
+	out << "# HELP ssl_refbox_filter_quality_level Degradation level of the filter under load, 0: full quality\n";
+	out << "# TYPE ssl_refbox_filter_quality_level gauge\n";
+	out << "ssl_refbox_filter_quality_level " << filter_quality << "\n";
+	Health_Counter::write_all(out);
+}
+
+Latency_Histogram::Latency_Histogram(const char* name_, const char* help_) :
+	name(name_), help(help_) {
+	for (int i = 0; i < BUCKETS; ++i)
+		counts[i] = 0;
+	sum = 0;
+}
+
+/**
+ * 0..3 us have a bucket each, above that the two bits after the highest
+ * set bit select one of four buckets of the power of two
+ */
+int Latency_Histogram::bucket(long long usec) {
+	if (usec < SUB_BUCKETS)
+		return usec < 0 ? 0 : (int) usec;
+	int magnitude = 63 - __builtin_clzll((unsigned long long) usec);
+	int index = (magnitude - 1) * SUB_BUCKETS + (int) ((usec >> (magnitude - 2)) & (SUB_BUCKETS - 1));
+	return index < BUCKETS ? index : BUCKETS - 1;
+}
+
+long long Latency_Histogram::upper_bound(int bucket) {
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+	int magnitude = bucket / SUB_BUCKETS + 1;
+	int sub = bucket % SUB_BUCKETS;
+	return ((long long) (SUB_BUCKETS + sub + 1) << (magnitude - 2)) - 1;
+}
+
+void Latency_Histogram::record(long long usec) {
+	__sync_fetch_and_add(&counts[bucket(usec)], 1LL);
+	__sync_fetch_and_add(&sum, usec < 0 ? 0 : usec);
+}
+
+/**
+ * Counts of concurrent records may be missing from some lines, the count is
+ * the sum of the buckets read, so +Inf and _count always agree.
+ * le is inclusive, so every line is labelled with the last duration of its
+ * bucket (2^n - 1 us), a record of 2^n us is already in the next bucket.
+ */
+void Latency_Histogram::write(std::ostream& out) const {
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " histogram\n";
+	long long cumulative = 0;
+	for (int i = 0; i < BUCKETS - 1; ++i) {
+		cumulative += counts[i];
+		if ((i + 1) % SUB_BUCKETS == 0)
+			out << name << "_bucket{le=\"" << upper_bound(i) / 1e6 << "\"} " << cumulative << "\n";
+	}
+	cumulative += counts[BUCKETS - 1];
+	out << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+	out << name << "_sum " << sum / 1e6 << "\n";
+	out << name << "_count " << cumulative << "\n";
+}
@@ -0,0 +1,62 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <string>
+#include <ostream>
+
+/**
+ * @class Latency_Histogram
+ * @brief Histogram of durations in microseconds with four buckets per power
+ * of two (about 20% resolution) up to 2^26 us. Recording is a few atomic
+ * adds, any thread may record and read at any time without locks.
+ */
+class Latency_Histogram
+{
+public:
+    Latency_Histogram(const char* name, const char* help);
+
+    void record(long long usec);
+
+    //Prometheus text format in seconds, one bucket line per power of two,
+    //labelled with the last duration below it
+    void write(std::ostream&) const;
+
+private:
+    enum {
+        SUB_BUCKETS = 4,
+        BUCKETS = 100 // last bucket: 7 * 2^23 us (about 59 s) and more
+    };
+
+    static int bucket(long long usec);
+    //last duration of the bucket, bucket(upper_bound(b)) == b
+    static long long upper_bound(int bucket);
+
+    const char* name;
+    const char* help;
+    long long counts[BUCKETS];
+    long long sum;
+};
+
+/**
+ * @brief The stages of the pipeline, shared by all pipelines of the process
+ */
+struct Metrics {
+    //vision: frame received until it is handed to the filter
+    static Latency_Histogram vision_receive;
+    //handed to the filter until the filter cycle starts
+    static Latency_Histogram filter_queue_wait;
+    static Latency_Histogram filter_motion_update;
+    static Latency_Histogram filter_sensor_update;
+    static Latency_Histogram filter_resample;
+    static Latency_Histogram filter_create_models;
+    static Latency_Histogram rule_evaluation;
+    static Latency_Histogram repaint;
+    //frame received until the rules are done with it
+    static Latency_Histogram end_to_end;
+    //Particle_Filter::Quality of the filter cycles
+    static volatile int filter_quality;
+
+    static void write(std::ostream&);
+};
+
+#endif //LATENCY_HISTOGRAM_H
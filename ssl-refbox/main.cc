@@ -18,6 +18,7 @@
  * @brief This file includes the main() function that is the entrance to the application
  */
 #include <QApplication>
+#include <QCoreApplication>
 #include <QMainWindow>
 #include <GL/glut.h>
 #include "ui_GuiControls.h"
@@ -36,6 +37,14 @@
 #include <log4cxx/rollingfileappender.h>
 
 #include "global.h"
+#include "ssl_refbox_rules.h"
+#include "regression_runner.h"
+#include "parameter_sweep.h"
+#include "micro_benchmark.h"
+#include "metrics_server.h"
+#include "headless.h"
+#include "trace.h"
+#include "async_log.h"
 
 using namespace log4cxx;
 using namespace log4cxx::helpers;
@@ -53,6 +62,17 @@ bool fexists(string filename) {
 	return ifile;
 }
 
+/**
+ * @brief Stop the writer threads of the trace and of the log
+ * @param res exit code of main
+ * @return res
+ */
+static int finish(int res) {
+	Trace::stop();
+	Async_Log::stop();
+	return res;
+}
+
 /**
  * @brief This is the main function of the application from where all start :)
  *
@@ -71,6 +91,11 @@ int main(int argc, char* argv[]) {
 	// you might want to look in guiactions.cc
 	// from there, actions start ;)
 
+	// --headless writes its decisions to stdout, the log goes to stderr
+	bool headless = false;
+	for (int i = 1; i < argc; i++)
+		headless = headless || strcmp(argv[i], "--headless") == 0;
+
 	// If the log4cxx config exist, load it, else create a default config
 	if (fexists("log4j.conf")) {
 		PropertyConfigurator::configure("log4j.conf");
@@ -91,7 +116,8 @@ int main(int argc, char* argv[]) {
 		// will be sent to the logfile and to the std output
 		RollingFileAppender * fileAppender = new RollingFileAppender(layout, logfile, true);
 		fileAppender->fileLength = 500000; // size_t equal to num in malloc etc. => byte
-		ConsoleAppender * consoleAppender = new ConsoleAppender(layout);
+		ConsoleAppender * consoleAppender = new ConsoleAppender(layout,
+				headless ? ConsoleAppender::getSystemErr() : ConsoleAppender::getSystemOut());
 
 		// From log4cxx doc:
 		// Sets and opens the file where the log output will go
@@ -108,13 +134,41 @@ int main(int argc, char* argv[]) {
 
 	// handle arguments
 	string custConfig = "";
-	Global::logFile = NULL;
+	string replayFile = "";
+	string regressDir = "";
+	string compareDir = "";
+	string sweepFile = "";
+	string benchFile = "";
+	string benchFilter = "";
+	int jobs = 0;
+	bool updateBaseline = false;
+	QString logFile = "";
 	for (int i = 1; i < argc; i++) {
 		if(strcmp(argv[i],"--help") == 0 || strcmp(argv[i],"-h") == 0) {
 			printf("Following options are available:\n");
 			printf("%-20s %s\n", "-h (--help)","Print this help");
 			printf("%-20s %s\n", "-c configfile","Use given config file");
 			printf("%-20s %s\n", "logfile","Immediately start given log file");
+			printf("%-20s %s\n", "--replay-rules file","Run only the rules on a recorded tracked state file (no GUI),");
+			printf("%-20s %s\n", "","print the broken rules and exit");
+			printf("%-20s %s\n", "--regress dir","Replay all log files (*.log) of dir through vision, particle filter");
+			printf("%-20s %s\n", "","and rules, all tracked state files through the rules (no GUI),");
+			printf("%-20s %s\n", "","write <file>.report and compare it with <file>.baseline, exit code 1");
+			printf("%-20s %s\n", "","on differences");
+			printf("%-20s %s\n", "--compare-engines dir","Replay the files of dir like --regress with the prolog and the native");
+			printf("%-20s %s\n", "","rules (rule_engine=compare), exit code 1 if they differ in any check");
+			printf("%-20s %s\n", "--sweep file","Run the particle filter with every sweep_* parameter set on a");
+			printf("%-20s %s\n", "","recorded percept file (no GUI) and print the scores");
+			printf("%-20s %s\n", "-j jobs","Files or parameter sets run at the same time by --regress, --sweep and");
+			printf("%-20s %s\n", "","--compare-engines (default: cores)");
+			printf("%-20s %s\n", "--bench file","Time the particle filter kernels (no GUI), compare them with the");
+			printf("%-20s %s\n", "","local baseline file of an earlier run on this machine (written if it");
+			printf("%-20s %s\n", "","does not exist), exit code 1 if slower");
+			printf("%-20s %s\n", "--bench-filter name","Only the --bench kernels containing name");
+			printf("%-20s %s\n", "--update-baseline","Write <file>.baseline with --regress, the baseline file with --bench");
+			printf("%-20s %s\n", "--headless","Run on live vision or the given log file without GUI and display,");
+			printf("%-20s %s\n", "","print the broken rules and ball status changes like --replay-rules,");
+			printf("%-20s %s\n", "","metrics on metrics_port; ends with the log file or SIGINT/SIGTERM");
 			exit(0);
 		} else if(strcmp(argv[i], "-c") == 0) {
 			if(i + 1>=argc) {
@@ -123,29 +177,157 @@ int main(int argc, char* argv[]) {
 			}
 			custConfig = argv[i+1];
 			i++;
+		} else if(strcmp(argv[i], "--replay-rules") == 0) {
+			if(i + 1>=argc) {
+				fprintf(stderr,"Missing parameter for option --replay-rules\n");
+				exit(1);
+			}
+			replayFile = argv[i+1];
+			i++;
+		} else if(strcmp(argv[i], "--regress") == 0) {
+			if(i + 1>=argc) {
+				fprintf(stderr,"Missing parameter for option --regress\n");
+				exit(1);
+			}
+			regressDir = argv[i+1];
+			i++;
+		} else if(strcmp(argv[i], "--compare-engines") == 0) {
+			if(i + 1>=argc) {
+				fprintf(stderr,"Missing parameter for option --compare-engines\n");
+				exit(1);
+			}
+			compareDir = argv[i+1];
+			i++;
+		} else if(strcmp(argv[i], "--sweep") == 0) {
+			if(i + 1>=argc) {
+				fprintf(stderr,"Missing parameter for option --sweep\n");
+				exit(1);
+			}
+			sweepFile = argv[i+1];
+			i++;
+		} else if(strcmp(argv[i], "--bench") == 0) {
+			if(i + 1>=argc) {
+				fprintf(stderr,"Missing parameter for option --bench\n");
+				exit(1);
+			}
+			benchFile = argv[i+1];
+			i++;
+		} else if(strcmp(argv[i], "--bench-filter") == 0) {
+			if(i + 1>=argc) {
+				fprintf(stderr,"Missing parameter for option --bench-filter\n");
+				exit(1);
+			}
+			benchFilter = argv[i+1];
+			i++;
+		} else if(strcmp(argv[i], "-j") == 0) {
+			if(i + 1>=argc) {
+				fprintf(stderr,"Missing parameter for option -j\n");
+				exit(1);
+			}
+			jobs = atoi(argv[i+1]);
+			i++;
+		} else if(strcmp(argv[i], "--update-baseline") == 0) {
+			updateBaseline = true;
+		} else if(strcmp(argv[i], "--headless") == 0) {
+			headless = true;
 		} else {
 			// load log file
-			Global::logFile = argv[i];
-//			logFile = argv[i];
-//			Global::setLogFile(argv[i]);
+			logFile = argv[i];
 		}
 	}
 
 	LOG4CXX_INFO(logger, "");
 	LOG4CXX_INFO(logger, "Entering application.");
 
-	// load the config file. Settings are stored publicly
-	Global::loadConfig(custConfig);
+	// messages of the filter, rules and vision loops
+	Async_Log::start();
+
+	// load the config file, every pipeline gets a copy
+	ConfigFile config;
+	Global::loadConfig(custConfig, config);
+
+	// kernels of the particle filter, against the local baseline of this machine
+	if (!benchFile.empty()) {
+		Micro_Benchmark bench(benchFile);
+		bench.set_update_baseline(updateBaseline);
+		bench.set_filter(benchFilter);
+		bool ok = bench.run(std::cout);
+		std::cout.flush();
+		return finish(ok ? 0 : 1);
+	}
+
+	// particle filter only, on recorded percepts
+	if (!sweepFile.empty()) {
+		Parameter_Sweep sweep(config, sweepFile, jobs);
+		bool ok = sweep.run(std::cout);
+		std::cout.flush();
+		return finish(ok ? 0 : 1);
+	}
 
-	// external variable in ssl_refbox_rules.h for initializing prolog
-	argv_global = argv[0];
+	// prolog for the rules of all pipelines
+	if (!SSL_Refbox_Rules::init_prolog(argv[0]))
+		return finish(1);
+
+	// rules only, without vision, particle filter and GUI
+	if (!replayFile.empty()) {
+		Filter_Data filter_data(config.read<int>("robot_ids", Filter_Data::NUMBER_OF_IDS));
+		BSmart::Game_States gamestate;
+		SSL_Refbox_Rules rules(NULL, &filter_data, &gamestate, config);
+		if (!rules.set_replay(replayFile, &std::cout))
+			return finish(1);
+		rules.run();
+		std::cout.flush();
+		return finish(0);
+	}
+
+	// rules on a directory of recorded files, several at the same time
+	if (!regressDir.empty()) {
+		Regression_Runner runner(config, regressDir, jobs);
+		runner.set_update_baseline(updateBaseline);
+		bool passed = runner.run(std::cout);
+		std::cout.flush();
+		return finish(passed ? 0 : 1);
+	}
+
+	// prolog against the native rules on a directory of recorded files
+	if (!compareDir.empty()) {
+		Regression_Runner runner(config, compareDir, jobs);
+		runner.set_compare_engines(true);
+		bool passed = runner.run(std::cout);
+		std::cout.flush();
+		return finish(passed ? 0 : 1);
+	}
+
+	// latency metrics of the pipeline
+	int metricsPort = config.read<int>("metrics_port", 0);
+	if (metricsPort > 0) {
+		Metrics_Server* metrics = new Metrics_Server(metricsPort);
+		if (metrics->listen())
+			metrics->start();
+	}
+
+	// timeline of the pipeline threads
+	std::string traceFile = config.read<std::string>("trace_file", "");
+	if (!traceFile.empty())
+		Trace::start(traceFile);
+
+	// whole pipeline without GUI, OpenGL and display
+	if (headless) {
+		QCoreApplication app(argc, argv);
+		Headless daemon(config, logFile);
+		int res = daemon.run(std::cout);
+		std::cout.flush();
+		LOG4CXX_INFO(logger, "Exit application");
+		return finish(res);
+	}
 
 	// initialize qt app and window
 	QApplication app(argc, argv);
 	QMainWindow* refbox = new QMainWindow;
 	Ui::GuiControls* gui = new Ui::GuiControls;
-	GuiActions act(gui, refbox);
+	GuiActions act(gui, config, refbox);
 	gui->setupUi(refbox);
+	gui->gamearea->start_pipeline(config, logFile);
 
 	// connect GUI components with actions
 	act.connectActions();
@@ -161,6 +343,6 @@ int main(int argc, char* argv[]) {
 
 	LOG4CXX_INFO(logger, "Exit application");
 
-	return res;
+	return finish(res);
 }
 
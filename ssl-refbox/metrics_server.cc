@@ -0,0 +1,104 @@
+#include "metrics_server.h"
+#include "latency_histogram.h"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sstream>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Metrics_Server::logger(Logger::getLogger("Metrics_Server"));
+
+Metrics_Server::Metrics_Server(int port_) :
+	port(port_) {
+	sock = -1;
+}
+
+Metrics_Server::~Metrics_Server() {
+	if (sock >= 0)
+		close(sock);
+}
+
+bool Metrics_Server::listen() {
+	sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (sock < 0) {
+		LOG4CXX_ERROR( logger, std::string("socket: ") + strerror(errno));
+		return false;
+	}
+	int on = 1;
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	// local only, the metrics are not meant for the field network
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+	if (bind(sock, (sockaddr*) &address, sizeof(address)) != 0 || ::listen(sock, 4) != 0) {
+		std::ostringstream o;
+		o << "Could not listen on 127.0.0.1:" << port << ": " << strerror(errno);
+		LOG4CXX_ERROR( logger, o.str());
+		close(sock);
+		sock = -1;
+		return false;
+	}
+	std::ostringstream o;
+	o << "Serving metrics on http://127.0.0.1:" << port << "/metrics";
+	LOG4CXX_INFO( logger, o.str());
+	return true;
+}
+
+void Metrics_Server::run() {
+	for (;;) {
+		int connection = accept(sock, 0, 0);
+		if (connection < 0) {
+			if (errno == EINTR)
+				continue;
+			LOG4CXX_ERROR( logger, std::string("accept: ") + strerror(errno));
+			return;
+		}
+		answer(connection);
+		close(connection);
+	}
+}
+
+void Metrics_Server::answer(int connection) {
+	// requests are answered one after another, a client which sends or reads
+	// nothing must not block the server
+	timeval timeout;
+	timeout.tv_sec = 1;
+	timeout.tv_usec = 0;
+	setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	// the request line is enough, the headers are ignored
+	char request[1024];
+	ssize_t length = recv(connection, request, sizeof(request) - 1, 0);
+	if (length <= 0)
+		return;
+	request[length] = 0;
+
+	std::ostringstream response;
+	if (strncmp(request, "GET /metrics", 12) == 0 || strncmp(request, "GET / ", 6) == 0) {
+		std::ostringstream body;
+		Metrics::write(body);
+		response << "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+				<< body.str().size() << "\r\n\r\n" << body.str();
+	} else {
+		response << "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+	}
+	std::string data = response.str();
+	const char* p = data.data();
+	size_t left = data.size();
+	while (left > 0) {
+		ssize_t written = send(connection, p, left, MSG_NOSIGNAL);
+		if (written <= 0)
+			return;
+		p += written;
+		left -= written;
+	}
+}
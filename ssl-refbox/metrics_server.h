@@ -0,0 +1,32 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <QThread>
+#include <log4cxx/logger.h>
+
+/**
+ * @class Metrics_Server
+ * @brief Serves the latency histograms (see latency_histogram.h) in the
+ * Prometheus text format on http://127.0.0.1:<port>/metrics, one request
+ * at a time.
+ */
+class Metrics_Server : public QThread
+{
+public:
+    Metrics_Server(int port);
+    ~Metrics_Server();
+
+    //false if the port could not be opened
+    bool listen();
+    void run();
+
+private:
+    static log4cxx::LoggerPtr logger;
+
+    void answer(int connection);
+
+    int port;
+    int sock;
+};
+
+#endif //METRICS_SERVER_H
@@ -0,0 +1,413 @@
+#include "micro_benchmark.h"
+#include "particle_filter.h"
+#include "sample.h"
+#include <libbsmart/math.h>
+#include <libbsmart/field.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <time.h>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Micro_Benchmark::logger(Logger::getLogger("Micro_Benchmark"));
+
+const double Micro_Benchmark::TOLERANCE = 0.25;
+Filter_Parameters Micro_Benchmark::parameters;
+
+// the kernels cycle through this many inputs, a power of two
+static const long DATA = 1024;
+// keeps the results of the kernels alive
+static volatile double sink;
+// noise of the sample kernels, seeded with SEED like rand() in measure
+static Filter_Random random_generator;
+
+static double random_double(double min, double max) {
+	return min + (max - min) * rand() / (double) RAND_MAX;
+}
+
+static BSmart::Double_Vector random_point() {
+	return BSmart::Double_Vector(random_double(-BSmart::Field::half_field_width, BSmart::Field::half_field_width),
+			random_double(-BSmart::Field::half_field_height, BSmart::Field::half_field_height));
+}
+
+static std::vector<BSmart::Line> random_lines() {
+	std::vector<BSmart::Line> lines;
+	for (long i = 0; i < DATA; ++i) {
+		BSmart::Double_Vector p1 = random_point();
+		// about the way of a fast ball in one frame
+		BSmart::Double_Vector p2(p1.x + random_double(-200., 200.), p1.y + random_double(-200., 200.));
+		lines.push_back(BSmart::Line(p1, p2));
+	}
+	return lines;
+}
+
+static std::vector<BSmart::Circle> random_circles() {
+	std::vector<BSmart::Circle> circles;
+	for (long i = 0; i < DATA; ++i)
+		circles.push_back(BSmart::Circle(random_point(), 90.));
+	return circles;
+}
+
+static Ball_Sample_List random_balls() {
+	Ball_Sample_List balls;
+	for (long i = 0; i < DATA; ++i) {
+		BSmart::Double_Vector p = random_point();
+		// every fourth ball is in the air
+		bool chipped = i % 4 == 0;
+		BSmart::Pose3D speed(random_double(-6., 6.), random_double(-6., 6.), chipped ? random_double(1., 4.) : 0.);
+		balls.push_back(Ball_Sample(BSmart::Pose3D(p.x, p.y, chipped ? 100. : 0.), speed,
+				chipped ? Sample::FLYING : Sample::ROLLING, Sample::TOUCH_UNKNOWN));
+	}
+	return balls;
+}
+
+static Robot_Sample_List random_robots(long count) {
+	Robot_Sample_List robots;
+	for (long i = 0; i < count; ++i) {
+		BSmart::Double_Vector p = random_point();
+		Robot_Sample robot(BSmart::Pose(p.x, p.y, random_double(-BSmart::pi, BSmart::pi)),
+				BSmart::Pose(random_double(-2., 2.), random_double(-2., 2.)));
+		robot.team = i % 2;
+		robot.id = i / 2;
+		robot.confidence = 1.;
+		robots.push_back(robot);
+	}
+	return robots;
+}
+
+/**
+ * A filter with one ball percept and six robots per team, the weights and
+ * current percepts are those of one sensor update
+ */
+struct Filter_Bench {
+	Pre_Filter_Data pf_data;
+	Filter_Data filter_data;
+	Particle_Filter pf;
+	Ball_Percept percept;
+
+	Filter_Bench(const Filter_Parameters& parameters) :
+		pf(&pf_data, &filter_data, parameters, Micro_Benchmark::SEED) {
+		srand(Micro_Benchmark::SEED);
+		percept.x = 1000.;
+		percept.y = 500.;
+		percept.cam = 0;
+		percept.confidence = 1;
+		pf_data.set_balls(0, Ball_Percept_List(1, percept));
+		for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
+			for (int id = 0; id < 6; ++id) {
+				Robot_Percept robot(-2000. + id * 800., team == 0 ? -1000. : 1000., 0.);
+				robot.id = id;
+				robot.cam = 0;
+				robot.confidence = 1;
+				robot.rotation_known = true;
+				robot.color = team == 1 ? SSLRefbox::Colors::BLUE : SSLRefbox::Colors::YELLOW;
+				pf_data.set_robots(0, team, id, Robot_Percept_List(1, robot));
+			}
+		}
+		pf.motion_update(16.);
+		pf.sensor_update();
+	}
+};
+
+static Filter_Bench& filter_bench(const Filter_Parameters& parameters) {
+	static Filter_Bench bench(parameters);
+	return bench;
+}
+
+double Micro_Benchmark::line_intersection(long iterations) {
+	static std::vector<BSmart::Line> lines = random_lines();
+	double hits = 0.;
+	for (long i = 0; i < iterations; ++i)
+		hits += BSmart::test_intersection(lines[i & (DATA - 1)], lines[(i * 7 + 1) & (DATA - 1)]);
+	return hits;
+}
+
+double Micro_Benchmark::line_intersection_point(long iterations) {
+	static std::vector<BSmart::Line> lines = random_lines();
+	BSmart::Double_Vector point;
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		if (BSmart::intersection_point(lines[i & (DATA - 1)], lines[(i * 7 + 1) & (DATA - 1)], &point))
+			sum += point.x;
+	}
+	return sum;
+}
+
+double Micro_Benchmark::circle_intersection(long iterations) {
+	static std::vector<BSmart::Line> lines = random_lines();
+	static std::vector<BSmart::Circle> circles = random_circles();
+	double hits = 0.;
+	for (long i = 0; i < iterations; ++i)
+		hits += BSmart::test_intersection(circles[i & (DATA - 1)], lines[(i * 7 + 1) & (DATA - 1)]);
+	return hits;
+}
+
+double Micro_Benchmark::circle_intersection_point(long iterations) {
+	static std::vector<BSmart::Line> lines = random_lines();
+	static std::vector<BSmart::Circle> circles = random_circles();
+	std::vector<BSmart::Double_Vector> intersections;
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		intersections.clear();
+		if (BSmart::intersection_point(circles[i & (DATA - 1)], lines[(i * 7 + 1) & (DATA - 1)], intersections))
+			sum += intersections[0].x;
+	}
+	return sum;
+}
+
+//one segment against twelve robots close by, as in Ball_Sample::check_robot_reflections
+double Micro_Benchmark::circle_batch_intersection(long iterations) {
+	static std::vector<BSmart::Line> lines = random_lines();
+	static std::vector<BSmart::Circle> circles = random_circles();
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		const BSmart::Line& line = lines[i & (DATA - 1)];
+		BSmart::Circle_Batch batch;
+		for (long k = 0; k < 12; ++k) {
+			const BSmart::Circle& c = circles[(i * 12 + k) & (DATA - 1)];
+			batch.add(line.p1.x + c.x * 0.1, line.p1.y + c.y * 0.1, c.radius);
+		}
+		double fraction = 0.;
+		sum += BSmart::first_crossing(BSmart::intersection_points(line, batch), &fraction) + fraction;
+	}
+	return sum;
+}
+
+double Micro_Benchmark::pose_distance(long iterations) {
+	static std::vector<BSmart::Line> lines = random_lines();
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		const BSmart::Line& line = lines[i & (DATA - 1)];
+		BSmart::Pose pose(line.p1.x, line.p1.y, 0.);
+		sum += pose.distance_to(line.p2);
+	}
+	return sum;
+}
+
+double Micro_Benchmark::pose3d_distance_2d(long iterations) {
+	static Ball_Sample_List balls = random_balls();
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i)
+		sum += balls[i & (DATA - 1)].pos.distance_to_2D(balls[(i * 7 + 1) & (DATA - 1)].pos);
+	return sum;
+}
+
+double Micro_Benchmark::normalize_angle(long iterations) {
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		BSmart::Pose pose(0., 0., (i & (DATA - 1)) * 0.05 - 25.);
+		pose.normalize_rotation();
+		sum += pose.rotation + BSmart::normalize((i & (DATA - 1)) * 0.03);
+	}
+	return sum;
+}
+
+double Micro_Benchmark::polarbaer(long iterations) {
+	Sample sample;
+	BSmart::Double_Vector noise;
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		sample.fuettere_polarbaer(&noise, random_generator);
+		sum += noise.x;
+	}
+	return sum;
+}
+
+double Micro_Benchmark::ball_move_free(long iterations) {
+	static Ball_Sample_List balls = random_balls();
+	static Robot_Sample_List no_robots;
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		Ball_Sample ball(balls[i & (DATA - 1)]);
+		ball.move(16., no_robots, parameters, random_generator);
+		sum += ball.pos.x;
+	}
+	return sum;
+}
+
+double Micro_Benchmark::ball_move_robots(long iterations) {
+	static Ball_Sample_List balls = random_balls();
+	static Robot_Sample_List robots = random_robots(12);
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		Ball_Sample ball(balls[i & (DATA - 1)]);
+		ball.move(16., robots, parameters, random_generator);
+		sum += ball.pos.x;
+	}
+	return sum;
+}
+
+double Micro_Benchmark::robot_move(long iterations) {
+	static Robot_Sample_List robots = random_robots(DATA);
+	static Robot_Sample_List obstacles = random_robots(12);
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		Robot_Sample robot(robots[i & (DATA - 1)]);
+		robot.move(16., obstacles, parameters, random_generator);
+		sum += robot.pos.x;
+	}
+	return sum;
+}
+
+//one cycle of the Kalman filter for 12 robots, against 12 * ROBOT_SAMPLES robot_move
+double Micro_Benchmark::robot_kalman(long iterations) {
+	static Robot_Sample_List robots = random_robots(DATA);
+	static Kalman_Robot_Tracker tracker(parameters);
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i) {
+		tracker.predict(16.);
+		for (int r = 0; r < 12; ++r) {
+			const Robot_Sample& robot = robots[(i * 12 + r) & (DATA - 1)];
+			Robot_Percept percept(robot.pos.x, robot.pos.y, robot.pos.rotation);
+			percept.rotation_known = true;
+			tracker.update(r % 2, r / 2, percept);
+		}
+		sum += tracker.model(0, 0).pos.x;
+	}
+	return sum;
+}
+
+//all ball samples against one percept
+double Micro_Benchmark::weight_ball(long iterations) {
+	Filter_Bench& bench = filter_bench(parameters);
+	double sum = 0.;
+	for (long i = 0; i < iterations; ++i)
+		sum += bench.pf.weight_ball(bench.percept);
+	return sum;
+}
+
+//ball and all robots
+double Micro_Benchmark::resample(long iterations) {
+	Filter_Bench& bench = filter_bench(parameters);
+	for (long i = 0; i < iterations; ++i)
+		bench.pf.resample();
+	return bench.filter_data.get_ball_samples().size();
+}
+
+double Micro_Benchmark::time_ns(Kernel kernel, long iterations) {
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	sink = sink + kernel(iterations);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+Micro_Benchmark::Result Micro_Benchmark::measure(const char* name, Kernel kernel) {
+	srand(SEED);
+	random_generator.seed(SEED);
+	// creates the data of the kernel
+	kernel(1);
+
+	// iterations for REPEAT_MS, from a run of at least a tenth of that
+	long iterations = 1;
+	double ns;
+	while ((ns = time_ns(kernel, iterations)) < REPEAT_MS * 1e5 && iterations < (1L << 40))
+		iterations *= 2;
+	iterations = std::max(1L, (long) (iterations * (REPEAT_MS * 1e6 / std::max(ns, 1.))));
+
+	std::vector<double> times;
+	for (int i = 0; i < REPEATS; ++i) {
+		srand(SEED);
+		random_generator.seed(SEED);
+		times.push_back(time_ns(kernel, iterations) / iterations);
+	}
+	std::sort(times.begin(), times.end());
+
+	Result result;
+	result.name = name;
+	result.ns_per_call = times[REPEATS / 2];
+	return result;
+}
+
+Micro_Benchmark::Micro_Benchmark(const std::string& baseline_) :
+	baseline(baseline_) {
+	update_baseline = false;
+}
+
+bool Micro_Benchmark::run(std::ostream& out) {
+	struct {
+		const char* name;
+		Kernel kernel;
+	} kernels[] = { { "line_test_intersection", line_intersection }, { "line_intersection_point",
+			line_intersection_point }, { "circle_test_intersection", circle_intersection }, {
+			"circle_intersection_point", circle_intersection_point }, { "circle_batch_intersection",
+			circle_batch_intersection }, { "pose_distance_to", pose_distance }, {
+			"pose3d_distance_to_2D", pose3d_distance_2d }, { "normalize_rotation", normalize_angle }, {
+			"fuettere_polarbaer", polarbaer }, { "ball_move_free", ball_move_free }, { "ball_move_robots",
+			ball_move_robots }, { "robot_move", robot_move }, { "robot_kalman", robot_kalman }, { "pf_weight_ball", weight_ball }, {
+			"pf_resample", resample } };
+
+	std::vector<Result> results;
+	for (unsigned int i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i) {
+		if (filter.empty() || std::string(kernels[i].name).find(filter) != std::string::npos)
+			results.push_back(measure(kernels[i].name, kernels[i].kernel));
+	}
+
+	std::map<std::string, double> old;
+	bool compare = read_baseline(old) && !update_baseline;
+
+	// name, ns per call, baseline ns per call, speedup against the baseline
+	int slower = 0;
+	out << "#kernel\tns_per_call\tbaseline_ns\tspeedup" << std::endl;
+	for (unsigned int i = 0; i < results.size(); ++i) {
+		out << results[i].name << "\t" << std::fixed << std::setprecision(2) << results[i].ns_per_call;
+		std::map<std::string, double>::const_iterator it = old.find(results[i].name);
+		if (compare && it != old.end() && results[i].ns_per_call > 0.) {
+			double speedup = it->second / results[i].ns_per_call;
+			out << "\t" << it->second << "\t" << std::setprecision(3) << speedup;
+			if (speedup < 1. / (1. + TOLERANCE)) {
+				out << "\tslower";
+				++slower;
+			}
+		} else {
+			out << "\t-\t-";
+		}
+		out.unsetf(std::ios::floatfield);
+		out << std::endl;
+	}
+
+	if (!compare) {
+		// kernels left out by the filter keep their old values
+		for (unsigned int i = 0; i < results.size(); ++i)
+			old[results[i].name] = results[i].ns_per_call;
+		if (!write_baseline(old))
+			return false;
+		LOG4CXX_INFO( logger, "Baseline written to " + baseline);
+		return true;
+	}
+	out << "#" << results.size() << " kernels, " << slower << " slower than the baseline by more than "
+			<< TOLERANCE * 100 << "%" << std::endl;
+	return slower == 0;
+}
+
+bool Micro_Benchmark::read_baseline(std::map<std::string, double>& values) const {
+	std::ifstream in(baseline.c_str());
+	if (!in)
+		return false;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream fields(line);
+		std::string name;
+		double ns;
+		if (fields >> name >> ns)
+			values[name] = ns;
+	}
+	return true;
+}
+
+bool Micro_Benchmark::write_baseline(const std::map<std::string, double>& values) const {
+	std::ofstream out(baseline.c_str());
+	if (!out) {
+		LOG4CXX_ERROR( logger, "Could not write " + baseline);
+		return false;
+	}
+	out << "#kernel\tns_per_call" << std::endl;
+	for (std::map<std::string, double>::const_iterator it = values.begin(); it != values.end(); ++it)
+		out << it->first << "\t" << std::fixed << std::setprecision(2) << it->second << std::endl;
+	return true;
+}
@@ -0,0 +1,81 @@
+#ifndef MICRO_BENCHMARK_H
+#define MICRO_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include "filter_parameters.h"
+#include <log4cxx/logger.h>
+
+/**
+ * @class Micro_Benchmark
+ * @brief Times the hot kernels of the particle filter (libbsmart geometry,
+ * sample physics, weighting and resampling) on fixed data with fixed
+ * seeds. Every kernel is calibrated to about REPEAT_MS and timed REPEATS
+ * times, the median in ns per call is reported.
+ * The results are one tab separated line per kernel. They are compared
+ * with a baseline file of the same format, written with --update-baseline
+ * or when it does not exist yet. The numbers only compare runs on the same
+ * machine, so the baseline is a local file (make bench uses the git-ignored
+ * bin/micro_benchmark.baseline) and not part of the repository.
+ */
+class Micro_Benchmark
+{
+public:
+    enum {
+        REPEATS = 5,
+        REPEAT_MS = 100,
+        SEED = 42
+    };
+
+    //slower than the baseline by more than this fraction is a failure
+    static const double TOLERANCE;
+
+    explicit Micro_Benchmark(const std::string& baseline);
+    void set_update_baseline(bool update) { update_baseline = update; }
+    //only the kernels whose name contains filter
+    void set_filter(const std::string& filter_) { filter = filter_; }
+
+    //false if a kernel is slower than the baseline
+    bool run(std::ostream& results);
+
+private:
+    //runs the kernel iterations times, the result is only used against dead code elimination
+    typedef double (*Kernel)(long iterations);
+
+    struct Result {
+        std::string name;
+        double ns_per_call;
+    };
+
+    static double time_ns(Kernel, long iterations);
+    static Result measure(const char* name, Kernel);
+    bool read_baseline(std::map<std::string, double>&) const;
+    bool write_baseline(const std::map<std::string, double>&) const;
+
+    static double line_intersection(long);
+    static double line_intersection_point(long);
+    static double circle_intersection(long);
+    static double circle_intersection_point(long);
+    static double circle_batch_intersection(long);
+    static double pose_distance(long);
+    static double pose3d_distance_2d(long);
+    static double normalize_angle(long);
+    static double polarbaer(long);
+    static double ball_move_free(long);
+    static double ball_move_robots(long);
+    static double robot_move(long);
+    static double robot_kalman(long);
+    static double weight_ball(long);
+    static double resample(long);
+
+    static log4cxx::LoggerPtr logger;
+    static Filter_Parameters parameters;
+
+    std::string baseline;
+    std::string filter;
+    bool update_baseline;
+};
+
+#endif //MICRO_BENCHMARK_H
@@ -0,0 +1,494 @@
+#include "native_rules.h"
+#include "rule_constants.h"
+#include <cmath>
+#include <cstdlib>
+#include <libbsmart/field.h>
+#include <sstream>
+
+namespace {
+const int half_width = BSmart::Field::field_width / 2;
+const int half_height = BSmart::Field::field_height / 2;
+}
+
+Native_Rules::Native_Rules() {
+	world = 0;
+	memo = 0;
+	in = 0;
+	profiler = 0;
+}
+
+void Native_Rules::set_profiler(Rule_Profiler* profiler_) {
+	profiler = profiler_;
+}
+
+/**
+ * check_rules of the prolog rules, same order
+ */
+Native_Rule_Result Native_Rules::check_rules(const World_Snapshot& world_, Rule_Memo& memo_,
+		const Native_Rule_Input& in_) {
+	world = &world_;
+	memo = &memo_;
+	in = &in_;
+
+	out.rule = -42;
+	out.has_rule_breaker = false;
+	out.rule_breaker = BSmart::Int_Vector(-1, -1);
+	out.has_freekick_pos = false;
+	out.freekick_pos = BSmart::Int_Vector(-1, -1);
+	out.goal = -1;
+	out.next_play_state = -1;
+	out.local_play_state = -1;
+	out.local_next_play_state = -1;
+	out.reset_offside = false;
+
+	static const struct {
+		int rule;
+		bool (Native_Rules::*check)();
+	} rules[] = {
+			// rules which change the game state
+			{ 29, &Native_Rules::rule_twentynine }, { 30, &Native_Rules::rule_thirty },
+			{ 16, &Native_Rules::rule_sixteen }, { 15, &Native_Rules::rule_fifteen },
+			{ 14, &Native_Rules::rule_fourteen }, { 17, &Native_Rules::rule_seventeen },
+			{ 19, &Native_Rules::rule_nineteen },
+			// rules which only warn
+			{ 3, &Native_Rules::rule_three }, { 28, &Native_Rules::rule_twentyeight },
+			{ 27, &Native_Rules::rule_twentyseven }, { 18, &Native_Rules::rule_eighteen },
+			{ 22, &Native_Rules::rule_twentytwo }, { 1, &Native_Rules::rule_one },
+			{ 42, &Native_Rules::rule_fourtytwo } };
+
+	for (unsigned int i = 0; i < sizeof(rules) / sizeof(rules[0]); ++i) {
+		bool broken;
+		if (profiler) {
+			long long start = Rule_Profiler::now();
+			broken = (this->*rules[i].check)();
+			std::ostringstream name;
+			name << "native rule " << rules[i].rule;
+			profiler->add(name.str(), Rule_Profiler::now() - start, broken);
+		} else {
+			broken = (this->*rules[i].check)();
+		}
+		if (broken) {
+			out.rule = rules[i].rule;
+			break;
+		}
+	}
+
+	return out;
+}
+
+void Native_Rules::set_rule_breaker(int team, int id) {
+	out.has_rule_breaker = true;
+	out.rule_breaker = BSmart::Int_Vector(team, id);
+}
+
+void Native_Rules::set_freekick_pos(int x, int y) {
+	out.has_freekick_pos = true;
+	out.freekick_pos = BSmart::Int_Vector(x, y);
+}
+
+bool Native_Rules::freekick_yellow() {
+	int ps = in->local_play_state;
+	return ps == 3 || ps == 5 || ps == 6 || ps == 7;
+}
+
+bool Native_Rules::freekick_blue() {
+	int ps = in->local_play_state;
+	return ps == 9 || ps == 11 || ps == 12 || ps == 13;
+}
+
+/**
+ * Rule 1: only max_robots robots per team, the last one breaks the rule
+ */
+bool Native_Rules::rule_one() {
+	return rule_one(0) || rule_one(1);
+}
+
+bool Native_Rules::rule_one(int team) {
+	int number = 0;
+	int last_id = -1;
+	for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+		if (it->team == team) {
+			number++;
+			last_id = it->id;
+		}
+	}
+	if (number <= in->max_robots)
+		return false;
+	set_rule_breaker(team, last_id);
+	return true;
+}
+
+/**
+ * Rule 3: change of goalie, a robot is nearer to the own goal than the goalie
+ */
+bool Native_Rules::rule_three() {
+	int left = in->left_team;
+	if (left < 0)
+		return false;
+
+	double goalie_left, goalie_right, left_dist, right_dist;
+	if (in->left_goalie.x == left
+			&& memo->get_goal_distance(left, in->left_goalie.y, goalie_left, goalie_right)) {
+		for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+			if (it->team != left || it->id == in->left_goalie.y)
+				continue;
+			memo->get_goal_distance(it->team, it->id, left_dist, right_dist);
+			if (left_dist < goalie_left) {
+				set_rule_breaker(it->team, it->id);
+				return true;
+			}
+		}
+	}
+	int right = in->right_goalie.x;
+	if (right >= 0 && right != left && memo->get_goal_distance(right, in->right_goalie.y, goalie_left, goalie_right)) {
+		for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+			if (it->team != right || it->id == in->right_goalie.y)
+				continue;
+			memo->get_goal_distance(it->team, it->id, left_dist, right_dist);
+			if (right_dist < goalie_right) {
+				set_rule_breaker(it->team, it->id);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Rule 14: robots in the own half at kickoff
+ */
+bool Native_Rules::rule_fourteen() {
+	int ps = in->local_play_state;
+	if (!(ps == 3 || ps == 7 || ps == 9 || ps == 13) || in->left_team < 0)
+		return false;
+	for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+		int x = (int) it->pos.x;
+		if ((it->team == in->left_team && x > 0) || (it->team != in->left_team && x < 0)) {
+			set_rule_breaker(it->team, it->id);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Rule 15: distance to the ball and to the opponent defense area at free kicks
+ */
+bool Native_Rules::rule_fifteen() {
+	if (!freekick_blue() && !freekick_yellow())
+		return false;
+
+	double dist, left_dist, right_dist;
+	for (int team = 0; team < 2; ++team) {
+		if ((team == 0 && !freekick_blue()) || (team == 1 && !freekick_yellow()))
+			continue;
+		for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+			if (it->team != team)
+				continue;
+			memo->get_ball_distance(it->team, it->id, dist);
+			if (dist < Rule_Constants::FREE_KICK_OTHER_ROB) {
+				set_rule_breaker(it->team, it->id);
+				return true;
+			}
+		}
+	}
+
+	if (in->left_team < 0)
+		return false;
+	for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+		memo->get_def_area_distance(it->team, it->id, left_dist, right_dist);
+		dist = (it->team == in->left_team) ? right_dist : left_dist;
+		if (dist <= 200) {
+			set_rule_breaker(it->team, it->id);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Rule 16: distance to the ball in stopped
+ */
+bool Native_Rules::rule_sixteen() {
+	if (in->local_play_state != 1)
+		return false;
+	double dist;
+	for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+		memo->get_ball_distance(it->team, it->id, dist);
+		if (dist < 500) {
+			set_rule_breaker(it->team, it->id);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Rule 17: robot positions at penalty kicks
+ */
+bool Native_Rules::rule_seventeen() {
+	int ps = in->local_play_state;
+	int attacker;
+	if (ps == 10 || ps == 14)
+		attacker = 1;
+	else if (ps == 4 || ps == 8)
+		attacker = 0;
+	else
+		return false;
+	if (in->left_team != 0 && in->left_team != 1)
+		return false;
+	return rule_seventeen_penalty(attacker, (attacker == in->left_team) ? 1 : 0);
+}
+
+/**
+ * penalty_<attacker>_on_<side>_goal, side 0: left goal, 1: right goal.
+ * Like in the prolog rules, the other robot is always reported for team 1.
+ */
+bool Native_Rules::rule_seventeen_penalty(int attacker, int side) {
+	int defender = 1 - attacker;
+	int min_dist = BSmart::Field::penalty_mark_distance + Rule_Constants::PENALTY_KICK_OTHER_ROB
+			- BSmart::Field::field_width;
+	if (side == 1)
+		min_dist = -min_dist;
+	const BSmart::Int_Vector& goalie = (side == 0) ? in->left_goalie : in->right_goalie;
+	Robot_Sample_List::const_iterator it, other;
+
+	// defenders behind the line
+	if (goalie.x == defender) {
+		for (it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+			int x = (int) it->pos.x;
+			if (it->team == defender && it->id != goalie.y && (side == 0 ? x < min_dist : x > min_dist)) {
+				set_rule_breaker(defender, it->id);
+				return true;
+			}
+		}
+	}
+
+	// no kicker
+	bool kicker = false;
+	for (it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+		int x = (int) it->pos.x;
+		if (it->team == attacker && (side == 0 ? x < min_dist : x > min_dist))
+			kicker = true;
+	}
+	if (!kicker) {
+		set_rule_breaker(attacker, -1);
+		return true;
+	}
+
+	// more than one attacker, the one nearer to the goal is the kicker
+	for (it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+		int x_kicker = (int) it->pos.x;
+		if (it->team != attacker || !(side == 0 ? x_kicker < min_dist : x_kicker > min_dist))
+			continue;
+		for (other = world->robot_models.begin(); other != world->robot_models.end(); ++other) {
+			int x_other = (int) other->pos.x;
+			if (other->team != attacker || other->id == it->id
+					|| !(side == 0 ? x_other < min_dist : x_other > min_dist))
+				continue;
+			if (side == 0 ? x_kicker < x_other : x_kicker > x_other) {
+				set_rule_breaker(1, other->id);
+				return true;
+			}
+			if (side == 0 ? x_kicker > x_other : x_kicker < x_other) {
+				set_rule_breaker(attacker, it->id);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Rule 18: robot other than the goalie in the own defense area
+ */
+bool Native_Rules::rule_eighteen() {
+	if (in->local_play_state != 2)
+		return false;
+	double left_dist, right_dist;
+	for (int side = 0; side < 2; ++side) {
+		const BSmart::Int_Vector& goalie = (side == 0) ? in->left_goalie : in->right_goalie;
+		if (goalie.x < 0)
+			continue;
+		for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+			if (it->team != goalie.x || it->id == goalie.y)
+				continue;
+			memo->get_def_area_distance(it->team, it->id, left_dist, right_dist);
+			if ((side == 0 ? left_dist : right_dist) < 0) {
+				set_rule_breaker(it->team, it->id);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Rule 19: opponent touches the goalie in its defense area
+ */
+bool Native_Rules::rule_nineteen() {
+	if (in->local_play_state != 2)
+		return false;
+	double left_dist, right_dist;
+	for (int side = 0; side < 2; ++side) {
+		const BSmart::Int_Vector& goalie = (side == 0) ? in->left_goalie : in->right_goalie;
+		if (goalie.x < 0)
+			continue;
+		Robot_Sample_List::const_iterator keeper = world->robot_models.begin();
+		while (keeper != world->robot_models.end() && !(keeper->team == goalie.x && keeper->id == goalie.y))
+			++keeper;
+		if (keeper == world->robot_models.end())
+			continue;
+		int x1 = (int) keeper->pos.x;
+		int y1 = (int) keeper->pos.y;
+		for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+			if (it->team == goalie.x)
+				continue;
+			memo->get_def_area_distance(it->team, it->id, left_dist, right_dist);
+			if ((side == 0 ? left_dist : right_dist) >= 0)
+				continue;
+			int x2 = (int) it->pos.x;
+			int y2 = (int) it->pos.y;
+			if (sqrt((double) (x1 - x2) * (x1 - x2) + (double) (y1 - y2) * (y1 - y2)) >= 200)
+				continue;
+			set_rule_breaker(it->team, it->id);
+			set_freekick_pos((int) (x2 + (x1 - x2) / 2.), (int) (y2 + (y1 - y2) / 2.));
+			out.next_play_state = 5 + goalie.x * 6;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Rule 22: ball touched before the free kick is released
+ */
+bool Native_Rules::rule_twentytwo() {
+	int ps = in->local_play_state;
+	if (!(ps == 7 || ps == 8 || ps == 13 || ps == 14) || in->touches <= 0)
+		return false;
+	out.local_play_state = 1;
+	out.local_next_play_state = ps;
+	set_rule_breaker(in->last_touched.x, in->last_touched.y);
+	return true;
+}
+
+/**
+ * Rule 27: number of timeouts
+ */
+bool Native_Rules::rule_twentyseven() {
+	for (int team = 0; team < 2; ++team)
+		if (in->timeout_start[team] != 0 && in->timeouts[team] > 4)
+			return true;
+	return false;
+}
+
+/**
+ * Rule 28: timeout time exceeded
+ */
+bool Native_Rules::rule_twentyeight() {
+	for (int team = 0; team < 2; ++team)
+		if (in->timeout_start[team] != 0
+				&& in->timeout_total[team] + (in->timestamp - in->timeout_start[team]) > 300000)
+			return true;
+	return false;
+}
+
+/**
+ * Rule 29: goal, only in running and only after a second touch
+ */
+bool Native_Rules::rule_twentynine() {
+	if (in->local_play_state != 2 || in->ball_status == Sample::FLYING || in->touches <= 0)
+		return false;
+	set_rule_breaker(in->last_touched.x, in->last_touched.y);
+	if (in->left_team < 0)
+		return false;
+	int scorer;
+	if (memo->get_ball_in_goal(1))
+		scorer = in->left_team;
+	else if (memo->get_ball_in_goal(0))
+		scorer = abs(in->left_team - 1);
+	else
+		return false;
+	out.goal = scorer;
+	out.next_play_state = 13 - scorer * 6;
+	set_freekick_pos(0, 0);
+	return true;
+}
+
+/**
+ * Rule 30: ball left the field, throw in, corner kick or goal kick
+ */
+bool Native_Rules::rule_thirty() {
+	if (in->local_play_state != 2 || memo->get_ball_in_field())
+		return false;
+	int x = (int) world->ball_model.pos.x;
+	int y = (int) world->ball_model.pos.y;
+	int ltt = in->last_touched.x;
+	int left = in->left_team;
+
+	if (y > half_height || y < -half_height) {
+		int throw_in_y = half_height - Rule_Constants::THROW_IN;
+		set_freekick_pos(x, (y > half_height) ? throw_in_y : -throw_in_y);
+		out.next_play_state = 12 - ltt * 6;
+	} else {
+		if (left < 0 || y == 0 || (x >= -half_width && x <= half_width))
+			return false;
+		int sign_x = (x < 0) ? -1 : 1;
+		int sign_y = (y < 0) ? -1 : 1;
+		// corner kick if the ball is played over the own goal line
+		bool corner = (x < 0) == (ltt == left);
+		if (corner)
+			set_freekick_pos(sign_x * (half_width - Rule_Constants::CORNER_KICK),
+					sign_y * (half_height - Rule_Constants::CORNER_KICK));
+		else
+			set_freekick_pos(sign_x * (half_width - Rule_Constants::GOAL_KICK_FROM_LINE),
+					sign_y * (half_height - Rule_Constants::GOAL_KICK_FROM_TOUCH));
+		out.next_play_state = 11 - ltt * 6;
+	}
+	set_rule_breaker(ltt, in->last_touched.y);
+	return true;
+}
+
+/**
+ * Rule 42: offside, checked once after each change of the ball status
+ */
+bool Native_Rules::rule_fourtytwo() {
+	if (!in->check_offside)
+		return false;
+	out.reset_offside = true;
+
+	int ltt = in->last_touched.x;
+	int ltid = in->last_touched.y;
+	int left = in->left_team;
+	if (left < 0)
+		return false;
+	// attacking direction of the team which touched the ball
+	int direction = (ltt == left) ? 1 : -1;
+	int defender = (ltt == left) ? 1 - left : left;
+
+	Robot_Sample_List::const_iterator toucher = world->robot_models.begin();
+	while (toucher != world->robot_models.end() && !(toucher->team == ltt && toucher->id == ltid))
+		++toucher;
+	if (toucher == world->robot_models.end())
+		return false;
+	int x_touch = (int) toucher->pos.x;
+
+	for (Robot_Sample_List::const_iterator it = world->robot_models.begin(); it != world->robot_models.end(); ++it) {
+		int x1 = (int) it->pos.x;
+		if (it->team != ltt || it->id == ltid || direction * x1 <= direction * x_touch || direction * x1 <= 0)
+			continue;
+		int defenders = 0;
+		for (Robot_Sample_List::const_iterator opp = world->robot_models.begin(); opp != world->robot_models.end();
+				++opp) {
+			if (opp->team == defender && direction * (int) opp->pos.x > direction * x1)
+				defenders++;
+		}
+		if (defenders < 2) {
+			set_rule_breaker(ltt, it->id);
+			set_freekick_pos(x1, (int) it->pos.y);
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,96 @@
+#ifndef NATIVE_RULES_H
+#define NATIVE_RULES_H
+
+#include "filter_data.h"
+#include "rule_memo.h"
+#include "rule_profiler.h"
+#include <libbsmart/vector2.h>
+
+/**
+ * @brief State of the game kept in prolog, read once per cycle.
+ * Unknown teams and ids are -1.
+ */
+struct Native_Rule_Input {
+    int local_play_state;
+    int left_team;
+    BSmart::Int_Vector left_goalie;
+    BSmart::Int_Vector right_goalie;
+    // ball_status: last touched robot, status and number of touches
+    BSmart::Int_Vector last_touched;
+    int ball_status;
+    int touches;
+    bool check_offside;
+    // timeouts
+    BSmart::Time_Value timestamp;
+    BSmart::Time_Value timeout_start[2];
+    BSmart::Time_Value timeout_total[2];
+    int timeouts[2];
+    int max_robots;
+};
+
+/**
+ * @brief Outcome of one rule check and the changes it makes to the game
+ * state, applied by the caller. Unchanged values are -1.
+ */
+struct Native_Rule_Result {
+    int rule; // -42 if no rule is broken
+    bool has_rule_breaker;
+    BSmart::Int_Vector rule_breaker;
+    bool has_freekick_pos;
+    BSmart::Int_Vector freekick_pos;
+    int goal; // team which scored
+    int next_play_state; // set_next_play_state, stops the game
+    int local_play_state;
+    int local_next_play_state;
+    bool reset_offside;
+};
+
+/**
+ * @class Native_Rules
+ * @brief C++ version of check_rules in ssl_refbox_rules_prolog.pl.
+ * The rules are checked in the same order and robots are enumerated in the
+ * same order as roboter/7 does, so the results are the same as in prolog.
+ * Nothing is changed here, all changes are returned in the result.
+ */
+class Native_Rules
+{
+public:
+    Native_Rules();
+
+    Native_Rule_Result check_rules(const World_Snapshot&, Rule_Memo&, const Native_Rule_Input&);
+
+    //time every rule, 0 to switch off
+    void set_profiler(Rule_Profiler*);
+
+private:
+    bool rule_one();
+    bool rule_one(int team);
+    bool rule_three();
+    bool rule_fourteen();
+    bool rule_fifteen();
+    bool rule_sixteen();
+    bool rule_seventeen();
+    bool rule_seventeen_penalty(int attacker, int side);
+    bool rule_eighteen();
+    bool rule_nineteen();
+    bool rule_twentytwo();
+    bool rule_twentyseven();
+    bool rule_twentyeight();
+    bool rule_twentynine();
+    bool rule_thirty();
+    bool rule_fourtytwo();
+
+    void set_rule_breaker(int team, int id);
+    void set_freekick_pos(int x, int y);
+
+    bool freekick_yellow();
+    bool freekick_blue();
+
+    const World_Snapshot* world;
+    Rule_Memo* memo;
+    const Native_Rule_Input* in;
+    Native_Rule_Result out;
+    Rule_Profiler* profiler;
+};
+
+#endif //NATIVE_RULES_H
@@ -0,0 +1,228 @@
+#include "parameter_sweep.h"
+#include "particle_filter.h"
+#include "percept_log.h"
+#include "rule_profiler.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <time.h>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Parameter_Sweep::logger(Logger::getLogger("Parameter_Sweep"));
+
+Parameter_Sweep::Parameter_Sweep(const ConfigFile& config_, const std::string& file_, int jobs_) :
+	config(config_), file(file_), jobs(jobs_) {
+	next = 0;
+	if (jobs < 1)
+		jobs = QThread::idealThreadCount();
+	if (jobs < 1)
+		jobs = 1;
+}
+
+void Parameter_Sweep::Worker::run() {
+	for (;;) {
+		sweep->mutex.lock();
+		if (sweep->next >= sweep->results.size()) {
+			sweep->mutex.unlock();
+			return;
+		}
+		Result& result = sweep->results[sweep->next++];
+		sweep->mutex.unlock();
+		sweep->evaluate(result);
+	}
+}
+
+/**
+ * The reference and every combination of the sweep_<name> values
+ */
+void Parameter_Sweep::create_grid() {
+	Filter_Parameters reference;
+	reference.read(config);
+
+	std::vector<std::vector<double> > values(Filter_Parameters::COUNT);
+	for (int i = 0; i < Filter_Parameters::COUNT; ++i) {
+		std::istringstream list(config.read<std::string>(std::string("sweep_") + Filter_Parameters::name(i), ""));
+		double value;
+		while (list >> value)
+			values[i].push_back(value);
+		if (values[i].empty())
+			values[i].push_back(reference.value(i));
+	}
+
+	Result result;
+	result.ok = false;
+	result.cycles = 0;
+	result.ball_error = result.robot_error = 0.;
+	result.status_agreement = 0.;
+	result.cpu_ms = 0.;
+	result.parameters = reference;
+	results.clear();
+	results.push_back(result);
+
+	// counting through the grid, index[0] is the fastest digit
+	std::vector<unsigned int> index(Filter_Parameters::COUNT, 0);
+	for (;;) {
+		for (int i = 0; i < Filter_Parameters::COUNT; ++i)
+			result.parameters.value(i) = values[i][index[i]];
+		results.push_back(result);
+		int i = 0;
+		while (i < Filter_Parameters::COUNT && ++index[i] == values[i].size())
+			index[i++] = 0;
+		if (i == Filter_Parameters::COUNT)
+			break;
+	}
+}
+
+bool Parameter_Sweep::run(std::ostream& summary) {
+	Percept_Log check;
+	if (!check.open_read(file)) {
+		LOG4CXX_ERROR( logger, "No percept log: " + file);
+		return false;
+	}
+	check.close();
+	create_grid();
+
+	std::ostringstream o;
+	o << "Running " << results.size() << " parameter sets with " << jobs << " jobs";
+	LOG4CXX_INFO( logger, o.str());
+	long long start = Rule_Profiler::now();
+	next = 0;
+	std::vector<Worker*> workers;
+	for (int i = 0; i < jobs && i < (int) results.size(); ++i) {
+		workers.push_back(new Worker(this));
+		workers.back()->start();
+	}
+	for (unsigned int i = 0; i < workers.size(); ++i) {
+		workers[i]->wait();
+		delete workers[i];
+	}
+	long long msec = (Rule_Profiler::now() - start) / 1000;
+
+	const Result& reference = results[0];
+	if (!reference.ok) {
+		LOG4CXX_ERROR( logger, "Could not replay " + file);
+		return false;
+	}
+	for (std::vector<Result>::iterator it = results.begin(); it != results.end(); ++it) {
+		unsigned int same = 0;
+		unsigned int n = std::min(it->ball_status.size(), reference.ball_status.size());
+		for (unsigned int i = 0; i < n; ++i) {
+			if (it->ball_status[i] == reference.ball_status[i])
+				++same;
+		}
+		it->status_agreement = n > 0 ? (double) same / n : 0.;
+	}
+	std::stable_sort(results.begin() + 1, results.end(), better);
+
+	// ball mm, robot mm, status %, cpu ms per cycle, the parameters
+	summary << "      ball  robot status  cpu_ms";
+	for (int i = 0; i < Filter_Parameters::COUNT; ++i)
+		summary << " " << Filter_Parameters::name(i);
+	summary << std::endl;
+	for (std::vector<Result>::const_iterator it = results.begin(); it != results.end(); ++it) {
+		if (!it->ok) {
+			summary << "failed" << std::endl;
+			continue;
+		}
+		summary << std::fixed << std::setprecision(1) << std::setw(10) << it->ball_error << std::setw(7)
+				<< it->robot_error << std::setw(6) << it->status_agreement * 100 << "%" << std::setprecision(3)
+				<< std::setw(8) << it->cpu_ms;
+		summary.unsetf(std::ios::floatfield);
+		for (int i = 0; i < Filter_Parameters::COUNT; ++i)
+			summary << " " << it->parameters.value(i);
+		summary << (it == results.begin() ? "  (reference)" : "") << std::endl;
+	}
+	summary << results.size() << " parameter sets, " << reference.cycles << " cycles in " << msec << " ms"
+			<< std::endl;
+	return true;
+}
+
+/**
+ * One filter over the whole log, the cycle of Particle_Filter_Mother::run
+ * with the recorded time differences
+ */
+void Parameter_Sweep::evaluate(Result& result) {
+	Percept_Log log;
+	if (!log.open_read(file))
+		return;
+	Pre_Filter_Data pf_data;
+	Filter_Data filter_data(config.read<int>("robot_ids", Filter_Data::NUMBER_OF_IDS));
+	filter_data.set_parameters(result.parameters);
+	Particle_Filter pf(&pf_data, &filter_data, result.parameters, Particle_Filter::REPLAY_RANDOM_SEED);
+
+	double ball_error = 0., robot_error = 0., cpu_ms = 0.;
+	int ball_errors = 0, robot_errors = 0;
+	double time_diff;
+	while (log.read(pf_data, time_diff)) {
+		double start = thread_cpu_ms();
+		pf.motion_update(time_diff);
+		pf.sensor_update();
+		pf.resample();
+		pf.create_models();
+		cpu_ms += thread_cpu_ms() - start;
+		++result.cycles;
+
+		Ball_Sample ball = filter_data.get_ball_model();
+		result.ball_status.push_back(ball.status);
+		double nearest = -1.;
+		for (int cam = 0; cam < 2; ++cam) {
+			Ball_Percept_List balls = pf_data.get_current_balls(cam);
+			for (Ball_Percept_List::const_iterator it = balls.begin(); it != balls.end(); ++it) {
+				double dist = sqrt((it->x - ball.pos.x) * (it->x - ball.pos.x) + (it->y - ball.pos.y)
+						* (it->y - ball.pos.y));
+				if (nearest < 0. || dist < nearest)
+					nearest = dist;
+			}
+		}
+		if (nearest >= 0.) {
+			ball_error += nearest;
+			++ball_errors;
+		}
+
+		for (int cam = 0; cam < 2; ++cam) {
+			std::vector<BSmart::Int_Vector> robots = pf_data.get_percepted_robots(cam);
+			for (unsigned int i = 0; i < robots.size(); ++i) {
+				if (robots[i].y >= filter_data.get_number_of_ids())
+					continue;
+				Robot_Sample robot = filter_data.get_robot_model(robots[i].x, robots[i].y);
+				Robot_Percept_List percepts = pf_data.get_robots(cam, robots[i].x, robots[i].y);
+				nearest = -1.;
+				for (Robot_Percept_List::const_iterator it = percepts.begin(); it != percepts.end(); ++it) {
+					double dist = sqrt((it->x - robot.pos.x) * (it->x - robot.pos.x) + (it->y - robot.pos.y)
+							* (it->y - robot.pos.y));
+					if (nearest < 0. || dist < nearest)
+						nearest = dist;
+				}
+				if (nearest >= 0.) {
+					robot_error += nearest;
+					++robot_errors;
+				}
+			}
+		}
+	}
+
+	result.ball_error = ball_errors > 0 ? ball_error / ball_errors : 0.;
+	result.robot_error = robot_errors > 0 ? robot_error / robot_errors : 0.;
+	result.cpu_ms = result.cycles > 0 ? cpu_ms / result.cycles : 0.;
+	result.ok = result.cycles > 0;
+}
+
+/**
+ * Best accuracy per ms first: the tracking error, weighted with the ball
+ * status disagreement, times the cpu time
+ */
+bool Parameter_Sweep::better(const Result& a, const Result& b) {
+	if (a.ok != b.ok)
+		return a.ok;
+	double cost_a = (a.ball_error + a.robot_error) * (2. - a.status_agreement) * a.cpu_ms;
+	double cost_b = (b.ball_error + b.robot_error) * (2. - b.status_agreement) * b.cpu_ms;
+	return cost_a < cost_b;
+}
+
+double Parameter_Sweep::thread_cpu_ms() {
+	struct timespec t;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+	return t.tv_sec * 1000. + t.tv_nsec / 1000000.;
+}
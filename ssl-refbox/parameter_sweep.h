@@ -0,0 +1,72 @@
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include <QMutex>
+#include <QThread>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "filter_parameters.h"
+#include "../ConfigFile/ConfigFile.h"
+#include <log4cxx/logger.h>
+
+/**
+ * @class Parameter_Sweep
+ * @brief Runs the particle filter with every combination of the parameter
+ * grid over one percept log (record_percepts), several combinations at the
+ * same time, and scores them against the percepts.
+ * The grid is read from the config: sweep_<name> lists the values of the
+ * Filter_Parameters <name>, separated by spaces. Parameters without a list
+ * keep their filter_<name> value. The first run uses the config values only
+ * and is the reference for the ball status.
+ */
+class Parameter_Sweep
+{
+public:
+    Parameter_Sweep(const ConfigFile&, const std::string& file, int jobs);
+
+    // summary with one line per combination, best accuracy per ms first
+    bool run(std::ostream& summary);
+
+private:
+    struct Result {
+        Filter_Parameters parameters;
+        bool ok;
+        int cycles;
+        // mean distance of the models to the nearest percept in mm
+        double ball_error;
+        double robot_error;
+        // cycles with the same ball status as the reference
+        double status_agreement;
+        // cpu time of the filter per cycle
+        double cpu_ms;
+        std::vector<int> ball_status;
+    };
+
+    class Worker : public QThread
+    {
+    public:
+        Worker(Parameter_Sweep* sweep_) : sweep(sweep_) {}
+        void run();
+    private:
+        Parameter_Sweep* sweep;
+    };
+
+    static log4cxx::LoggerPtr logger;
+
+    void create_grid();
+    void evaluate(Result&);
+    static bool better(const Result&, const Result&);
+    static double thread_cpu_ms();
+
+    const ConfigFile& config;
+    std::string file;
+    int jobs;
+
+    // next combination for the workers
+    QMutex mutex;
+    std::vector<Result> results;
+    unsigned int next;
+};
+
+#endif //PARAMETER_SWEEP_H
@@ -7,11 +7,33 @@
 #include <QWaitCondition>
 #include <algorithm>
 #include <stdio.h>
+#include "rule_profiler.h"
+#include "latency_histogram.h"
+#include "trace.h"
+#include "async_log.h"
+
+static Health_Counter nan_ball_samples("nan_ball_samples", "Ball samples with a NaN position in weight_ball");
+static Health_Counter nan_ball_weights("nan_ball_weights", "Resampling steps with a NaN total ball weight");
+static Health_Counter zero_ball_models("zero_ball_models", "Ball models at x = 0, usually a zero total weight");
+
+//cosines of the angle limits in determine_ball_status
+static const double COS_1_DEGREE = 0.99984769515639124;
+static const double COS_10_DEGREES = 0.98480775301220802;
+static const double COS_60_DEGREES = 0.5;
+
+static Health_Counter deadline_misses("filter_deadline_misses", "Filter cycles longer than filter_cycle_budget_us");
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Particle_Filter_Mother::logger(Logger::getLogger("Particle_Filter_Mother"));
 
 Particle_Filter_Mother::Particle_Filter_Mother(Pre_Filter_Data* pf_data_, Filter_Data* filter_data_,
-		QWaitCondition* rules_wait_condition_, QWaitCondition* new_data_wait_condition_) :
-		filter_data(filter_data_) {
-	pf = new Particle_Filter(pf_data_, filter_data_);
+		QWaitCondition* rules_wait_condition_, QWaitCondition* new_data_wait_condition_,
+		const Filter_Parameters& parameters) :
+		pf_data(pf_data_), filter_data(filter_data_) {
+	pf = new Particle_Filter(&cycle_data, filter_data_, parameters, (unsigned) time(NULL));
+	cycle_budget_us = (long long) parameters.cycle_budget_us;
+	relaxed_cycles = 0;
 	new_data = false;
 	rules_wait_condition = rules_wait_condition_;
 	new_data_wait_condition = new_data_wait_condition_;
@@ -29,77 +51,149 @@ void Particle_Filter_Mother::connectActions() {
 			SIGNAL ( change_ball_last_touched ( QString ) ));
 }
 
+/**
+ * Record the input of every filter cycle for --sweep
+ */
+bool Particle_Filter_Mother::set_percept_log(const std::string& file) {
+	return percept_log.open_write(file);
+}
+
 void Particle_Filter_Mother::run() {
 
 	QMutex wait_for_data_mutex;
+	Trace::set_thread_name("particle_filter");
 
 	for (;;) {
 		// will be notified by sslvision.cc execute
 		wait_for_data_mutex.lock();
+		long long wait_start = Trace::enabled() ? Rule_Profiler::now() : 0;
 		new_data_wait_condition->wait(&wait_for_data_mutex);
+		int frame = -1;
+		if (Trace::enabled()) {
+			frame = pf_data->get_newest_frame();
+			Trace::complete("wait_for_vision", wait_start, Rule_Profiler::now(), frame, -1);
+		}
 
 		new_data = false;
+		// vision may write pf_data during the cycle, filter and log get the same copy
+		pf_data->copy_to(cycle_data);
+		long long received_us, queued_us;
+		cycle_data.get_latency_stamps(received_us, queued_us);
+		long long start = Rule_Profiler::now();
+		if (queued_us != 0)
+			Metrics::filter_queue_wait.record(start - queued_us);
 		pf->motion_update();
+		percept_log.write(cycle_data, pf->get_time_diff());
+		long long motion_end = Rule_Profiler::now();
 		pf->sensor_update();
+		long long sensor_end = Rule_Profiler::now();
 		pf->resample();
+		long long resample_end = Rule_Profiler::now();
+		filter_data->set_received_us(received_us);
 		pf->create_models();
+		long long end = Rule_Profiler::now();
+		Metrics::filter_motion_update.record(motion_end - start);
+		Metrics::filter_sensor_update.record(sensor_end - motion_end);
+		Metrics::filter_resample.record(resample_end - sensor_end);
+		Metrics::filter_create_models.record(end - resample_end);
+		if (cycle_budget_us > 0)
+			keep_budget(end - start);
+		if (Trace::enabled()) {
+			Trace::complete("motion_update", start, motion_end, frame, -1);
+			Trace::complete("sensor_update", motion_end, sensor_end, frame, -1);
+			Trace::complete("resample", sensor_end, resample_end, frame, -1);
+			Trace::complete("create_models", resample_end, end, frame, -1);
+			Trace::instant("wake_rules", frame);
+		}
 		rules_wait_condition->wakeAll();
 
 		wait_for_data_mutex.unlock();
 	}
 }
 
+void Particle_Filter_Mother::keep_budget(long long cycle_us) {
+	int quality = pf->get_quality();
+	if (cycle_us > cycle_budget_us) {
+		deadline_misses.count();
+		relaxed_cycles = 0;
+		if (quality + 1 < Particle_Filter::QUALITY_LEVELS) {
+			++quality;
+			Async_Log::warn(logger, "filter cycle of {} us over the budget of {} us, quality level {}", cycle_us,
+					cycle_budget_us, quality);
+		}
+	} else if (2 * cycle_us > cycle_budget_us || quality == Particle_Filter::QUALITY_FULL) {
+		relaxed_cycles = 0;
+	} else if (++relaxed_cycles >= RECOVER_CYCLES) {
+		relaxed_cycles = 0;
+		--quality;
+		Async_Log::info(logger, "filter cycles within the budget, quality level {}", quality);
+	}
+	pf->set_quality((Particle_Filter::Quality) quality);
+	Metrics::filter_quality = quality;
+}
+
 void Particle_Filter_Mother::new_frame() //SLOT
 {
 	new_data = true;
 }
 
-Particle_Filter::Particle_Filter(Pre_Filter_Data* pf_data_, Filter_Data* filter_data_) :
-		pf_data(pf_data_), filter_data(filter_data_) {
-	srand((unsigned) time(NULL));
+Particle_Filter::Particle_Filter(Pre_Filter_Data* pf_data_, Filter_Data* filter_data_,
+		const Filter_Parameters& parameters, unsigned int random_seed) :
+		pf_data(pf_data_), filter_data(filter_data_), quality(QUALITY_FULL),
+		kalman_robots(parameters.robot_tracker == Filter_Parameters::KALMAN_TRACKER), robot_tracker(parameters) {
+	random_generator.seed(random_seed);
 
 	Ball_Sample_List new_balls(Filter_Data::BALL_SAMPLES, random_ball_sample());
 
 	filter_data->set_ball_samples(new_balls);
 
+	//no robot particles with the Kalman filter
 	Robot_Sample new_robot = random_robot_sample();
 	new_robot.confidence = 0.;
 	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
 		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
 			new_robot.team = team;
 			new_robot.id = id;
-			Robot_Sample_List new_robots(Filter_Data::ROBOT_SAMPLES, new_robot);
+			Robot_Sample_List new_robots(kalman_robots ? 0 : Filter_Data::ROBOT_SAMPLES, new_robot);
 			filter_data->set_robot_samples(team, id, new_robots);
 		}
 	}
 
 	last_movement = BSmart::Systemcall::get_timef();
+	time_diff = 0.;
 	ball_distance_threshold = 500;
-	std_dev_ball = 5;
-	std_dev_robot = 5;
+	std_dev_ball = parameters.std_dev_ball;
+	std_dev_robot = parameters.std_dev_robot;
 
-	alpha_slow_ball = 0.4; //0.4
-	alpha_fast_ball = 0.8; //0.8
+	alpha_slow_ball = parameters.alpha_slow_ball;
+	alpha_fast_ball = parameters.alpha_fast_ball;
 	o_slow_ball = 0.2;
 	o_fast_ball = 0.5;
 
-	alpha_slow_robots = 0.2;
-	alpha_fast_robots = 0.5;
+	alpha_slow_robots = parameters.alpha_slow_robots;
+	alpha_fast_robots = parameters.alpha_fast_robots;
 	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
 		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
 			o_slow_robots[team][id] = 0.;
 			o_fast_robots[team][id] = 0.;
+			robot_seeded[team][id] = false;
+			robot_unseen_ms[team][id] = 0.;
 		}
 	}
 
+	seed_spread = parameters.seed_spread;
+	seed_rotation_spread = parameters.seed_rotation_spread;
+	reseed_distance = parameters.reseed_distance;
+	reseed_ms = parameters.reseed_ms;
+	ball_seeded = false;
+	ball_unseen_ms = 0.;
+
 	ball_last_touched_saved = 0;
 	ball_status_saved = 0;
 	ball_direction_before = BSmart::Pose(0., 0., 0.);
 	ball_direction_after = BSmart::Pose(0., 0., 0.);
 	last_touched_robot_saved = BSmart::Int_Vector(0, 0);
 
-	circle.radius = BSmart::Field::robot_radius + BSmart::Field::ball_radius;
-
 	last_ball_model = Ball_Sample();
 	ball_lying_counter = 0;
 	newest_frame = 0;
@@ -114,15 +208,39 @@ Particle_Filter::~Particle_Filter() {
 }
 
 void Particle_Filter::motion_update() {
-	double time_diff = BSmart::Systemcall::get_time_sincef(last_movement);
+	double ms = BSmart::Systemcall::get_time_sincef(last_movement);
 	last_movement = BSmart::Systemcall::get_timef();
+	motion_update(ms);
+}
+
+void Particle_Filter::motion_update(double ms) {
+	time_diff = ms;
 
 	robot_obstacles.clear();
 	robot_obstacles = filter_data->get_current_robot_obstacles();
 
-	filter_data->move_robots(time_diff, robot_obstacles);
-	filter_data->move_balls(time_diff, robot_obstacles);
+	if (kalman_robots)
+		robot_tracker.predict(time_diff);
+	else if (quality >= QUALITY_COARSE_COLLISIONS)
+		filter_data->move_robots(time_diff, Robot_Sample_List(), random_generator, true);
+	else
+		filter_data->move_robots(time_diff, robot_obstacles, random_generator, quality >= QUALITY_MOVE_SEEN_ROBOTS);
+
+	if (quality >= QUALITY_COARSE_COLLISIONS) {
+		Robot_Sample_List near_ball;
+		for (unsigned int i = 0; i < robot_obstacles.size(); ++i) {
+			if (last_ball_model.pos.distance_to_2D(robot_obstacles[i].pos) < COARSE_COLLISION_DISTANCE)
+				near_ball.push_back(robot_obstacles[i]);
+		}
+		filter_data->move_balls(time_diff, near_ball, random_generator);
+	} else {
+		filter_data->move_balls(time_diff, robot_obstacles, random_generator);
+	}
+
+}
 
+double Particle_Filter::get_time_diff() {
+	return time_diff;
 }
 
 void Particle_Filter::sensor_update() {
@@ -137,11 +255,7 @@ void Particle_Filter::sensor_update() {
 	Robot_Percept_List robots;
 
 	Robot_Percept_List cur_robots[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
-	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-			cur_robots[team][id].clear();
-		}
-	}
+	std::vector<BSmart::Int_Vector> percepted_robots[2];
 
 	filter_data->reduce_visibility();
 
@@ -165,34 +279,50 @@ void Particle_Filter::sensor_update() {
 			iter_ball++;
 		}
 
-		//robots
-		for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-			for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-				robots = pf_data->get_robots(cam, team, id);
-				std::vector<Robot_Percept>::iterator iter_robot = robots.begin();
-				std::vector<Robot_Percept>::iterator iter_robot_end = robots.end();
-				while (iter_robot != iter_robot_end) {
-					//only if percept is good
-					if (iter_robot->confidence > 0) {
-						if (weight_robot(*iter_robot, team, id)) {
-							filter_data->set_robot_seen(team, id);
-						}
-						cur_robots[team][id].push_back(*iter_robot);
+		//robots, only the ones with percepts from this camera
+		percepted_robots[cam] = pf_data->get_percepted_robots(cam);
+		for (unsigned int i = 0; i < percepted_robots[cam].size(); ++i) {
+			int team = percepted_robots[cam][i].x;
+			int id = percepted_robots[cam][i].y;
+			if (!filter_data->is_valid_robot(team, id))
+				continue;
+			robots = pf_data->get_robots(cam, team, id);
+			std::vector<Robot_Percept>::iterator iter_robot = robots.begin();
+			std::vector<Robot_Percept>::iterator iter_robot_end = robots.end();
+			while (iter_robot != iter_robot_end) {
+				//only if percept is good
+				if (iter_robot->confidence > 0) {
+					if (kalman_robots) {
+						robot_tracker.update(team, id, *iter_robot);
+						filter_data->set_robot_seen(team, id);
+					} else if (weight_robot(*iter_robot, team, id)) {
+						filter_data->set_robot_seen(team, id);
 					}
-
-					++iter_robot;
+					cur_robots[team][id].push_back(*iter_robot);
 				}
-				robots.clear();
+
+				++iter_robot;
 			}
+			robots.clear();
 		}
 	}
 
 	//set new percepts, first balls...
 	filter_data->set_current_ball_percepts(cur_balls);
-	//then robots
-	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-			filter_data->set_current_robot_percepts(team, id, cur_robots[team][id]);
+	//then robots: every seen robot gets its (maybe empty) list, unseen robots
+	//only if they had a percept
+	std::vector<BSmart::Int_Vector> active_robots = filter_data->get_active_robots();
+	for (unsigned int i = 0; i < active_robots.size(); ++i) {
+		int team = active_robots[i].x;
+		int id = active_robots[i].y;
+		filter_data->set_current_robot_percepts(team, id, cur_robots[team][id]);
+	}
+	for (int cam = 0; cam < 2; ++cam) {
+		for (unsigned int i = 0; i < percepted_robots[cam].size(); ++i) {
+			int team = percepted_robots[cam][i].x;
+			int id = percepted_robots[cam][i].y;
+			if (filter_data->is_valid_robot(team, id))
+				filter_data->set_current_robot_percepts(team, id, cur_robots[team][id]);
 		}
 	}
 }
@@ -203,9 +333,8 @@ bool Particle_Filter::weight_ball(Ball_Percept& perc) {
 	Ball_Sample_List samples = filter_data->get_ball_samples();
 
 	for (Ball_Sample_List::iterator it = samples.begin(); it != samples.end(); it++) {
-		if (std::isnan(it->pos.x)) {
-			std::cout << "weight_ball isnan: it->pos.x: " << it->pos.x << std::endl;
-		}
+		if (std::isnan(it->pos.x))
+			nan_ball_samples.count();
 		double dist = dist_in_2d(perc.cam, it->pos, percept);
 		//        if(dist < ball_distance_threshold)
 		{
@@ -257,7 +386,15 @@ void Particle_Filter::resample() {
 	Ball_Percept_List balls = filter_data->get_current_ball_percepts();
 	int num_balls = balls.size();
 
-	if (num_balls > 0) {
+	//speed heuristic for new ball samples
+	BSmart::Pose3D ball_speed(pf_data->get_ball_direction_after().x, pf_data->get_ball_direction_after().y, 0.);
+
+	ball_unseen_ms += time_diff;
+	if (num_balls > 0 && (!ball_seeded || ball_unseen_ms > reseed_ms || teleported(
+			BSmart::Double_Vector(last_ball_model.pos.x, last_ball_model.pos.y), balls))) {
+		//first percept, back after a while or placed: all samples at the percepts
+		filter_data->set_ball_samples(seed_balls(balls, ball_speed));
+	} else if (num_balls > 0) {
 		ball_samples_old.clear();
 		ball_samples_new.clear();
 		ball_samples_old = filter_data->get_ball_samples();
@@ -275,10 +412,10 @@ void Particle_Filter::resample() {
 
 		if (std::isnan(total_weight)) {
 			total_weight = 0;
-			std::cout << "total_weight is not a number - please check!" << std::endl;
+			nan_ball_weights.count();
 		}
 
-		average_weight = total_weight / Filter_Data::BALL_SAMPLES;
+		average_weight = total_weight / ball_samples_old.size();
 
 		o_slow_ball += alpha_slow_ball * (average_weight - o_slow_ball);
 
@@ -292,14 +429,12 @@ void Particle_Filter::resample() {
 		augment = std::max(0., 1. - (o_fast_ball / o_slow_ball));
 		random = 0.;
 
-		//speed heuristic for new ball samples
-		BSmart::Pose3D ball_speed(pf_data->get_ball_direction_after().x, pf_data->get_ball_direction_after().y, 0.);
-
 		double random_derivation;
 		int augment_ball_counter = 0;
 
-		for (int i = 0; i < Filter_Data::BALL_SAMPLES; ++i) {
-			random = (double) rand() / (double) RAND_MAX;
+		const int count = ball_sample_count();
+		for (int i = 0; i < count; ++i) {
+			random = random_generator.uniform();
 			if (random < augment) { // insert new samples
 				//only when there are percepts. no random samples
 				int ball_percept = random_number(0, (num_balls - 1));
@@ -310,7 +445,7 @@ void Particle_Filter::resample() {
 				new_ball.age = 0;
 				augment_ball_counter++;
 			} else { //draw from derivation
-				random_derivation = (double) rand() / (double) RAND_MAX * total_weight;
+				random_derivation = random_generator.uniform() * total_weight;
 
 				double cnt = 0.;
 				int j = 0;
@@ -329,80 +464,162 @@ void Particle_Filter::resample() {
 		//copy new samples
 		filter_data->set_ball_samples(ball_samples_new);
 	}
+	if (num_balls > 0) {
+		ball_seeded = true;
+		ball_unseen_ms = 0.;
+	}
+
+	if (kalman_robots)
+		return;
 
 	//speed Heuristic for robot samples
 	BSmart::Pose robot_speed(0., 0.);
 
 	//robots
 	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-			Robot_Percept_List robots = filter_data->get_current_robot_percepts(team, id);
-			int num_robots = robots.size();
-			if (filter_data->get_robot_seen(team, id) && num_robots > 0) {
-
-				robot_samples_old.clear();
-				robot_samples_new.clear();
-				robot_samples_old = filter_data->get_robot_samples(team, id);
-
-				//calc total weight
-				total_weight = 0.;
-				for (Robot_Sample_List::iterator it = robot_samples_old.begin(); it != robot_samples_old.end(); ++it) {
-					total_weight += it->weighting;
-					it->age++;
-				}
+		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id)
+			robot_unseen_ms[team][id] += time_diff;
+	}
+	std::vector<BSmart::Int_Vector> active_robots = filter_data->get_active_robots();
+	for (unsigned int n = 0; n < active_robots.size(); ++n) {
+		int team = active_robots[n].x;
+		int id = active_robots[n].y;
+		Robot_Percept_List robots = filter_data->get_current_robot_percepts(team, id);
+		int num_robots = robots.size();
+		if (num_robots > 0 && (!robot_seeded[team][id] || robot_unseen_ms[team][id] > reseed_ms || teleported(
+				filter_data->get_robot_model(team, id).pos, robots))) {
+			robot_samples_new = seed_robots(team, id, robots, pf_data->get_robot_direction(team, id));
+			filter_data->set_robot_samples(team, id, robot_samples_new);
+		} else if (num_robots > 0) {
+
+			robot_samples_old.clear();
+			robot_samples_new.clear();
+			robot_samples_old = filter_data->get_robot_samples(team, id);
+
+			//calc total weight
+			total_weight = 0.;
+			for (Robot_Sample_List::iterator it = robot_samples_old.begin(); it != robot_samples_old.end(); ++it) {
+				total_weight += it->weighting;
+				it->age++;
+			}
+
+			average_weight = total_weight / Filter_Data::ROBOT_SAMPLES;
+
+			o_slow_robots[team][id] += alpha_slow_robots * (average_weight - o_slow_robots[team][id]);
+			if (o_slow_robots[team][id] < 0.00000000001)
+				o_slow_robots[team][id] = 0.00000000001;
+			o_fast_robots[team][id] += alpha_fast_robots * (average_weight - o_fast_robots[team][id]);
+			if (o_fast_robots[team][id] < 0.000000000001)
+				o_fast_robots[team][id] = 0.000000000001;
+
+			augment = std::max(0., 1. - (o_fast_robots[team][id] / o_slow_robots[team][id]));
+
+			//augmented preparation
+			Robot_Sample augment_robot;
+			//heuristical approach
+			robot_speed = pf_data->get_robot_direction(team, id);
+
+			for (int i = 0; i < Filter_Data::ROBOT_SAMPLES; ++i) {
 
-				average_weight = total_weight / Filter_Data::ROBOT_SAMPLES;
-
-				o_slow_robots[team][id] += alpha_slow_robots * (average_weight - o_slow_robots[team][id]);
-				if (o_slow_robots[team][id] < 0.00000000001)
-					o_slow_robots[team][id] = 0.00000000001;
-				o_fast_robots[team][id] += alpha_fast_robots * (average_weight - o_fast_robots[team][id]);
-				if (o_fast_robots[team][id] < 0.000000000001)
-					o_fast_robots[team][id] = 0.000000000001;
-
-				augment = std::max(0., 1. - (o_fast_robots[team][id] / o_slow_robots[team][id]));
-
-				//augmented preparation
-				Robot_Sample augment_robot;
-				//heuristical approach
-				robot_speed = pf_data->get_robot_direction(team, id);
-
-				for (int i = 0; i < Filter_Data::ROBOT_SAMPLES; ++i) {
-
-					random = (double) rand() / (double) RAND_MAX;
-
-					if (random < augment) { // insert new samples
-						int robot_percept = random_number(0, (num_robots - 1));
-						augment_robot.pos = BSmart::Pose(robots[robot_percept].x, robots[robot_percept].y,
-								robots[robot_percept].rotation);
-
-						//Heuristik
-						augment_robot.speed = robot_speed;
-
-						augment_robot.team = team;
-						augment_robot.id = id;
-						robot_samples_new.push_back(augment_robot);
-					} else { //draw from derivation
-						double r = (double) rand() / (double) RAND_MAX * total_weight;
-						double cnt = 0.;
-						int j = 0;
-
-						while (cnt < r) {
-							cnt += robot_samples_old[j].weighting;
-							j++;
-						}
-						if (j == 0)
-							++j;
-						robot_samples_new.push_back(robot_samples_old[j - 1]);
+				random = random_generator.uniform();
+
+				if (random < augment) { // insert new samples
+					int robot_percept = random_number(0, (num_robots - 1));
+					augment_robot.pos = BSmart::Pose(robots[robot_percept].x, robots[robot_percept].y,
+							robots[robot_percept].rotation);
+
+					//Heuristik
+					augment_robot.speed = robot_speed;
+
+					augment_robot.team = team;
+					augment_robot.id = id;
+					robot_samples_new.push_back(augment_robot);
+				} else { //draw from derivation
+					double r = random_generator.uniform() * total_weight;
+					double cnt = 0.;
+					int j = 0;
+
+					while (cnt < r) {
+						cnt += robot_samples_old[j].weighting;
+						j++;
 					}
+					if (j == 0)
+						++j;
+					robot_samples_new.push_back(robot_samples_old[j - 1]);
 				}
-				//copy new samples
-				filter_data->set_robot_samples(team, id, robot_samples_new);
 			}
+			//copy new samples
+			filter_data->set_robot_samples(team, id, robot_samples_new);
+		}
+		if (num_robots > 0) {
+			robot_seeded[team][id] = true;
+			robot_unseen_ms[team][id] = 0.;
 		}
 	}
 }
 
+int Particle_Filter::ball_sample_count() const {
+	return quality >= QUALITY_FEWER_BALL_SAMPLES ? Filter_Data::BALL_SAMPLES / 2 : Filter_Data::BALL_SAMPLES;
+}
+
+bool Particle_Filter::teleported(const BSmart::Double_Vector& model, const Ball_Percept_List& balls) {
+	for (unsigned int i = 0; i < balls.size(); ++i) {
+		if (BSmart::Pose(balls[i].x, balls[i].y).distance_to(model) <= reseed_distance)
+			return false;
+	}
+	return true;
+}
+
+bool Particle_Filter::teleported(const BSmart::Double_Vector& model, const Robot_Percept_List& robots) {
+	for (unsigned int i = 0; i < robots.size(); ++i) {
+		if (BSmart::Pose(robots[i].x, robots[i].y).distance_to(model) <= reseed_distance)
+			return false;
+	}
+	return true;
+}
+
+Ball_Sample_List Particle_Filter::seed_balls(const Ball_Percept_List& balls, const BSmart::Pose3D& speed) {
+	Ball_Sample_List samples;
+	const int count = ball_sample_count();
+	samples.reserve(count);
+	BSmart::Double_Vector noise(0., 0.);
+	for (int i = 0; i < count; ++i) {
+		const Ball_Percept& percept = balls[i % balls.size()];
+		Ball_Sample ball;
+		ball.fuettere_polarbaer(&noise, random_generator);
+		ball.pos = BSmart::Pose3D(percept.x + seed_spread * noise.x, percept.y + seed_spread * noise.y, 0.);
+		ball.speed = speed;
+		ball.weighting = 1.;
+		samples.push_back(ball);
+	}
+	return samples;
+}
+
+Robot_Sample_List Particle_Filter::seed_robots(int team, int id, const Robot_Percept_List& robots,
+		const BSmart::Pose& speed) {
+	Robot_Sample_List samples;
+	samples.reserve(Filter_Data::ROBOT_SAMPLES);
+	BSmart::Double_Vector noise(0., 0.);
+	BSmart::Double_Vector turn(0., 0.);
+	for (int i = 0; i < Filter_Data::ROBOT_SAMPLES; ++i) {
+		const Robot_Percept& percept = robots[i % robots.size()];
+		Robot_Sample robot;
+		robot.fuettere_polarbaer(&noise, random_generator);
+		robot.fuettere_polarbaer(&turn, random_generator);
+		//any rotation if the percept has none
+		double rotation = percept.rotation_known ? percept.rotation + seed_rotation_spread * turn.x
+				: BSmart::pi * (2. * random_generator.uniform() - 1.);
+		robot.pos = BSmart::Pose(percept.x + seed_spread * noise.x, percept.y + seed_spread * noise.y,
+				BSmart::normalize(rotation));
+		robot.speed = speed;
+		robot.team = team;
+		robot.id = id;
+		robot.weighting = 1.;
+		samples.push_back(robot);
+	}
+	return samples;
+}
+
 void Particle_Filter::create_models() {
 	//ball
 	Ball_Sample ball_model;
@@ -416,42 +633,43 @@ void Particle_Filter::create_models() {
 		total_weight += it->weighting;
 	}
 
-	if (ball_model.pos.x == 0) {
-		std::cout << "ball_model.pos: " << ball_model.pos << std::endl;
-		std::cout << "total_weight: " << total_weight << std::endl;
-		int i = 0;
-		for (Ball_Sample_List::iterator it = ball_samples.begin(); it != ball_samples.end(); ++it) {
-			i++;
-		}
-	}
+	if (ball_model.pos.x == 0)
+		zero_ball_models.count();
 
 	ball_model.pos /= total_weight;
 	ball_model.speed /= total_weight;
 
 	//robots
-	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-			Robot_Sample robot_model;
-			total_weight = 0.000000001;
-
-			if (filter_data->get_robot_seen(team, id)) {
-				Robot_Sample_List robot_samples = filter_data->get_robot_samples(team, id);
-				for (Robot_Sample_List::iterator it = robot_samples.begin(); it != robot_samples.end(); ++it) {
-					robot_model.pos += it->pos * it->weighting;
-					robot_model.speed += it->speed * it->weighting;
-					total_weight += it->weighting;
-				}
-				robot_model.pos /= total_weight;
-				robot_model.speed /= total_weight;
-
-				robot_model.team = team;
-				robot_model.id = id;
-				//confidence
+	std::vector<BSmart::Int_Vector> active_robots = filter_data->get_active_robots();
+	for (unsigned int r = 0; r < active_robots.size(); ++r) {
+		int team = active_robots[r].x;
+		int id = active_robots[r].y;
+		if (kalman_robots) {
+			if (robot_tracker.valid(team, id)) {
+				Robot_Sample robot_model = robot_tracker.model(team, id);
 				filter_data->set_robot_model(team, id, robot_model);
-
 				robot_models.push_back(robot_model);
 			}
+			continue;
+		}
+		Robot_Sample robot_model;
+		total_weight = 0.000000001;
+
+		Robot_Sample_List robot_samples = filter_data->get_robot_samples(team, id);
+		for (Robot_Sample_List::iterator it = robot_samples.begin(); it != robot_samples.end(); ++it) {
+			robot_model.pos += it->pos * it->weighting;
+			robot_model.speed += it->speed * it->weighting;
+			total_weight += it->weighting;
 		}
+		robot_model.pos /= total_weight;
+		robot_model.speed /= total_weight;
+
+		robot_model.team = team;
+		robot_model.id = id;
+		//confidence
+		filter_data->set_robot_model(team, id, robot_model);
+
+		robot_models.push_back(robot_model);
 	}
 
 	//Find last touched and ball status
@@ -465,6 +683,7 @@ void Particle_Filter::create_models() {
 
 	filter_data->set_timestamp(BSmart::Systemcall::get_current_system_time());
 	filter_data->set_frame(newest_frame);
+	filter_data->publish_world_snapshot();
 }
 
 void Particle_Filter::determine_ball_status(const Ball_Sample& new_ball_model) {
@@ -475,12 +694,15 @@ void Particle_Filter::determine_ball_status(const Ball_Sample& new_ball_model) {
 	double speed_after = ball_direction_after.abs();
 	double speed_diff_percept = speed_after - speed_before;
 	double speed_diff_model = new_ball_model.speed.abs() - last_ball_model.speed.abs();
-	double angle_to = acos(
-			((ball_direction_before.x * ball_direction_after.x + ball_direction_before.y * ball_direction_after.y)
-					/ (ball_direction_before.abs() * ball_direction_after.abs()))) / BSmart::pi * 180;
-	if (std::isnan(angle_to)) {
-		angle_to = 0.;
-	}
+	//turned by more than 10 or 60 degrees, from the dot product
+	const bool turned_10 = BSmart::angle_greater(ball_direction_before, ball_direction_after, COS_10_DEGREES);
+	const bool turned_60 = BSmart::angle_greater(ball_direction_before, ball_direction_after, COS_60_DEGREES);
+
+	const double radius = BSmart::Field::robot_radius + BSmart::Field::ball_radius;
+	const BSmart::Double_Vector new_ball_pos(new_ball_model.pos.x, new_ball_model.pos.y);
+	BSmart::Circle_Batch robots;
+	for (unsigned int k = 0; k < robot_models.size(); ++k)
+		robots.add(robot_models[k].pos.x, robot_models[k].pos.y, radius);
 
 	int new_ball_status = -1;
 	int new_ball_last_touched = -1;
@@ -505,40 +727,29 @@ void Particle_Filter::determine_ball_status(const Ball_Sample& new_ball_model) {
 	//Ball shot
 	if ((speed_diff_percept > 1. || speed_diff_model > 1.) && (ball_lying_counter <= 0)) {
 		last_touched_dist_tmp = std::numeric_limits<double>::max();
-		for (Robot_Sample_List::const_iterator it = robot_models.begin(); it != robot_models.end(); it++) {
-			circle.x = it->pos.x;
-			circle.y = it->pos.y;
-			ball_line.p1.x = new_ball_model.pos.x;
-			ball_line.p1.y = new_ball_model.pos.y;
-			ball_line.p2.x = new_ball_model.pos.x + ball_direction_after.x; //2d
-			ball_line.p2.y = new_ball_model.pos.y + ball_direction_after.y; //2d
-			intersections.clear();
-			if (test_intersection(circle, ball_line)) {
-				if (intersection_point(circle, ball_line, intersections)) {
-					for (unsigned int j = 0; j < intersections.size(); ++j) {
-						if (new_ball_model.pos.distance_to_2D(intersections[j])
-								< new_ball_model.pos.distance_to_2D(it->pos)) {
-							BSmart::Pose dir_intersect_to_new_ball_pos = BSmart::Pose(
-									new_ball_model.pos.x - intersections[j].x,
-									new_ball_model.pos.y - intersections[j].y);
-							double collision_angle = acos(
-									((dir_intersect_to_new_ball_pos.x * ball_direction_after.x
-											+ dir_intersect_to_new_ball_pos.y * ball_direction_after.y)
-											/ (dir_intersect_to_new_ball_pos.abs() * ball_direction_after.abs())))
-									/ BSmart::pi * 180;
-							if (collision_angle < 1.) {
-								if (new_ball_model.pos.distance_to_2D(intersections[j]) < last_touched_dist_tmp) {
-									last_touched_dist_tmp = new_ball_model.pos.distance_to_2D(intersections[j]);
-									intersect = true;
-									last_contact.frame = newest_frame;
-									last_contact.robot.x = it->team;
-									last_contact.robot.y = it->id;
-									last_contact.timestamp = timestamp;
-									last_contact.type = 4; //Sample::KICKED
-								}
-							}
-						}
-					}
+		ball_line.p1 = new_ball_pos;
+		ball_line.p2 = new_ball_pos + ball_direction_after; //2d
+		const BSmart::Batch_Intersections hits = BSmart::intersection_points(ball_line, robots);
+		for (int i = 0; i < hits.size; ++i) {
+			if (!(hits.crossing & (1u << i)))
+				continue;
+			const Robot_Sample& robot = robot_models[i];
+			const BSmart::Double_Vector to_robot(robot.pos.x - new_ball_pos.x, robot.pos.y - new_ball_pos.y);
+			const double s[2] = { hits.second[i], hits.first[i] };
+			for (int j = 0; j < 2; ++j) {
+				const BSmart::Double_Vector to_ball(ball_direction_after * -s[j]);
+				const double dist2 = to_ball * to_ball;
+				//behind the ball, closer than the robot
+				if (dist2 < to_robot * to_robot
+						&& BSmart::angle_smaller(to_ball, ball_direction_after, COS_1_DEGREE)
+						&& dist2 < last_touched_dist_tmp * last_touched_dist_tmp) {
+					last_touched_dist_tmp = sqrt(dist2);
+					intersect = true;
+					last_contact.frame = newest_frame;
+					last_contact.robot.x = robot.team;
+					last_contact.robot.y = robot.id;
+					last_contact.timestamp = timestamp;
+					last_contact.type = 4; //Sample::KICKED
 				}
 			}
 		}
@@ -546,71 +757,66 @@ void Particle_Filter::determine_ball_status(const Ball_Sample& new_ball_model) {
 	//ball lying and then shot
 	if ((ball_lying_counter == -1) && !intersect) {
 		last_touched_dist_tmp = std::numeric_limits<double>::max();
-		for (Robot_Sample_List::const_iterator it = robot_models.begin(); it != robot_models.end(); it++) {
-			if (last_ball_model.pos.distance_to_2D(it->pos)
-					< (BSmart::Field::robot_radius + BSmart::Field::ball_radius + 50)) {
-				last_touched_dist_tmp = new_ball_model.pos.distance_to_2D(it->pos) - BSmart::Field::robot_radius
-						- BSmart::Field::ball_radius;
-				intersect = true;
-				last_contact.frame = newest_frame;
-				last_contact.robot.x = it->team;
-				last_contact.robot.y = it->id;
-				last_contact.timestamp = timestamp;
-
-				if (new_ball_model.speed.abs() > 0.6 || speed_after > 0.6) {
-					last_contact.type = 4; //Sample::KICKED
-				} else {
-					last_contact.type = 5; //Sample::BOUNCED
-				}
-				last_contact.lying_shot = true;
+		const unsigned int near = BSmart::centers_within(
+				BSmart::Double_Vector(last_ball_model.pos.x, last_ball_model.pos.y), robots, radius + 50);
+		for (int i = 0; i < robots.size; ++i) {
+			if (!(near & (1u << i)))
+				continue;
+			const Robot_Sample& robot = robot_models[i];
+			last_touched_dist_tmp = new_ball_model.pos.distance_to_2D(robot.pos) - radius;
+			intersect = true;
+			last_contact.frame = newest_frame;
+			last_contact.robot.x = robot.team;
+			last_contact.robot.y = robot.id;
+			last_contact.timestamp = timestamp;
 
+			if (new_ball_model.speed.abs() > 0.6 || speed_after > 0.6) {
+				last_contact.type = 4; //Sample::KICKED
+			} else {
+				last_contact.type = 5; //Sample::BOUNCED
 			}
+			last_contact.lying_shot = true;
 		}
 
 	}
 	//ball touched or bounced
-	if ((fabs(speed_diff_percept) > 1 || fabs(speed_diff_model) > 1 || angle_to > 10) && (ball_lying_counter <= 0)
+	if ((fabs(speed_diff_percept) > 1 || fabs(speed_diff_model) > 1 || turned_10) && (ball_lying_counter <= 0)
 			&& !intersect) {
 		last_touched_dist_tmp = std::numeric_limits<double>::max();
-		for (Robot_Sample_List::const_iterator it = robot_models.begin(); it != robot_models.end(); it++) {
-			if (new_ball_model.pos.distance_to_2D(it->pos)
-					< (BSmart::Field::robot_radius + BSmart::Field::ball_radius + 100)) {
-				circle.x = it->pos.x;
-				circle.y = it->pos.y;
-				ball_line.p1.x = last_ball_model.pos.x;
-				ball_line.p1.y = last_ball_model.pos.y;
-				ball_line.p2.x = last_ball_model.pos.x + ball_direction_before.x; //2d
-				ball_line.p2.y = last_ball_model.pos.y + ball_direction_before.y; //2d
-				intersections.clear();
-				if (test_intersection(circle, ball_line)) {
-					if (intersection_point(circle, ball_line, intersections)) {
-						for (unsigned int j = 0; j < intersections.size(); ++j) {
-							if (new_ball_model.pos.distance_to_2D(intersections[j]) < last_touched_dist_tmp) {
-								last_touched_dist_tmp = new_ball_model.pos.distance_to_2D(intersections[j]);
-
-								intersect = true;
-								last_contact.frame = newest_frame;
-								last_contact.robot.x = it->team;
-								last_contact.robot.y = it->id;
-								last_contact.timestamp = timestamp;
-								last_contact.type = 5; //Sample::BOUNCED
-							}
-						}
-					}
+		ball_line.p1 = BSmart::Double_Vector(last_ball_model.pos.x, last_ball_model.pos.y);
+		ball_line.p2 = ball_line.p1 + ball_direction_before; //2d
+		const BSmart::Batch_Intersections hits = BSmart::intersection_points(ball_line, robots);
+		const unsigned int near = BSmart::centers_within(new_ball_pos, robots, radius + 100);
+		for (int i = 0; i < hits.size; ++i) {
+			if (!(near & hits.crossing & (1u << i)))
+				continue;
+			const double s[2] = { hits.second[i], hits.first[i] };
+			for (int j = 0; j < 2; ++j) {
+				const BSmart::Double_Vector to_point(ball_line.p1 + ball_direction_before * s[j] - new_ball_pos);
+				const double dist2 = to_point * to_point;
+				if (dist2 < last_touched_dist_tmp * last_touched_dist_tmp) {
+					last_touched_dist_tmp = sqrt(dist2);
+
+					intersect = true;
+					last_contact.frame = newest_frame;
+					last_contact.robot.x = robot_models[i].team;
+					last_contact.robot.y = robot_models[i].id;
+					last_contact.timestamp = timestamp;
+					last_contact.type = 5; //Sample::BOUNCED
 				}
 			}
 		}
 	}
 	// if angle greater than 60° then guaranteed collision
-	if (angle_to > 60 && !intersect && !ball_lying_counter) {
+	if (turned_60 && !intersect && !ball_lying_counter) {
 		last_touched_dist_tmp = std::numeric_limits<double>::max();
-		for (Robot_Sample_List::const_iterator it = robot_models.begin(); it != robot_models.end(); it++) {
-			if (new_ball_model.pos.distance_to_2D(it->pos)
-					< (BSmart::Field::robot_radius + BSmart::Field::ball_radius + 40)) {
+		const unsigned int near = BSmart::centers_within(new_ball_pos, robots, radius + 40);
+		for (int i = 0; i < robots.size; ++i) {
+			if (near & (1u << i)) {
 				intersect = true;
 				last_contact.frame = newest_frame;
-				last_contact.robot.x = it->team;
-				last_contact.robot.y = it->id;
+				last_contact.robot.x = robot_models[i].team;
+				last_contact.robot.y = robot_models[i].id;
 				last_contact.timestamp = timestamp;
 				last_contact.type = 5; //Sample::BOUNCED
 			}
@@ -625,11 +831,12 @@ void Particle_Filter::determine_ball_status(const Ball_Sample& new_ball_model) {
 	//Ball flying and not touching robot
 	//last contacts DELETE?
 	bool flying = false;
-	for (Robot_Sample_List::const_iterator it = robot_models.begin(); it != robot_models.end(); it++) {
-		if (new_ball_model.pos.distance_to_2D(it->pos) < (BSmart::Field::robot_radius)) {
+	const unsigned int under = BSmart::centers_within(new_ball_pos, robots, BSmart::Field::robot_radius);
+	for (int i = 0; i < robots.size; ++i) {
+		if (under & (1u << i)) {
 			last_contact.frame = newest_frame;
-			last_contact.robot.x = it->team;
-			last_contact.robot.y = it->id;
+			last_contact.robot.x = robot_models[i].team;
+			last_contact.robot.y = robot_models[i].id;
 			last_contact.timestamp = timestamp;
 			flying_robots.push_back(last_contact);
 			flying = true;
@@ -760,5 +967,5 @@ double Particle_Filter::gaussian(double v, double std_dev) {
 }
 
 int Particle_Filter::random_number(int bottom, int top) {
-	return bottom + (rand() % (top - bottom + 1));
+	return bottom + (random_generator.next() % (top - bottom + 1));
 }
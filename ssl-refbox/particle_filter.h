@@ -7,8 +7,12 @@
 
 #include "pre_filter_data.h"
 #include "filter_data.h"
+#include "filter_parameters.h"
+#include "kalman_robot_tracker.h"
+#include "percept_log.h"
 #include <libbsmart/field.h>
 #include <libbsmart/systemcall.h>
+#include <log4cxx/logger.h>
 
 struct Last_Contact
 {
@@ -26,8 +30,11 @@ class Particle_Filter_Mother : public QThread
     Q_OBJECT
 
 public:
-    Particle_Filter_Mother(Pre_Filter_Data*, Filter_Data*, QWaitCondition*, QWaitCondition*);
+    Particle_Filter_Mother(Pre_Filter_Data*, Filter_Data*, QWaitCondition*, QWaitCondition*,
+                           const Filter_Parameters&);
     ~Particle_Filter_Mother();
+    //record_percepts from config
+    bool set_percept_log(const std::string& file);
     void connectActions();
     void run();
 
@@ -39,8 +46,24 @@ public slots:
     void new_frame();
 
 private:
+    enum {
+        //cycles within half the budget before the quality goes up again
+        RECOVER_CYCLES = 120
+    };
+
+    static log4cxx::LoggerPtr logger;
+
+    //quality down on a cycle over the budget, up after RECOVER_CYCLES relaxed ones
+    void keep_budget(long long cycle_us);
+
     Particle_Filter* pf;
+    long long cycle_budget_us;
+    int relaxed_cycles;
+    Pre_Filter_Data* pf_data;
+    //percepts of the running cycle, the filter and the percept log read only these
+    Pre_Filter_Data cycle_data;
     Filter_Data* filter_data;
+    Percept_Log percept_log;
     QWaitCondition* new_data_wait_condition;
     bool new_data;
     QWaitCondition* rules_wait_condition;
@@ -49,12 +72,42 @@ private:
 class Particle_Filter : public QObject
 {
     Q_OBJECT
+    //times weight_ball
+    friend class Micro_Benchmark;
 
 public:
-    Particle_Filter(Pre_Filter_Data*, Filter_Data*);
+    //degradation under load, every level includes the ones before
+    enum Quality {
+        QUALITY_FULL,
+        //half of the ball samples
+        QUALITY_FEWER_BALL_SAMPLES,
+        //robots without percepts in the last cycle are not moved
+        QUALITY_MOVE_SEEN_ROBOTS,
+        //no collisions between robots, the ball only against robots near it
+        QUALITY_COARSE_COLLISIONS,
+        QUALITY_LEVELS
+    };
+
+    enum {
+        //mm around the ball model for QUALITY_COARSE_COLLISIONS
+        COARSE_COLLISION_DISTANCE = 1000,
+        //random_seed of --regress and --sweep
+        REPLAY_RANDOM_SEED = 1
+    };
+
+    //replays take a fixed random_seed, so every run gives the same models
+    Particle_Filter(Pre_Filter_Data*, Filter_Data*, const Filter_Parameters&, unsigned int random_seed);
     ~Particle_Filter();
 
+    void set_quality(Quality quality_) { quality = quality_; }
+    Quality get_quality() const { return quality; }
+
+    //moves by the time since the last call
     void motion_update();
+    //moves by ms, for replays
+    void motion_update(double ms);
+    //ms of the last motion update
+    double get_time_diff();
 
     void sensor_update(); // update weighting
     void resample();
@@ -68,8 +121,15 @@ private:
     Pre_Filter_Data* pf_data;
     Filter_Data* filter_data;
 
+    Quality quality;
+
+    //robots by Kalman filter instead of particles
+    bool kalman_robots;
+    Kalman_Robot_Tracker robot_tracker;
+
     //Timestamps for movement
     double last_movement;
+    double time_diff;
     double ball_distance_threshold;
     double std_dev_ball;
     double std_dev_robot;
@@ -85,6 +145,16 @@ private:
     double o_slow_robots[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
     double o_fast_robots[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
 
+    //seeding at the percepts: first percept, reappearance, teleport
+    double seed_spread;
+    double seed_rotation_spread;
+    double reseed_distance;
+    double reseed_ms;
+    bool ball_seeded;
+    double ball_unseen_ms;
+    bool robot_seeded[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+    double robot_unseen_ms[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+
     //for better runtime
     //resampling
     Ball_Sample_List ball_samples_old;
@@ -103,8 +173,6 @@ private:
     int ball_lying_counter;
     Robot_Sample_List robot_obstacles;
     BSmart::Line ball_line;
-    BSmart::Circle circle;
-    std::vector<BSmart::Double_Vector> intersections;
 //    BSmart::Int_Vector last_touched_tmp;
     double last_touched_dist_tmp;
     int newest_frame;
@@ -117,6 +185,9 @@ private:
     int ball_last_touched_saved; //Sample::Last_Touched
     int ball_status_saved; //Sample::Status
 
+    //BALL_SAMPLES or less for the quality
+    int ball_sample_count() const;
+
     Ball_Sample random_ball_sample();
     BSmart::Pose3D get_random_pos_3d(int min_x = -(BSmart::Field::half_field_width + BSmart::Field::off_width) , int max_x = BSmart::Field::half_field_width + BSmart::Field::off_width, int min_y = - (BSmart::Field::half_field_height + BSmart::Field::off_width), int max_y = BSmart::Field::half_field_height  + BSmart::Field::off_width, int min_z = 0, int max_z = 10);
     Sample::Status get_random_status();
@@ -124,6 +195,13 @@ private:
     Robot_Sample random_robot_sample();
     BSmart::Pose get_random_pos_2d(int min_x = -(BSmart::Field::half_field_width + BSmart::Field::off_width) , int max_x = BSmart::Field::half_field_width + BSmart::Field::off_width, int min_y = - (BSmart::Field::half_field_height + BSmart::Field::off_width), int max_y = BSmart::Field::half_field_height  + BSmart::Field::off_width);
 
+    //true if no percept is within reseed_distance of the model
+    bool teleported(const BSmart::Double_Vector& model, const Ball_Percept_List&);
+    bool teleported(const BSmart::Double_Vector& model, const Robot_Percept_List&);
+    //samples around the percepts with seed_spread
+    Ball_Sample_List seed_balls(const Ball_Percept_List&, const BSmart::Pose3D& speed);
+    Robot_Sample_List seed_robots(int team, int id, const Robot_Percept_List&, const BSmart::Pose& speed);
+
     bool weight_ball(Ball_Percept&);
     bool weight_robot(Robot_Percept&, int, int);
 
@@ -138,6 +216,7 @@ private:
     void print_robot_percept(Robot_Percept);
 
     int random_number(int bottom, int top);
+    Filter_Random random_generator;
 
 };
 
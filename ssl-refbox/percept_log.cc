@@ -0,0 +1,205 @@
+#include "percept_log.h"
+#include <cstring>
+
+// file format version 1
+const char Percept_Log::magic[8] = { 'S', 'S', 'L', 'P', 'C', 'T', '0', '1' };
+
+Percept_Log::Percept_Log() {
+}
+
+Percept_Log::~Percept_Log() {
+	close();
+}
+
+bool Percept_Log::open_write(const std::string& file) {
+	close();
+	out.open(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+	out.write(magic, sizeof(magic));
+	return out.good();
+}
+
+bool Percept_Log::open_read(const std::string& file) {
+	close();
+	in.open(file.c_str(), std::ios::in | std::ios::binary);
+	if (!in)
+		return false;
+	char header[sizeof(magic)];
+	in.read(header, sizeof(header));
+	if (!in || memcmp(header, magic, sizeof(magic)) != 0) {
+		in.close();
+		return false;
+	}
+	return true;
+}
+
+void Percept_Log::close() {
+	if (out.is_open())
+		out.close();
+	if (in.is_open())
+		in.close();
+}
+
+void Percept_Log::put(int value, int bytes) {
+	char buf[4];
+	for (int i = 0; i < bytes; ++i)
+		buf[i] = (char) ((value >> (8 * i)) & 0xff);
+	out.write(buf, bytes);
+}
+
+void Percept_Log::put_float(double value) {
+	float f = (float) value;
+	int bits;
+	memcpy(&bits, &f, sizeof(bits));
+	put(bits, 4);
+}
+
+bool Percept_Log::get(int& value, int bytes) {
+	unsigned char buf[4];
+	if (!in.read((char*) buf, bytes))
+		return false;
+	unsigned int tmp = 0;
+	for (int i = 0; i < bytes; ++i)
+		tmp |= (unsigned int) buf[i] << (8 * i);
+	// sign extension
+	if (bytes < 4 && (tmp & (1u << (8 * bytes - 1))))
+		tmp |= ~0u << (8 * bytes);
+	value = (int) tmp;
+	return true;
+}
+
+bool Percept_Log::get_float(double& value) {
+	int bits;
+	if (!get(bits, 4))
+		return false;
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	value = f;
+	return true;
+}
+
+/**
+ * one cycle:
+ * time_diff(f) timestamp(8) frame(4) ball direction before x,y(f) after x,y(f)
+ * per camera: position x,y,z(f), number of balls(2), each: x,y(f) confidence(4)
+ *   number of robots(1), each: team(1) id(1) direction x,y(f) number of percepts(1),
+ *   each: x,y,rotation(f) rotation known(1) confidence(4)
+ */
+void Percept_Log::write(Pre_Filter_Data& data, double time_diff) {
+	if (!out.is_open())
+		return;
+	BSmart::Time_Value timestamp = data.get_timestamp();
+	put_float(time_diff);
+	put((int) (timestamp & 0xffffffff), 4);
+	put((int) (timestamp >> 32), 4);
+	put(data.get_newest_frame(), 4);
+	BSmart::Pose before = data.get_ball_direction_before();
+	BSmart::Pose after = data.get_ball_direction_after();
+	put_float(before.x);
+	put_float(before.y);
+	put_float(after.x);
+	put_float(after.y);
+
+	for (int cam = 0; cam < 2; ++cam) {
+		BSmart::Pose3D cam_pos = data.get_camera_position(cam);
+		put_float(cam_pos.x);
+		put_float(cam_pos.y);
+		put_float(cam_pos.z);
+
+		Ball_Percept_List balls = data.get_current_balls(cam);
+		put(balls.size(), 2);
+		for (Ball_Percept_List::const_iterator it = balls.begin(); it != balls.end(); ++it) {
+			put_float(it->x);
+			put_float(it->y);
+			put(it->confidence, 4);
+		}
+
+		std::vector<BSmart::Int_Vector> robots = data.get_percepted_robots(cam);
+		put(robots.size(), 1);
+		for (unsigned int i = 0; i < robots.size(); ++i) {
+			int team = robots[i].x;
+			int id = robots[i].y;
+			BSmart::Pose direction = data.get_robot_direction(team, id);
+			Robot_Percept_List percepts = data.get_robots(cam, team, id);
+			put(team, 1);
+			put(id, 1);
+			put_float(direction.x);
+			put_float(direction.y);
+			put(percepts.size(), 1);
+			for (Robot_Percept_List::const_iterator it = percepts.begin(); it != percepts.end(); ++it) {
+				put_float(it->x);
+				put_float(it->y);
+				put_float(it->rotation);
+				put(it->rotation_known ? 1 : 0, 1);
+				put(it->confidence, 4);
+			}
+		}
+	}
+}
+
+bool Percept_Log::read(Pre_Filter_Data& data, double& time_diff) {
+	if (!in.is_open())
+		return false;
+	int low, high, value, count;
+	double x, y, z;
+	if (!get_float(time_diff) || !get(low, 4) || !get(high, 4))
+		return false;
+	data.set_timestamp(((BSmart::Time_Value) high << 32) | (unsigned int) low);
+	bool ok = get(value, 4);
+	data.set_newest_frame(value);
+	ok = ok && get_float(x) && get_float(y);
+	data.set_ball_direction_before(BSmart::Pose(x, y));
+	ok = ok && get_float(x) && get_float(y);
+	data.set_ball_direction_after(BSmart::Pose(x, y));
+
+	for (int cam = 0; ok && cam < 2; ++cam) {
+		ok = get_float(x) && get_float(y) && get_float(z);
+		data.reset_camera_pos(cam, BSmart::Pose3D(x, y, z));
+
+		Ball_Percept_List balls;
+		ok = ok && get(count, 2);
+		count &= 0xffff;
+		for (int i = 0; ok && i < count; ++i) {
+			Ball_Percept ball;
+			ok = get_float(x) && get_float(y) && get(value, 4);
+			ball.x = x;
+			ball.y = y;
+			ball.confidence = value;
+			ball.cam = cam;
+			balls.push_back(ball);
+		}
+		data.set_balls(cam, balls);
+
+		data.clear_robots(cam);
+		int robots = 0;
+		ok = ok && get(robots, 1);
+		robots &= 0xff;
+		for (int r = 0; ok && r < robots; ++r) {
+			int team, id;
+			ok = get(team, 1) && get(id, 1) && get_float(x) && get_float(y) && get(count, 1);
+			count &= 0xff;
+			if (!ok || team < 0 || team >= Filter_Data::NUMBER_OF_TEAMS || id < 0 || id >= Filter_Data::NUMBER_OF_IDS)
+				return false;
+			data.set_robot_direction(team, id, BSmart::Pose(x, y));
+			Robot_Percept_List percepts;
+			for (int i = 0; ok && i < count; ++i) {
+				double rotation;
+				int rotation_known;
+				Robot_Percept robot;
+				ok = get_float(x) && get_float(y) && get_float(rotation) && get(rotation_known, 1) && get(value, 4);
+				robot.x = x;
+				robot.y = y;
+				robot.rotation = rotation;
+				robot.rotation_known = rotation_known != 0;
+				robot.color = team == 1 ? SSLRefbox::Colors::BLUE : SSLRefbox::Colors::YELLOW;
+				robot.confidence = value;
+				robot.cam = cam;
+				robot.id = id;
+				percepts.push_back(robot);
+			}
+			data.set_robots(cam, team, id, percepts);
+		}
+	}
+	return ok;
+}
@@ -0,0 +1,41 @@
+#ifndef PERCEPT_LOG_H
+#define PERCEPT_LOG_H
+
+#include <fstream>
+#include <string>
+#include "pre_filter_data.h"
+
+/**
+ * @class Percept_Log
+ * @brief File of the input of every particle filter cycle: the percepts and
+ * heuristics in Pre_Filter_Data and the time the samples were moved.
+ * Replaying it runs the filter without vision and in any speed, see
+ * Parameter_Sweep. All numbers are little endian, fractions are floats.
+ */
+class Percept_Log
+{
+public:
+    Percept_Log();
+    ~Percept_Log();
+
+    bool open_write(const std::string& file);
+    bool open_read(const std::string& file);
+    void close();
+
+    void write(Pre_Filter_Data&, double time_diff);
+    //replaces the percepts in Pre_Filter_Data, false at the end of the file
+    bool read(Pre_Filter_Data&, double& time_diff);
+
+private:
+    static const char magic[8];
+
+    void put(int value, int bytes);
+    void put_float(double value);
+    bool get(int& value, int bytes);
+    bool get_float(double& value);
+
+    std::ofstream out;
+    std::ifstream in;
+};
+
+#endif //PERCEPT_LOG_H
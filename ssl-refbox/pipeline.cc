@@ -0,0 +1,40 @@
+#include "pipeline.h"
+
+Pipeline::Pipeline(const ConfigFile& config_, const QString& start_log) :
+	config(config_) {
+	rules_wait_condition = new QWaitCondition();
+	new_data_wait_condition = new QWaitCondition();
+	pf_data = new Pre_Filter_Data();
+	filter_data = new Filter_Data(config.read<int>("robot_ids", Filter_Data::NUMBER_OF_IDS));
+	Filter_Parameters parameters;
+	parameters.read(config);
+	filter_data->set_parameters(parameters);
+	gamestate = new BSmart::Game_States();
+	vision = new SSLVision(pf_data, gamestate, new_data_wait_condition, config, start_log);
+	refbox_listener = new RefboxListener(gamestate, config);
+	particle_filter = new Particle_Filter_Mother(pf_data, filter_data, rules_wait_condition, new_data_wait_condition,
+			parameters);
+	std::string percept_file = config.read<std::string>("record_percepts", "");
+	if (!percept_file.empty())
+		particle_filter->set_percept_log(percept_file);
+	pf_tester = new PF_Tester(pf_data, gamestate);
+	rules = new SSL_Refbox_Rules(rules_wait_condition, filter_data, gamestate, config);
+
+	QObject::connect(pf_tester, SIGNAL ( new_frame() ), particle_filter, SLOT ( new_frame() ));
+	QObject::connect(vision, SIGNAL ( new_refbox_cmd ( char ) ), refbox_listener,
+			SLOT ( new_refbox_cmd ( char ) ));
+}
+
+/**
+ * The threads run until the end of the process, like the GUI expects
+ */
+Pipeline::~Pipeline() {
+}
+
+void Pipeline::start() {
+	vision->start(); //34-36%
+	//    pf_tester->start(); //64%
+	refbox_listener->start(); //2%
+	particle_filter->start(); //67%
+	rules->start();
+}
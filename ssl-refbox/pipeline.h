@@ -0,0 +1,49 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <QWaitCondition>
+#include <QString>
+#include <libbsmart/game_states.h>
+#include "sslvision.h"
+#include "pre_filter_data.h"
+#include "refboxlistener.h"
+#include "filter_data.h"
+#include "particle_filter.h"
+#include "pf_tester.h"
+#include "ssl_refbox_rules.h"
+#include "../ConfigFile/ConfigFile.h"
+
+/**
+ * @class Pipeline
+ * @brief One refbox: vision, refbox listener, particle filter and rules with
+ * their data. Nothing is shared between pipelines but the process wide prolog
+ * (SSL_Refbox_Rules::init_prolog), the rules of every pipeline run in their
+ * own engine. Several pipelines in one process analyse several logs or fields
+ * at the same time.
+ */
+class Pipeline
+{
+public:
+    // start_log is played instead of live vision, if not empty
+    Pipeline(const ConfigFile&, const QString& start_log = "");
+    ~Pipeline();
+
+    // start all threads
+    void start();
+
+    // own copy, changes of the application config do not reach a running pipeline
+    const ConfigFile config;
+
+    QWaitCondition* rules_wait_condition;
+    QWaitCondition* new_data_wait_condition;
+    Pre_Filter_Data* pf_data;
+    BSmart::Game_States* gamestate;
+    SSLVision* vision;
+    RefboxListener* refbox_listener;
+    Filter_Data* filter_data;
+    Particle_Filter_Mother* particle_filter;
+    PF_Tester* pf_tester;
+    SSL_Refbox_Rules* rules;
+};
+
+#endif //PIPELINE_H
@@ -0,0 +1,83 @@
+#include "pipeline_replay.h"
+#include "particle_filter.h"
+#include "filter_parameters.h"
+#include <fstream>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Pipeline_Replay::logger(Logger::getLogger("Pipeline_Replay"));
+
+Pipeline_Replay::Pipeline_Replay(Filter_Data* filter_data_, BSmart::Game_States* gamestate_, const ConfigFile& config) :
+	filter_data(filter_data_), gamestate(gamestate_),
+	decoder(&pf_data, config.read<int>("robot_ids", Filter_Data::NUMBER_OF_IDS)), refbox_listener(gamestate_) {
+	next_frame = 0;
+	last_frame_received = 0;
+	Filter_Parameters parameters;
+	parameters.read(config);
+	filter_data->set_parameters(parameters);
+	pf = new Particle_Filter(&pf_data, filter_data, parameters, Particle_Filter::REPLAY_RANDOM_SEED);
+}
+
+Pipeline_Replay::~Pipeline_Replay() {
+	delete pf;
+}
+
+bool Pipeline_Replay::open(const std::string& file) {
+	std::ifstream input(file.c_str(), std::ios::in | std::ios::binary);
+	if (!input || !logs.ParseFromIstream(&input) || logs.log_size() == 0) {
+		LOG4CXX_ERROR( logger, "Could not read log file " + file);
+		return false;
+	}
+	next_frame = 0;
+	last_frame_received = 0;
+	return true;
+}
+
+/**
+ * The next filter cycle: frames are decoded until the decoder hands one over
+ * to the filter, at the end of the log the rest of its queue
+ */
+bool Pipeline_Replay::read(Tracked_State& state) {
+	Transformed_Percept trans_perc;
+	for (;;) {
+		bool end = next_frame >= logs.log_size();
+		if (!end) {
+			const Log_Frame& log_frame = logs.log(next_frame);
+			Vision_Decoder::reset_transformed_percept(trans_perc);
+			trans_perc.current_frame = next_frame++;
+			// only two cameras are tracked, as in SSLVision::execute
+			if (log_frame.frame().camera_id() > 1)
+				continue;
+			trans_perc.refbox_cmd = log_frame.refbox_cmd();
+			// capture time in ms instead of the time it is played
+			trans_perc.frame_received = (BSmart::Time_Value) (log_frame.frame().t_capture() * 1000);
+			decoder.decode(log_frame.frame(), trans_perc);
+			decoder.push(trans_perc);
+		}
+		if (decoder.pop(trans_perc, end))
+			break;
+		if (end)
+			return false;
+	}
+
+	if (!trans_perc.refbox_cmd.empty())
+		refbox_listener.new_refbox_cmd(trans_perc.refbox_cmd[0]);
+
+	// frames of two cameras may be out of order
+	double time_diff = 0.;
+	if (trans_perc.frame_received > last_frame_received) {
+		if (last_frame_received != 0)
+			time_diff = trans_perc.frame_received - last_frame_received;
+		last_frame_received = trans_perc.frame_received;
+	}
+	pf->motion_update(time_diff);
+	pf->sensor_update();
+	pf->resample();
+	pf->create_models();
+
+	state.world = filter_data->acquire_world_snapshot(Filter_Data::RULES_READER);
+	BSmart::Game_States::State game_state = gamestate->get_state();
+	state.play_state = game_state.play_state;
+	state.refbox_cmd = game_state.refbox_cmd;
+	return true;
+}
@@ -0,0 +1,51 @@
+#ifndef PIPELINE_REPLAY_H
+#define PIPELINE_REPLAY_H
+
+#include <string>
+#include <proto/messages_robocup_ssl_refbox_log.pb.h>
+#include <libbsmart/game_states.h>
+#include "tracked_state_log.h"
+#include "vision_decoder.h"
+#include "pre_filter_data.h"
+#include "refboxlistener.h"
+#include "../ConfigFile/ConfigFile.h"
+#include <log4cxx/logger.h>
+
+class Particle_Filter;
+
+/**
+ * @class Pipeline_Replay
+ * @brief Plays a log file recorded by SSLVision through the vision decoding,
+ * the referee commands and the particle filter, in the calling thread and as
+ * fast as possible. Every filter cycle is one Tracked_State for the rules,
+ * moved by the time between the frames as if the log was played at normal
+ * speed.
+ */
+class Pipeline_Replay : public Tracked_State_Source
+{
+public:
+    // filter_data and gamestate are shared with the rules
+    Pipeline_Replay(Filter_Data*, BSmart::Game_States*, const ConfigFile&);
+    ~Pipeline_Replay();
+
+    bool open(const std::string& file);
+    int get_frames() const { return logs.log_size(); }
+
+    bool read(Tracked_State&);
+
+private:
+    static log4cxx::LoggerPtr logger;
+
+    Refbox_Log logs;
+    int next_frame;
+    BSmart::Time_Value last_frame_received;
+
+    Pre_Filter_Data pf_data;
+    Filter_Data* filter_data;
+    BSmart::Game_States* gamestate;
+    Vision_Decoder decoder;
+    RefboxListener refbox_listener;
+    Particle_Filter* pf;
+};
+
+#endif //PIPELINE_REPLAY_H
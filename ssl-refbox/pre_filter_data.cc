@@ -7,11 +7,12 @@ Pre_Filter_Data::Pre_Filter_Data()
     QMutex pf_data_mutex();
     for ( int cam = 0; cam < 2; cam++ ) {
         for ( int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team ) {
-            for ( int id = 0; id < Filter_Data::NUMBER_OF_TEAMS; ++id ) {
+            for ( int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id ) {
                 robots[cam][team][id] = Robot_Percept_List();
                 robot_direction[team][id] = BSmart::Pose();
             }
         }
+        percepted_robots[cam].clear();
         current_balls[cam] = Ball_Percept_List();
         camera_pos[cam] = Camera_Position();
         camera_pos[cam].belief = 0;
@@ -25,6 +26,8 @@ Pre_Filter_Data::Pre_Filter_Data()
     ball_direction_before = BSmart::Pose ( 0., 0., 0. );
     ball_direction_after = BSmart::Pose ( 0., 0., 0. );
     newest_frame = 0;
+    received_us = 0;
+    queued_us = 0;
 }
 
 void Pre_Filter_Data::set_ball_framenumber ( int camID, unsigned int framenumber )
@@ -70,6 +73,8 @@ void Pre_Filter_Data::set_robots ( int camID, int team, int id,
                                    const Robot_Percept_List& pRobots )
 {
     pf_data_mutex.lock();
+    if ( robots[camID][team][id].empty() && !pRobots.empty() )
+        percepted_robots[camID].push_back ( BSmart::Int_Vector ( team, id ) );
     robots[camID][team][id] = pRobots;
     pf_data_mutex.unlock();
 }
@@ -77,11 +82,10 @@ void Pre_Filter_Data::set_robots ( int camID, int team, int id,
 void Pre_Filter_Data::clear_robots ( int camID )
 {
     pf_data_mutex.lock();
-    for ( int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team ) {
-        for ( int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id ) {
-            robots[camID][team][id].clear();
-        }
+    for ( unsigned int i = 0; i < percepted_robots[camID].size(); ++i ) {
+        robots[camID][percepted_robots[camID][i].x][percepted_robots[camID][i].y].clear();
     }
+    percepted_robots[camID].clear();
     pf_data_mutex.unlock();
 }
 
@@ -93,6 +97,14 @@ Robot_Percept_List Pre_Filter_Data::get_robots ( int camID, int team, int id )
     return tmp;
 }
 
+std::vector<BSmart::Int_Vector> Pre_Filter_Data::get_percepted_robots ( int camID )
+{
+    pf_data_mutex.lock();
+    std::vector<BSmart::Int_Vector> tmp = percepted_robots[camID];
+    pf_data_mutex.unlock();
+    return tmp;
+}
+
 void Pre_Filter_Data::set_camera_pos ( int camID, const BSmart::Pose3D& new_pos )
 {
     pf_data_mutex.lock();
@@ -119,6 +131,13 @@ void Pre_Filter_Data::set_camera_pos ( int camID, const BSmart::Pose3D& new_pos
     pf_data_mutex.unlock();
 }
 
+void Pre_Filter_Data::reset_camera_pos ( int camID, const BSmart::Pose3D& pos )
+{
+    pf_data_mutex.lock();
+    camera_pos[camID].cam_pos = pos;
+    pf_data_mutex.unlock();
+}
+
 BSmart::Pose3D Pre_Filter_Data::get_camera_position ( int camID )
 {
     pf_data_mutex.lock();
@@ -204,3 +223,53 @@ BSmart::Time_Value Pre_Filter_Data::get_timestamp()
     pf_data_mutex.unlock();
     return tmp;
 }
+
+void Pre_Filter_Data::set_latency_stamps ( long long received_us_, long long queued_us_ )
+{
+    pf_data_mutex.lock();
+    received_us = received_us_;
+    queued_us = queued_us_;
+    pf_data_mutex.unlock();
+}
+
+void Pre_Filter_Data::get_latency_stamps ( long long& received_us_, long long& queued_us_ )
+{
+    pf_data_mutex.lock();
+    received_us_ = received_us;
+    queued_us_ = queued_us;
+    pf_data_mutex.unlock();
+}
+
+void Pre_Filter_Data::copy_to ( Pre_Filter_Data& cycle )
+{
+    pf_data_mutex.lock();
+    cycle.pf_data_mutex.lock();
+    for ( int cam = 0; cam < 2; ++cam ) {
+        //only the lists of percepted robots are filled
+        for ( unsigned int i = 0; i < cycle.percepted_robots[cam].size(); ++i )
+            cycle.robots[cam][cycle.percepted_robots[cam][i].x][cycle.percepted_robots[cam][i].y].clear();
+        cycle.percepted_robots[cam] = percepted_robots[cam];
+        for ( unsigned int i = 0; i < percepted_robots[cam].size(); ++i ) {
+            int team = percepted_robots[cam][i].x;
+            int id = percepted_robots[cam][i].y;
+            cycle.robots[cam][team][id] = robots[cam][team][id];
+        }
+        cycle.current_balls[cam] = current_balls[cam];
+        cycle.camera_pos[cam] = camera_pos[cam];
+    }
+    for ( int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team ) {
+        for ( int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id )
+            cycle.robot_direction[team][id] = robot_direction[team][id];
+    }
+    cycle.cam_dist_threshhold = cam_dist_threshhold;
+    cycle.ball_direction_before = ball_direction_before;
+    cycle.ball_direction_after = ball_direction_after;
+    cycle.newest_frame = newest_frame;
+    cycle.timestamp = timestamp;
+    cycle.received_us = received_us;
+    cycle.queued_us = queued_us;
+    cycle.refbox_cmd = refbox_cmd;
+    cycle.play_state = play_state;
+    cycle.pf_data_mutex.unlock();
+    pf_data_mutex.unlock();
+}
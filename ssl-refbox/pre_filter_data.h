@@ -30,9 +30,13 @@ public:
     void set_robots(int camID, int team, int id, const Robot_Percept_List& pRobots);
     void clear_robots(int camID);
     Robot_Percept_List get_robots(int camID, int team, int id);
+    //(team, id) of all robots with percepts from this camera
+    std::vector<BSmart::Int_Vector> get_percepted_robots(int camID);
 
     //camera
     void set_camera_pos(int camID, const BSmart::Pose3D& new_pos);
+    //without averaging, for replays
+    void reset_camera_pos(int camID, const BSmart::Pose3D& pos);
     BSmart::Pose3D get_camera_position(int camID);
 
     //pre-filter ball heuristics
@@ -53,10 +57,18 @@ public:
     void set_timestamp(BSmart::Time_Value);
     BSmart::Time_Value get_timestamp();
 
+    //monotonic us when the newest frame was received and handed to the filter
+    void set_latency_stamps(long long received_us, long long queued_us);
+    void get_latency_stamps(long long& received_us, long long& queued_us);
+
+    //consistent copy of everything, the input of one filter cycle
+    void copy_to(Pre_Filter_Data& cycle);
+
 private:
     QMutex pf_data_mutex;
     Ball_Percept_List current_balls[2];
     Robot_Percept_List robots[2][Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+    std::vector<BSmart::Int_Vector> percepted_robots[2];
     Camera_Position camera_pos[2];
     int cam_dist_threshhold;
     BSmart::Pose ball_direction_before;
@@ -64,6 +76,8 @@ private:
     BSmart::Pose robot_direction[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
     int newest_frame;
     BSmart::Time_Value timestamp;
+    long long received_us;
+    long long queued_us;
     char refbox_cmd;
     BSmart::Game_States::Play_State play_state;
 };
@@ -16,15 +16,16 @@ LoggerPtr RefboxListener::logger ( Logger::getLogger ( "RefboxListener" ) );
  * @brief Initialize RefboxListener
  * Get IP and port from config file, open socket, init vars
  * @param gamestate_ BSmart::Game_States
+ * @param config settings of the pipeline
  */
-RefboxListener::RefboxListener ( BSmart::Game_States* gamestate_ ) :
+RefboxListener::RefboxListener ( BSmart::Game_States* gamestate_, const ConfigFile& config ) :
         gamestate ( gamestate_ )
 {
     socket = 0;
     string message = "";
 
-    string refbox_ip = Global::config.read<string> ( "refbox_ip", "224.5.23.1" );
-    uint16_t refbox_port = Global::config.read<uint16_t> ( "refbox_port", 10001 );
+    string refbox_ip = config.read<string> ( "refbox_ip", "224.5.23.1" );
+    uint16_t refbox_port = config.read<uint16_t> ( "refbox_port", 10001 );
 
     std::ostringstream o;
     if ( ! ( o << refbox_port ) )
@@ -50,6 +51,22 @@ RefboxListener::RefboxListener ( BSmart::Game_States* gamestate_ ) :
     has_new_data = false;
 }
 
+/**
+ * @brief Initialize RefboxListener without socket
+ * The commands are given with new_refbox_cmd, run() must not be started.
+ * @param gamestate_ BSmart::Game_States
+ */
+RefboxListener::RefboxListener ( BSmart::Game_States* gamestate_ ) :
+        gamestate ( gamestate_ )
+{
+    socket = 0;
+    buffer = 0;
+    buflen = 0;
+    has_new_data = false;
+    GameStatePacket none = { 0, 0, 0, 0, 0 };
+    gsp_last = none;
+}
+
 RefboxListener::~RefboxListener()
 {
 }
@@ -12,6 +12,7 @@
 #include <libbsmart/game_states.h>
 
 #include <log4cxx/logger.h>
+#include "../ConfigFile/ConfigFile.h"
 
 /**
  * @class RefboxListener
@@ -32,7 +33,9 @@ public:
         unsigned short time_remaining; // Seconds remaining for game stage
     };
 
-    RefboxListener(BSmart::Game_States*);
+    RefboxListener(BSmart::Game_States*, const ConfigFile&);
+    // without socket, only new_refbox_cmd, e.g. for replays of log files
+    explicit RefboxListener(BSmart::Game_States*);
     ~RefboxListener();
     void run();
 
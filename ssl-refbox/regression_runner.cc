@@ -0,0 +1,215 @@
+#include "regression_runner.h"
+#include "ssl_refbox_rules.h"
+#include "tracked_state_log.h"
+#include "pipeline_replay.h"
+#include "rule_profiler.h"
+#include "filter_data.h"
+#include <QDir>
+#include <QStringList>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <iterator>
+#include <cstdio>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Regression_Runner::logger(Logger::getLogger("Regression_Runner"));
+
+Regression_Runner::Regression_Runner(const ConfigFile& config_, const std::string& directory_, int jobs_) :
+	config(config_), directory(directory_), jobs(jobs_) {
+	update_baseline = false;
+	compare_engines = false;
+	next = 0;
+	if (jobs < 1)
+		jobs = QThread::idealThreadCount();
+	if (jobs < 1)
+		jobs = 1;
+}
+
+void Regression_Runner::set_update_baseline(bool update) {
+	update_baseline = update;
+}
+
+void Regression_Runner::set_compare_engines(bool compare) {
+	compare_engines = compare;
+}
+
+void Regression_Runner::Worker::run() {
+	for (;;) {
+		runner->mutex.lock();
+		if (runner->next >= runner->results.size()) {
+			runner->mutex.unlock();
+			return;
+		}
+		Result& result = runner->results[runner->next++];
+		runner->mutex.unlock();
+		runner->replay(result);
+	}
+}
+
+bool Regression_Runner::run(std::ostream& summary) {
+	// every log file (*.log) and every tracked state file of the directory
+	QDir dir(QString::fromStdString(directory));
+	QStringList files = dir.entryList(QDir::Files | QDir::Readable, QDir::Name);
+	Tracked_State_Log check;
+	results.clear();
+	for (QStringList::const_iterator it = files.begin(); it != files.end(); ++it) {
+		std::string file = dir.filePath(*it).toStdString();
+		bool log_file = it->endsWith(".log");
+		if (!log_file) {
+			if (!check.open_read(file))
+				continue;
+			check.close();
+		}
+		Result result;
+		result.file = file;
+		result.log_file = log_file;
+		result.ok = false;
+		result.frames = result.broken_rules = 0;
+		result.msec = 0;
+		result.differences = -1;
+		result.compared_checks = result.divergent_checks = 0;
+		results.push_back(result);
+	}
+	if (results.empty()) {
+		LOG4CXX_ERROR( logger, "No log or tracked state files in " + directory);
+		return false;
+	}
+
+	std::ostringstream o;
+	o << "Replaying " << results.size() << " files with " << jobs << " jobs";
+	LOG4CXX_INFO( logger, o.str());
+	long long start = Rule_Profiler::now();
+	next = 0;
+	std::vector<Worker*> workers;
+	for (int i = 0; i < jobs && i < (int) results.size(); ++i) {
+		workers.push_back(new Worker(this));
+		workers.back()->start();
+	}
+	for (unsigned int i = 0; i < workers.size(); ++i) {
+		workers[i]->wait();
+		delete workers[i];
+	}
+	long long msec = (Rule_Profiler::now() - start) / 1000;
+
+	// file frames ms frames/s broken_rules differences
+	bool passed = true;
+	long long frames = 0;
+	for (std::vector<Result>::const_iterator it = results.begin(); it != results.end(); ++it) {
+		summary << std::left << std::setw(40) << it->file << std::right;
+		if (!it->ok) {
+			summary << " failed" << std::endl;
+			passed = false;
+			continue;
+		}
+		frames += it->frames;
+		summary << std::setw(10) << it->frames << " frames" << std::setw(8) << it->msec << " ms" << std::setw(10)
+				<< (it->msec > 0 ? it->frames * 1000LL / it->msec : 0) << " frames/s" << std::setw(6)
+				<< it->broken_rules << " rules";
+		if (compare_engines) {
+			summary << std::setw(6) << it->divergent_checks << " of " << it->compared_checks << " checks differ";
+			if (it->divergent_checks > 0)
+				passed = false;
+		} else if (update_baseline) {
+			summary << "  baseline written";
+		} else if (it->differences < 0) {
+			summary << "  no baseline";
+		} else {
+			summary << std::setw(6) << it->differences << " differences";
+			if (it->differences > 0)
+				passed = false;
+		}
+		summary << std::endl;
+		for (std::vector<std::string>::const_iterator line = it->diff.begin(); line != it->diff.end(); ++line)
+			summary << "    " << *line << std::endl;
+	}
+	summary << results.size() << " files, " << frames << " frames in " << msec << " ms" << std::endl;
+	return passed;
+}
+
+void Regression_Runner::replay(Result& result) {
+	// both engines, prolog decides and every divergence is logged
+	ConfigFile replay_config(config);
+	if (compare_engines)
+		replay_config.add("rule_engine", std::string("compare"));
+
+	// one pipeline, a tracked state file skips vision and particle filter
+	Filter_Data filter_data(replay_config.read<int>("robot_ids", Filter_Data::NUMBER_OF_IDS));
+	BSmart::Game_States gamestate;
+	SSL_Refbox_Rules rules(NULL, &filter_data, &gamestate, replay_config);
+	Pipeline_Replay pipeline(&filter_data, &gamestate, replay_config);
+	std::ofstream report;
+	std::ostream* report_stream = compare_engines ? NULL : &report;
+	if (result.log_file) {
+		if (!pipeline.open(result.file))
+			return;
+		rules.set_replay(&pipeline, report_stream);
+	} else if (!rules.set_replay(result.file, report_stream)) {
+		return;
+	}
+
+	// written next to it and renamed at the end, a failed replay keeps the old report and baseline
+	std::string report_file = result.file + (update_baseline ? ".baseline" : ".report");
+	std::string temp_file = report_file + ".tmp";
+	if (report_stream) {
+		report.open(temp_file.c_str());
+		if (!report) {
+			LOG4CXX_ERROR( logger, "Could not write " + temp_file);
+			return;
+		}
+	}
+	long long start = Rule_Profiler::now();
+	rules.run();
+	result.msec = (Rule_Profiler::now() - start) / 1000;
+	result.frames = rules.get_replay_frames();
+	result.broken_rules = rules.get_replay_broken_rules();
+	if (!report_stream) {
+		result.compared_checks = rules.get_compared_checks();
+		result.divergent_checks = rules.get_divergent_checks();
+		result.ok = true;
+		return;
+	}
+	report.close();
+	if (!report || std::rename(temp_file.c_str(), report_file.c_str()) != 0) {
+		LOG4CXX_ERROR( logger, "Could not write " + report_file);
+		std::remove(temp_file.c_str());
+		return;
+	}
+	result.ok = true;
+
+	std::vector<std::string> report_lines, baseline_lines;
+	if (update_baseline || !read_lines(result.file + ".baseline", baseline_lines))
+		return;
+	read_lines(report_file, report_lines);
+	compare(report_lines, baseline_lines, result.diff);
+	result.differences = result.diff.size();
+}
+
+void Regression_Runner::compare(const std::vector<std::string>& report, const std::vector<std::string>& baseline,
+		std::vector<std::string>& diff) {
+	// the lines carry their frame, the order of the differences does not matter
+	std::vector<std::string> new_lines(report), old_lines(baseline);
+	std::sort(new_lines.begin(), new_lines.end());
+	std::sort(old_lines.begin(), old_lines.end());
+	std::vector<std::string> added, removed;
+	std::set_difference(new_lines.begin(), new_lines.end(), old_lines.begin(), old_lines.end(),
+			std::back_inserter(added));
+	std::set_difference(old_lines.begin(), old_lines.end(), new_lines.begin(), new_lines.end(),
+			std::back_inserter(removed));
+	for (std::vector<std::string>::const_iterator it = removed.begin(); it != removed.end(); ++it)
+		diff.push_back("- " + *it);
+	for (std::vector<std::string>::const_iterator it = added.begin(); it != added.end(); ++it)
+		diff.push_back("+ " + *it);
+}
+
+bool Regression_Runner::read_lines(const std::string& file, std::vector<std::string>& lines) {
+	std::ifstream in(file.c_str());
+	if (!in)
+		return false;
+	std::string line;
+	while (std::getline(in, line))
+		lines.push_back(line);
+	return true;
+}
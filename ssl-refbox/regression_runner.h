@@ -0,0 +1,83 @@
+#ifndef REGRESSION_RUNNER_H
+#define REGRESSION_RUNNER_H
+
+#include <QMutex>
+#include <QThread>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "../ConfigFile/ConfigFile.h"
+#include <log4cxx/logger.h>
+
+/**
+ * @class Regression_Runner
+ * @brief Replays all log files (*.log, recorded by SSLVision) of a directory
+ * through vision decoding, particle filter and rules (Pipeline_Replay), and
+ * all tracked state files (record_tracked_state) through the rules only.
+ * Several files run at the same time, each in its own thread and prolog
+ * engine.
+ * The report of <file> (see SSL_Refbox_Rules::set_replay) is written to
+ * <file>.report and compared with <file>.baseline, if there is one.
+ * With set_compare_engines every file runs with rule_engine=compare instead,
+ * a file fails if the native rules differ from prolog in any check.
+ */
+class Regression_Runner
+{
+public:
+    Regression_Runner(const ConfigFile&, const std::string& directory, int jobs);
+
+    // write the reports as new baselines instead of comparing
+    void set_update_baseline(bool);
+    // run both rule engines instead of writing and comparing reports
+    void set_compare_engines(bool);
+
+    // summary with one line per file, false if a file failed or differs from its baseline
+    bool run(std::ostream& summary);
+
+private:
+    struct Result {
+        std::string file;
+        // false: tracked state file
+        bool log_file;
+        bool ok;
+        int frames;
+        int broken_rules;
+        long long msec;
+        // -1: no baseline
+        int differences;
+        // checks of both engines with set_compare_engines
+        int compared_checks;
+        int divergent_checks;
+        std::vector<std::string> diff;
+    };
+
+    class Worker : public QThread
+    {
+    public:
+        Worker(Regression_Runner* runner_) : runner(runner_) {}
+        void run();
+    private:
+        Regression_Runner* runner;
+    };
+
+    static log4cxx::LoggerPtr logger;
+
+    void replay(Result&);
+    // lines of the report missing in the baseline (+) and the other way (-)
+    static void compare(const std::vector<std::string>& report, const std::vector<std::string>& baseline,
+                        std::vector<std::string>& diff);
+    static bool read_lines(const std::string& file, std::vector<std::string>& lines);
+
+    const ConfigFile& config;
+    std::string directory;
+    int jobs;
+    bool update_baseline;
+    bool compare_engines;
+
+    // next file for the workers
+    QMutex mutex;
+    std::vector<Result> results;
+    unsigned int next;
+};
+
+#endif //REGRESSION_RUNNER_H
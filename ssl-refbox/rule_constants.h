@@ -0,0 +1,37 @@
+#ifndef RULE_CONSTANTS_H
+#define RULE_CONSTANTS_H
+
+/**
+ * @class Rule_Constants
+ * @brief Distances (mm), times (s) and speeds (m/s) of the laws, given to
+ * define_constants of the prolog rules and used by Native_Rules, so both
+ * engines check the same values.
+ */
+class Rule_Constants
+{
+public:
+    enum {
+        OPPONENTS_BEFORE_KICK_OFF = 500,    //law 8
+        BALL_OUT_OF_PLAY = 500,             //law 9
+        OPPONENT_AT_DEF_AREA = 200,         //law 9
+        BALL_NOT_ENTER_IN_TIME = 10,        //law 9
+        BALL_NOT_ENTER_DIST = 500,          //law 9
+        DRIBBLING_TOO_MUCH = 500,           //law 12
+        BALL_TOO_HIGH_INTO_GOAL = 150,      //law 12
+        BALL_SPEED = 8,                     //law 12
+        FREE_KICK_IN_DEF_AREA_FROM_GOAL = 600,  //law 13
+        FREE_KICK_IN_DEF_AREA_FROM_TOUCH = 100, //law 13
+        FREE_KICK_IN_DEF_AREA_ATTACK = 700, //law 13
+        FREE_KICK_OTHER_ROB = 500,          //law 13
+        PENALTY_KICK_OTHER_ROB = 400,       //law 14
+        THROW_IN = 100,                     //law 15
+        THROW_IN_OTHER_ROB = 500,           //law 15
+        GOAL_KICK_FROM_LINE = 500,          //law 16
+        GOAL_KICK_FROM_TOUCH = 100,         //law 16
+        GOAL_KICK_OPP_ROB = 500,            //law 16
+        CORNER_KICK = 100,                  //law 17
+        CORNER_KICK_OPP_ROB = 500           //law 17
+    };
+};
+
+#endif //RULE_CONSTANTS_H
@@ -0,0 +1,127 @@
+#include "rule_memo.h"
+#include <cmath>
+#include <libbsmart/field.h>
+
+Rule_Memo::Rule_Memo() {
+	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
+		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
+			robots[team][id].seen = false;
+			robots[team][id].valid = false;
+		}
+	}
+	ball_valid = false;
+	ball_x = ball_y = ball_z = 0;
+	ball_in_field = true;
+	ball_in_goal[0] = ball_in_goal[1] = false;
+	recomputed = 0;
+}
+
+/**
+ * Take over a new snapshot. Positions are truncated to integer like the
+ * values the prolog rules work with, so results are exactly the same.
+ */
+void Rule_Memo::update(const World_Snapshot& world) {
+	static const int half_width = BSmart::Field::field_width / 2;
+	static const int half_height = BSmart::Field::field_height / 2;
+	static const int half_goal_width = BSmart::Field::goal_width / 2;
+
+	int x = (int) world.ball_model.pos.x;
+	int y = (int) world.ball_model.pos.y;
+	int z = (int) world.ball_model.pos.z;
+	bool ball_moved = !ball_valid || x != ball_x || y != ball_y || z != ball_z;
+	if (ball_moved) {
+		ball_x = x;
+		ball_y = y;
+		ball_z = z;
+		ball_valid = true;
+		ball_in_field = x > -half_width && x < half_width && y > -half_height && y < half_height;
+		bool in_goal_width = y > -half_goal_width && y < half_goal_width && z < BSmart::Field::goal_height;
+		ball_in_goal[0] = in_goal_width && x < -half_width && x > -(half_width + BSmart::Field::goal_depth);
+		ball_in_goal[1] = in_goal_width && x > half_width && x < (half_width + BSmart::Field::goal_depth);
+	}
+
+	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team)
+		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id)
+			robots[team][id].seen = false;
+
+	recomputed = 0;
+	for (Robot_Sample_List::const_iterator it = world.robot_models.begin(); it != world.robot_models.end(); ++it) {
+		Robot_Entry& entry = robots[it->team][it->id];
+		x = (int) it->pos.x;
+		y = (int) it->pos.y;
+		entry.seen = true;
+		bool moved = !entry.valid || x != entry.x || y != entry.y;
+		if (moved) {
+			entry.x = x;
+			entry.y = y;
+			entry.def_area_left = distance_to_def_area(x, y, 0);
+			entry.def_area_right = distance_to_def_area(x, y, 1);
+			entry.goal_left = sqrt((double) (x + half_width) * (x + half_width) + (double) y * y);
+			entry.goal_right = sqrt((double) (x - half_width) * (x - half_width) + (double) y * y);
+			entry.valid = true;
+		}
+		if (moved || ball_moved) {
+			entry.ball = sqrt((double) (ball_x - x) * (ball_x - x) + (double) (ball_y - y) * (ball_y - y));
+			recomputed++;
+		}
+	}
+}
+
+bool Rule_Memo::get_ball_in_field() {
+	return ball_in_field;
+}
+
+bool Rule_Memo::get_ball_in_goal(int side) {
+	return ball_in_goal[side == 0 ? 0 : 1];
+}
+
+bool Rule_Memo::get_ball_distance(int team, int id, double& dist) {
+	if (team < 0 || team >= Filter_Data::NUMBER_OF_TEAMS || id < 0 || id >= Filter_Data::NUMBER_OF_IDS
+			|| !robots[team][id].seen)
+		return false;
+	dist = robots[team][id].ball;
+	return true;
+}
+
+bool Rule_Memo::get_def_area_distance(int team, int id, double& left, double& right) {
+	if (team < 0 || team >= Filter_Data::NUMBER_OF_TEAMS || id < 0 || id >= Filter_Data::NUMBER_OF_IDS
+			|| !robots[team][id].seen)
+		return false;
+	left = robots[team][id].def_area_left;
+	right = robots[team][id].def_area_right;
+	return true;
+}
+
+bool Rule_Memo::get_goal_distance(int team, int id, double& left, double& right) {
+	if (team < 0 || team >= Filter_Data::NUMBER_OF_TEAMS || id < 0 || id >= Filter_Data::NUMBER_OF_IDS
+			|| !robots[team][id].seen)
+		return false;
+	left = robots[team][id].goal_left;
+	right = robots[team][id].goal_right;
+	return true;
+}
+
+int Rule_Memo::get_recomputed() {
+	return recomputed;
+}
+
+/**
+ * Distance of a point to the defense area (negative inside), same as
+ * distance_to_left_def_area/3 and distance_to_right_def_area/3 in prolog.
+ * @param side 0 left, 1 right
+ */
+double Rule_Memo::distance_to_def_area(double x, double y, int side) {
+	static const int half_width = BSmart::Field::field_width / 2;
+	static const int half_line = BSmart::Field::defense_line / 2;
+	double goal_x = side == 0 ? -half_width : half_width;
+	double dist;
+
+	if (y <= -half_line) {
+		dist = sqrt((goal_x - x) * (goal_x - x) + (-half_line - y) * (-half_line - y));
+	} else if (y <= half_line) {
+		dist = fabs(x - goal_x);
+	} else {
+		dist = sqrt((goal_x - x) * (goal_x - x) + (half_line - y) * (half_line - y));
+	}
+	return dist - BSmart::Field::defense_radius;
+}
@@ -0,0 +1,57 @@
+#ifndef RULE_MEMO_H
+#define RULE_MEMO_H
+
+#include "filter_data.h"
+
+/**
+ * @class Rule_Memo
+ * @brief Derived facts of one world snapshot, used by the rules.
+ * Every value is computed at most once per snapshot. Values of a robot are
+ * only recomputed if the robot (or for ball distances the ball) moved.
+ */
+class Rule_Memo
+{
+public:
+    Rule_Memo();
+
+    void update(const World_Snapshot&);
+
+    //ball
+    bool get_ball_in_field();
+    //side: 0 left goal, 1 right goal
+    bool get_ball_in_goal(int side);
+
+    //robots, false if robot is not seen
+    bool get_ball_distance(int team, int id, double& dist);
+    bool get_def_area_distance(int team, int id, double& left, double& right);
+    bool get_goal_distance(int team, int id, double& left, double& right);
+
+    //number of robot entries computed in the last update
+    int get_recomputed();
+
+    static double distance_to_def_area(double x, double y, int side);
+
+private:
+    struct Robot_Entry {
+        bool seen;
+        bool valid;
+        int x;
+        int y;
+        double ball;
+        double def_area_left;
+        double def_area_right;
+        double goal_left;
+        double goal_right;
+    };
+
+    Robot_Entry robots[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+    bool ball_valid;
+    int ball_x;
+    int ball_y;
+    int ball_z;
+    bool ball_in_field;
+    bool ball_in_goal[2];
+    int recomputed;
+};
+
+#endif //RULE_MEMO_H
@@ -0,0 +1,81 @@
+#include "rule_profiler.h"
+#include <time.h>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+Rule_Profiler::Rule_Profiler() {
+}
+
+long long Rule_Profiler::now() {
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return static_cast<long long> (t.tv_sec) * 1000000 + t.tv_nsec / 1000;
+}
+
+void Rule_Profiler::add(const std::string& name, long long usec, bool hit) {
+	std::map<std::string, Section>::iterator it = sections.find(name);
+	if (it == sections.end()) {
+		Section section;
+		section.calls = section.hits = section.total = section.max = 0;
+		section.min = usec;
+		for (int i = 0; i < BUCKETS; ++i)
+			section.histogram[i] = 0;
+		it = sections.insert(std::make_pair(name, section)).first;
+		order.push_back(name);
+	}
+	Section& section = it->second;
+	section.calls++;
+	if (hit)
+		section.hits++;
+	section.total += usec;
+	if (usec < section.min)
+		section.min = usec;
+	if (usec > section.max)
+		section.max = usec;
+
+	int bucket = 0;
+	while (bucket < BUCKETS - 1 && (1LL << bucket) <= usec)
+		bucket++;
+	section.histogram[bucket]++;
+}
+
+void Rule_Profiler::reset() {
+	sections.clear();
+	order.clear();
+}
+
+/**
+ * upper bound of the bucket containing the given fraction of the calls
+ */
+long long Rule_Profiler::percentile(const Section& section, double fraction) {
+	long long count = 0;
+	for (int i = 0; i < BUCKETS; ++i) {
+		count += section.histogram[i];
+		if (count >= fraction * section.calls)
+			return std::min(1LL << i, section.max);
+	}
+	return section.max;
+}
+
+std::string Rule_Profiler::dump() const {
+	std::ostringstream o;
+	o << std::left << std::setw(36) << "section" << std::right << std::setw(10) << "calls" << std::setw(10)
+			<< "hits" << std::setw(10) << "mean us" << std::setw(8) << "min" << std::setw(8) << "p50<"
+			<< std::setw(8) << "p99<" << std::setw(10) << "max" << std::setw(12) << "total ms" << "  histogram"
+			<< std::endl;
+	for (std::vector<std::string>::const_iterator name = order.begin(); name != order.end(); ++name) {
+		const Section& section = sections.find(*name)->second;
+		o << std::left << std::setw(36) << *name << std::right << std::setw(10) << section.calls << std::setw(10)
+				<< section.hits << std::setw(10) << section.total / section.calls << std::setw(8) << section.min
+				<< std::setw(8) << percentile(section, 0.5) << std::setw(8) << percentile(section, 0.99)
+				<< std::setw(10) << section.max << std::setw(12) << section.total / 1000 << " ";
+		// only the used buckets, as <upper bound>:<count>
+		for (int i = 0; i < BUCKETS; ++i) {
+			if (section.histogram[i] > 0)
+				o << " " << (1LL << i) << ":" << section.histogram[i];
+		}
+		o << std::endl;
+	}
+	return o.str();
+}
@@ -0,0 +1,49 @@
+#ifndef RULE_PROFILER_H
+#define RULE_PROFILER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @class Rule_Profiler
+ * @brief Timing of the calls of the rules thread.
+ * Every section (a predicate, a rule, a batch of calls) counts its calls,
+ * the successful ones (hits) and keeps a histogram of the call times with
+ * buckets of powers of two microseconds.
+ */
+class Rule_Profiler
+{
+public:
+    enum {
+        BUCKETS = 24 // last bucket: 2^22 us and more
+    };
+
+    Rule_Profiler();
+
+    //microseconds of a monotonic clock
+    static long long now();
+
+    void add(const std::string& section, long long usec, bool hit);
+    void reset();
+
+    //table of all sections in order of their first call
+    std::string dump() const;
+
+private:
+    struct Section {
+        long long calls;
+        long long hits;
+        long long total;
+        long long min;
+        long long max;
+        long long histogram[BUCKETS];
+    };
+
+    static long long percentile(const Section&, double);
+
+    std::map<std::string, Section> sections;
+    std::vector<std::string> order;
+};
+
+#endif //RULE_PROFILER_H
@@ -13,15 +13,15 @@ Sample::Sample()
 }
 
 //Polar-Methode
-void Sample::fuettere_polarbaer ( BSmart::Double_Vector* polarbaer )
+void Sample::fuettere_polarbaer ( BSmart::Double_Vector* polarbaer, Filter_Random& random_generator )
 {
     double q = 0.;
     double a1;
     double a2;
 
     while ( q <= 0. || q > 1 ) {
-        a1 = ( 2. * rand() / ( ( double ) RAND_MAX ) ) - 1.;
-        a2 = ( 2. * rand() / ( ( double ) RAND_MAX ) ) - 1.;
+        a1 = ( 2. * random_generator.uniform() ) - 1.;
+        a2 = ( 2. * random_generator.uniform() ) - 1.;
         q = a1 * a1 + a2 * a2;
     }
     double p = sqrt ( ( -2 ) * log ( q ) / q );
@@ -35,10 +35,6 @@ const QString Sample::status_names[STATUS_NUM] = { "UNKNOWN", "ROLLING",
 const QString Sample::last_touched_names[LAST_TOUCHED_NUM] = { "UNKNOWN",
         "YELLOW", "BLUE", "REFEREE"
                                                              };
-const double Ball_Sample::ball_noise = 2.; // mm
-const double Ball_Sample::ball_speed_noise = 0.02; // m/s
-const double Robot_Sample::robot_noise = 5.; // mm
-const double Robot_Sample::robot_speed_noise = 0.1; // m/s
 
 Ball_Sample::Ball_Sample() :
         Sample(), pos ( 0., 0., 0. ), speed ( 0., 0., 0. ), last_touched_robot ( -1, -1 ),
@@ -87,7 +83,9 @@ Ball_Sample::~Ball_Sample()
 }
 
 void Ball_Sample::move ( const double ms,
-                         const Robot_Sample_List& robot_obstacles )
+                         const Robot_Sample_List& robot_obstacles,
+                         const Filter_Parameters& parameters,
+                         Filter_Random& random_generator )
 {
     switch ( status ) {
         case KICKED:
@@ -110,15 +108,15 @@ void Ball_Sample::move ( const double ms,
     //factor should be between 0.5 and 1.5, 10 m/s maximum speed
     factor += 0.1 * speed.length();
 
-    fuettere_polarbaer ( &polarbaer );
-    pos.x += polarbaer.x * ball_noise * factor;
-    pos.y += polarbaer.y * ball_noise * factor;
+    fuettere_polarbaer ( &polarbaer, random_generator );
+    pos.x += polarbaer.x * parameters.ball_noise * factor;
+    pos.y += polarbaer.y * parameters.ball_noise * factor;
 
-    speed *= pow ( 0.9999, ms );
+    speed *= pow ( parameters.ball_friction, ms );
 
-    fuettere_polarbaer ( &polarbaer );
-    speed.x += polarbaer.x * ball_speed_noise * factor;
-    speed.y += polarbaer.y * ball_speed_noise * factor;
+    fuettere_polarbaer ( &polarbaer, random_generator );
+    speed.x += polarbaer.x * parameters.ball_speed_noise * factor;
+    speed.y += polarbaer.y * parameters.ball_speed_noise * factor;
 
     const double g = 9.80665;
 
@@ -128,21 +126,21 @@ void Ball_Sample::move ( const double ms,
     else
         speed.z = 0.;
 
-    fuettere_polarbaer ( &polarbaer );
+    fuettere_polarbaer ( &polarbaer, random_generator );
     if ( speed.z != 0. ) {
-        speed.z += polarbaer.x * ball_speed_noise * factor;
+        speed.z += polarbaer.x * parameters.ball_speed_noise * factor;
     }
 
-    check_collisions ( robot_obstacles, ms );
+    check_collisions ( robot_obstacles, ms, random_generator );
 }
 
 void Ball_Sample::check_collisions ( const Robot_Sample_List& robot_obstacles,
-                                     double ms )
+                                     double ms, Filter_Random& random_generator )
 {
     Hitpoint* hitpoint = new Hitpoint();
     int cnt = 0;
 
-    random = rand() / ( double ) RAND_MAX;
+    random = random_generator.uniform();
 
     //while collision
     bool intersect;
@@ -151,7 +149,7 @@ void Ball_Sample::check_collisions ( const Robot_Sample_List& robot_obstacles,
         intersect = false;
         //check for collision
         intersect = intersect || check_robot_reflections ( hitpoint,
-                    robot_obstacles );
+                    robot_obstacles, random_generator );
         intersect = intersect || check_floor_reflection ( hitpoint );
         intersect = intersect || check_goalpost_reflections ( hitpoint );
         intersect = intersect || check_bar_reflections ( hitpoint );
@@ -210,12 +208,12 @@ void Ball_Sample::check_collisions ( const Robot_Sample_List& robot_obstacles,
                             //shot
                             if ( random < 0.1 ) {
                                 status = KICKED;
-                                random = rand() / ( double ) RAND_MAX;
+                                random = random_generator.uniform();
                             }
                             //chipped
                             else if ( random < 0.15 ) {
                                 status = CHIPPED;
-                                random = rand() / ( double ) RAND_MAX;
+                                random = random_generator.uniform();
                             }
                         }
                         //reflection for robots and goalpost
@@ -230,11 +228,11 @@ void Ball_Sample::check_collisions ( const Robot_Sample_List& robot_obstacles,
                         switch ( status ) {
                             case CHIPPED:
                                 speed.z = random * 6.;
-                                random = rand() / ( double ) RAND_MAX;
+                                random = random_generator.uniform();
                                 //speed.z = gaussian(4,2);
                             case KICKED:
                                 normal.normalize ( 10. * random );
-                                random = rand() / ( double ) RAND_MAX;
+                                random = random_generator.uniform();
                                 //normal.normalize(gaussian(5,5));
                                 speed.x = normal.x;
                                 speed.y = normal.y;
@@ -353,112 +351,78 @@ bool Ball_Sample::check_goalpost_reflections ( Hitpoint* hitpoint )
     ball_line.p1.y = last_pos.y;
     ball_line.p2.x = pos.x; //2d
     ball_line.p2.y = pos.y; //2d
-    intersections.clear();
-    bool intersect = false;
 
-    for ( int i = 0; i < Field_Hardware::NUMBER_FIELD_GOALPOSTS; ++i ) {
-        if ( test_intersection ( Field_Hardware::field_goalposts_ball[i].circle,
-                                 ball_line ) ) {
-            if ( intersection_point (
-                        Field_Hardware::field_goalposts_ball[i].circle, ball_line,
-                        intersections ) ) {
-                //                std::cout << "intersections.size(): " << intersections.size() << std::endl;
-                for ( unsigned int j = 0; j < intersections.size(); ++j ) {
-                    //                    std::cout << "intersections["<<j<<"]: " << intersections[j] << std::endl;
-                    if ( pos.distance_to_2D ( intersections[j] )
-                            < last_pos.distance_to_2D ( pos )
-                            && last_pos.distance_to_2D ( intersections[j] )
-                            < last_pos.distance_to_2D ( pos ) ) {
-                        if ( last_pos.distance_to_2D ( intersections[j] )
-                                < hitpoint->dist ) {
-                            hitpoint->dist = last_pos.distance_to_2D (
-                                                 intersections[j] );
-                            hitpoint->collisionpoint = intersections[j];
-                            hitpoint->obstacle
-                            = Field_Hardware::field_goalposts_ball[i].obstacle;
-                            hitpoint->orientation_point
-                            = Field_Hardware::field_goalposts_ball[i].center;
-                            hitpoint->height
-                            = Field_Hardware::field_goalposts_ball[i].height;
-                            intersect = true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return intersect;
+    const BSmart::Batch_Intersections hits = BSmart::intersection_points (
+                ball_line, Field_Hardware::goalpost_batch_ball() );
+    double fraction;
+    const int i = BSmart::first_crossing ( hits, &fraction );
+    if ( i < 0 )
+        return false;
+
+    const double dist = fraction * last_pos.distance_to_2D ( pos );
+    if ( dist >= hitpoint->dist )
+        return false;
+
+    hitpoint->dist = dist;
+    hitpoint->collisionpoint = ball_line.p1 + ( ball_line.p2 - ball_line.p1 ) * fraction;
+    hitpoint->obstacle = Field_Hardware::field_goalposts_ball[i].obstacle;
+    hitpoint->orientation_point = Field_Hardware::field_goalposts_ball[i].center;
+    hitpoint->height = Field_Hardware::field_goalposts_ball[i].height;
+    return true;
 }
 
 bool Ball_Sample::check_robot_reflections ( Hitpoint* hitpoint,
-        const Robot_Sample_List& robot_obstacles )
+        const Robot_Sample_List& robot_obstacles, Filter_Random& random_generator )
 {
     ball_line.p1.x = last_pos.x;
     ball_line.p1.y = last_pos.y;
     ball_line.p2.x = pos.x; //2d
     ball_line.p2.y = pos.y; //2d
-    intersections.clear();
     bool intersect = false;
 
-    Robot_Sample_List::const_iterator it_obstacles = robot_obstacles.begin();
-    const Robot_Sample_List::const_iterator it_obstacles_end =
-        robot_obstacles.end();
-    circle.radius = BSmart::Field::robot_radius + BSmart::Field::ball_radius;
-    random = rand() / ( double ) RAND_MAX;
-
-    while ( it_obstacles != it_obstacles_end ) {
-        circle.x = it_obstacles->pos.x;
-        circle.y = it_obstacles->pos.y;
-
-        if ( test_intersection ( circle, ball_line ) ) {
-            if ( intersection_point ( circle, ball_line, intersections ) ) {
-                for ( unsigned int j = 0; j < intersections.size(); ++j ) {
-                    if ( pos.distance_to_2D ( intersections[j] )
-                            < last_pos.distance_to_2D ( pos )
-                            && last_pos.distance_to_2D ( intersections[j] )
-                            < last_pos.distance_to_2D ( pos ) ) {
-                        if ( last_pos.distance_to_2D ( intersections[j] )
-                                < hitpoint->dist ) {
-                            hitpoint->dist = last_pos.distance_to_2D (
-                                                 intersections[j] );
-                            hitpoint->collisionpoint = intersections[j];
-                            if ( it_obstacles->team ) {
-                                hitpoint->obstacle = Field_Hardware::ROBOT_BLUE;
-                            } else {
-                                hitpoint->obstacle
-                                = Field_Hardware::ROBOT_YELLOW;
-                            }
-
-                            hitpoint->robot_id = it_obstacles->id;
-                            hitpoint->orientation_point = it_obstacles->pos;
-                            hitpoint->height = BSmart::Field::robot_height;
-                            intersect = true;
-                        }
-                    }
-                }
-            }
-        } else if ( pos.distance_to_2D ( it_obstacles->pos )
-                    < ( BSmart::Field::ball_radius + BSmart::Field::robot_radius
-                        + 40 ) ) {
-            if ( pos.distance_to_2D ( it_obstacles->pos ) < hitpoint->dist ) {
-                if ( random < 0.3 ) { //30% Chance zu kollidieren wenn er nah dran vorbei rollt oder nah dran liegt
-                    hitpoint->dist = pos.distance_to_2D ( it_obstacles->pos );
-                    hitpoint->collisionpoint = BSmart::Double_Vector ( pos.x,
-                                               pos.y );
-                    if ( it_obstacles->team )
-                        hitpoint->obstacle = Field_Hardware::ROBOT_BLUE;
-                    else
-                        hitpoint->obstacle = Field_Hardware::ROBOT_YELLOW;
-
-                    hitpoint->robot_id = it_obstacles->id;
-                    hitpoint->orientation_point = it_obstacles->pos;
-                    hitpoint->height = BSmart::Field::robot_height;
-                    intersect = true;
-                }
-            }
+    BSmart::Circle_Batch circles;
+    const double radius = BSmart::Field::robot_radius + BSmart::Field::ball_radius;
+    for ( unsigned int k = 0; k < robot_obstacles.size(); ++k )
+        circles.add ( robot_obstacles[k].pos.x, robot_obstacles[k].pos.y, radius );
+    random = random_generator.uniform();
+
+    const BSmart::Batch_Intersections hits = BSmart::intersection_points (
+                ball_line, circles );
+    double fraction = 0.;
+    const int hit = BSmart::first_crossing ( hits, &fraction );
+    //rolling close by or lying close to a robot
+    const unsigned int near = BSmart::centers_within ( ball_line.p2, circles,
+                              radius + 40 ) & ~hits.in_box;
+
+    //in the order of the obstacles, the nearest one wins
+    for ( int i = 0; i < circles.size; ++i ) {
+        double dist;
+        if ( i == hit ) {
+            dist = fraction * last_pos.distance_to_2D ( pos );
+            if ( dist >= hitpoint->dist )
+                continue;
+            hitpoint->collisionpoint = ball_line.p1
+                                       + ( ball_line.p2 - ball_line.p1 ) * fraction;
+        } else if ( near & ( 1u << i ) ) {
+            dist = pos.distance_to_2D ( robot_obstacles[i].pos );
+            //30% Chance zu kollidieren wenn er nah dran vorbei rollt oder nah dran liegt
+            if ( dist >= hitpoint->dist || random >= 0.3 )
+                continue;
+            hitpoint->collisionpoint = BSmart::Double_Vector ( pos.x, pos.y );
+        } else {
+            continue;
         }
 
-        it_obstacles++;
+        hitpoint->dist = dist;
+        if ( robot_obstacles[i].team )
+            hitpoint->obstacle = Field_Hardware::ROBOT_BLUE;
+        else
+            hitpoint->obstacle = Field_Hardware::ROBOT_YELLOW;
+
+        hitpoint->robot_id = robot_obstacles[i].id;
+        hitpoint->orientation_point = robot_obstacles[i].pos;
+        hitpoint->height = BSmart::Field::robot_height;
+        intersect = true;
     }
 
     return intersect;
@@ -516,7 +480,9 @@ Robot_Sample::~Robot_Sample()
 }
 
 void Robot_Sample::move ( const double ms,
-                          const Robot_Sample_List& robot_obstacles )
+                          const Robot_Sample_List& robot_obstacles,
+                          const Filter_Parameters& parameters,
+                          Filter_Random& random_generator )
 {
     last_pos = pos;
     pos += ( speed * ms );
@@ -525,15 +491,15 @@ void Robot_Sample::move ( const double ms,
     //factor should be between 0.5 and 1.5, 10 m/s maximum speed
     factor += 0.1 * speed.length();
 
-    fuettere_polarbaer ( &polarbaer );
+    fuettere_polarbaer ( &polarbaer, random_generator );
     //noise auf Position
-    pos.x += polarbaer.x * robot_noise * factor;
-    pos.y += polarbaer.y * robot_noise * factor;
+    pos.x += polarbaer.x * parameters.robot_noise * factor;
+    pos.y += polarbaer.y * parameters.robot_noise * factor;
 
-    fuettere_polarbaer ( &polarbaer );
+    fuettere_polarbaer ( &polarbaer, random_generator );
     //Geschwindigkeit wird nicht reduziert wegen des Antriebs der Roboter
-    speed.x += polarbaer.x * robot_speed_noise * factor;
-    speed.y += polarbaer.y * robot_speed_noise * factor;
+    speed.x += polarbaer.x * parameters.robot_speed_noise * factor;
+    speed.y += polarbaer.y * parameters.robot_speed_noise * factor;
     check_collisions ( robot_obstacles );
 }
 
@@ -656,38 +622,23 @@ bool Robot_Sample::check_goalpost_reflections ( Hitpoint* hitpoint )
 {
     robot_line.p1 = last_pos;
     robot_line.p2 = pos;
-    intersections.clear();
-
-    for ( int i = 0; i < Field_Hardware::NUMBER_FIELD_GOALPOSTS; ++i ) {
-        if ( test_intersection ( Field_Hardware::field_goalposts_robot[i].circle,
-                                 robot_line ) ) {
-            if ( BSmart::intersection_point (
-                        Field_Hardware::field_goalposts_robot[i].circle,
-                        robot_line, intersections ) ) {
-                //                std::cout << "intersections.size(): " << intersections.size() << std::endl;
-                for ( unsigned int j = 0; j < intersections.size(); ++j ) {
-                    //                    std::cout << "intersections["<<j<<"]: " << intersections[j] << std::endl;
-                    if ( pos.distance_to ( intersections[j] )
-                            < last_pos.distance_to ( pos )
-                            && last_pos.distance_to ( intersections[j] )
-                            < last_pos.distance_to ( pos ) ) {
-                        if ( last_pos.distance_to ( intersections[j] )
-                                < hitpoint->dist ) {
-                            hitpoint->dist = last_pos.distance_to (
-                                                 intersections[j] );
-                            hitpoint->collisionpoint = intersections[j];
-                            hitpoint->obstacle
-                            = Field_Hardware::field_goalposts_robot[i].obstacle;
-                            hitpoint->orientation_point
-                            = Field_Hardware::field_goalposts_robot[i].center;
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return false;
+
+    const BSmart::Batch_Intersections hits = BSmart::intersection_points (
+                robot_line, Field_Hardware::goalpost_batch_robot() );
+    double fraction;
+    const int i = BSmart::first_crossing ( hits, &fraction );
+    if ( i < 0 )
+        return false;
+
+    const double dist = fraction * last_pos.distance_to ( pos );
+    if ( dist >= hitpoint->dist )
+        return false;
+
+    hitpoint->dist = dist;
+    hitpoint->collisionpoint = robot_line.p1 + ( robot_line.p2 - robot_line.p1 ) * fraction;
+    hitpoint->obstacle = Field_Hardware::field_goalposts_robot[i].obstacle;
+    hitpoint->orientation_point = Field_Hardware::field_goalposts_robot[i].center;
+    return true;
 }
 
 bool Robot_Sample::check_robot_reflections ( Hitpoint* hitpoint,
@@ -695,58 +646,39 @@ bool Robot_Sample::check_robot_reflections ( Hitpoint* hitpoint,
 {
     robot_line.p1 = last_pos;
     robot_line.p2 = pos;
-    intersections.clear();
-    bool intersect = false;
-
-    //    int num_bots = robot_obstacles.size();
-
-    Robot_Sample_List::const_iterator it_obstacles = robot_obstacles.begin();
-    const Robot_Sample_List::const_iterator it_obstacles_end =
-        robot_obstacles.end();
-
-    circle.radius = 2 * BSmart::Field::robot_radius;
-
-    while ( it_obstacles != it_obstacles_end ) {
-        if ( ! ( ( it_obstacles->team == this->team ) && ( it_obstacles->id
-                 == this->id ) ) ) {
-            //            std::cout << "crr: it_obstacles->team: " << it_obstacles->team << "  it_obstacles->id: " << it_obstacles->id << std::endl;
-            //            std::cout << "crr:               team: " << this->team         << "                id: " << this->id << std::endl;
-
-            circle.x = it_obstacles->pos.x;
-            circle.y = it_obstacles->pos.y;
-
-            if ( test_intersection ( circle, robot_line ) ) {
-                if ( intersection_point ( circle, robot_line, intersections ) ) {
-                    //                    std::cout << "(" << team << "|" << id << "):" << " intersections.size(): " << intersections.size() << std::endl;
-                    for ( unsigned int j = 0; j < intersections.size(); ++j ) {
-                        //                        std::cout << "intersections["<<j<<"]: " << intersections[j] << std::endl;
-                        if ( pos.distance_to ( intersections[j] )
-                                < last_pos.distance_to ( pos )
-                                && last_pos.distance_to ( intersections[j] )
-                                < last_pos.distance_to ( pos ) ) {
-                            if ( last_pos.distance_to ( intersections[j] )
-                                    < hitpoint->dist ) {
-                                hitpoint->dist = last_pos.distance_to (
-                                                     intersections[j] );
-                                hitpoint->collisionpoint = intersections[j];
-                                if ( it_obstacles->team )
-                                    hitpoint->obstacle
-                                    = Field_Hardware::ROBOT_BLUE;
-                                else
-                                    hitpoint->obstacle
-                                    = Field_Hardware::ROBOT_YELLOW;
-
-                                hitpoint->orientation_point = it_obstacles->pos;
-                                intersect = true;
-                            }
-                        }
-                    }
-                }
-            }
-        }
 
-        it_obstacles++;
+    //all robots but this one
+    BSmart::Circle_Batch circles;
+    const Robot_Sample* obstacles[BSmart::Circle_Batch::CAPACITY];
+    for ( unsigned int k = 0; k < robot_obstacles.size(); ++k ) {
+        const Robot_Sample& obstacle = robot_obstacles[k];
+        if ( obstacle.team == this->team && obstacle.id == this->id )
+            continue;
+        //a full batch leaves the obstacle out, obstacles[] has the same capacity
+        if ( !circles.add ( obstacle.pos.x, obstacle.pos.y,
+                            2 * BSmart::Field::robot_radius ) )
+            break;
+        obstacles[circles.size - 1] = &obstacle;
     }
 
-    return intersect;
+    const BSmart::Batch_Intersections hits = BSmart::intersection_points (
+                robot_line, circles );
+    double fraction;
+    const int i = BSmart::first_crossing ( hits, &fraction );
+    if ( i < 0 )
+        return false;
+
+    const double dist = fraction * last_pos.distance_to ( pos );
+    if ( dist >= hitpoint->dist )
+        return false;
+
+    hitpoint->dist = dist;
+    hitpoint->collisionpoint = robot_line.p1 + ( robot_line.p2 - robot_line.p1 ) * fraction;
+    if ( obstacles[i]->team )
+        hitpoint->obstacle = Field_Hardware::ROBOT_BLUE;
+    else
+        hitpoint->obstacle = Field_Hardware::ROBOT_YELLOW;
+
+    hitpoint->orientation_point = obstacles[i]->pos;
+    return true;
 }
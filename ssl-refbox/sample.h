@@ -5,6 +5,8 @@
 #include <QString>
 
 #include "field_hardware.h"
+#include "filter_parameters.h"
+#include "filter_random.h"
 #include <libbsmart/pose.h>
 #include <libbsmart/pose3d.h>
 
@@ -58,7 +60,7 @@ public:
     //ball_model only
     double timestamp;
 
-    void fuettere_polarbaer(BSmart::Double_Vector*);
+    void fuettere_polarbaer(BSmart::Double_Vector*, Filter_Random&);
 
 private:
 
@@ -79,17 +81,14 @@ public:
     Last_Touched last_touched;
     BSmart::Int_Vector last_touched_robot;
 
-    void move(const double, const Robot_Sample_List&);
+    void move(const double, const Robot_Sample_List&, const Filter_Parameters&, Filter_Random&);
 
 private:
-    void check_collisions(const Robot_Sample_List&, double);
+    void check_collisions(const Robot_Sample_List&, double, Filter_Random&);
     bool check_bar_reflections(Hitpoint*);
     bool check_floor_reflection(Hitpoint*);
     bool check_goalpost_reflections(Hitpoint*);
-    bool check_robot_reflections(Hitpoint*, const Robot_Sample_List&);
-
-    static const double ball_noise;
-    static const double ball_speed_noise;
+    bool check_robot_reflections(Hitpoint*, const Robot_Sample_List&, Filter_Random&);
 
     BSmart::Pose3D last_pos;
 
@@ -98,8 +97,6 @@ private:
     double random;
     BSmart::Pose3D collision3D;
     BSmart::Double_Vector intersection;
-    std::vector<BSmart::Double_Vector> intersections;
-    BSmart::Circle circle;
 
     BSmart::Double_Vector polarbaer;
 };
@@ -118,7 +115,7 @@ public:
     int id;
     double confidence;
 
-    void move(const double, const Robot_Sample_List&);
+    void move(const double, const Robot_Sample_List&, const Filter_Parameters&, Filter_Random&);
 
 private:
     void check_collisions(const Robot_Sample_List&);
@@ -126,16 +123,11 @@ private:
     bool check_goalpost_reflections(Hitpoint*);
     bool check_robot_reflections(Hitpoint*, const Robot_Sample_List&);
 
-    static const double robot_noise;
-    static const double robot_speed_noise;
-
     BSmart::Pose last_pos;
 
     //optimisation
     BSmart::Line robot_line;
     BSmart::Double_Vector intersection;
-    std::vector<BSmart::Double_Vector> intersections;
-    BSmart::Circle circle;
 
     BSmart::Double_Vector polarbaer;
 };
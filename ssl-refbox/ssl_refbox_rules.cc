@@ -2,17 +2,132 @@
 #include <QMutex>
 #include <iostream>
 #include <SWI-Prolog.h>
-#include "global.h"
 #include <libbsmart/field.h>
+#include <csignal>
+#include "latency_histogram.h"
+#include "rule_constants.h"
+#include "trace.h"
+#include "async_log.h"
 
 // log4cxx
 using namespace log4cxx;
 LoggerPtr SSL_Refbox_Rules::logger(Logger::getLogger("SSL_Refbox_Rules"));
 
-char* argv_global;
+volatile sig_atomic_t SSL_Refbox_Rules::profile_dump_requested = 0;
+
+// instance whose engine is attached to this thread, for the foreign predicates
+static __thread SSL_Refbox_Rules* engine_rules = 0;
+
+/**
+ * ball_location('ball',Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z)
+ * reads the ball model of the current snapshot
+ */
+foreign_t SSL_Refbox_Rules::pl_ball_location(term_t args, int arity, control_t ctx) {
+	const Ball_Sample& ball = engine_rules->world.ball_model;
+	return PL_unify_atom_chars(args, "ball")
+			&& PL_unify_integer(args + 1, (int) ball.pos.x)
+			&& PL_unify_integer(args + 2, (int) ball.pos.y)
+			&& PL_unify_integer(args + 3, (int) ball.pos.z)
+			&& PL_unify_integer(args + 4, (int) ball.speed.x)
+			&& PL_unify_integer(args + 5, (int) ball.speed.y)
+			&& PL_unify_integer(args + 6, (int) ball.speed.z);
+}
+
+/**
+ * roboter(Team,ID,Pos_x,Pos_y,Speed_x,Speed_y,Visible)
+ * enumerates the seen robots of the current snapshot, Visible is always 1
+ */
+foreign_t SSL_Refbox_Rules::pl_roboter(term_t args, int arity, control_t ctx) {
+	const World_Snapshot& world = engine_rules->world;
+	unsigned int index = 0;
+
+	switch (PL_foreign_control(ctx)) {
+	case PL_FIRST_CALL:
+		index = 0;
+		break;
+	case PL_REDO:
+		index = PL_foreign_context(ctx);
+		break;
+	case PL_PRUNED:
+		PL_succeed;
+	}
+
+	fid_t frame = PL_open_foreign_frame();
+	for (; index < world.robot_models.size(); ++index) {
+		const Robot_Sample& robot = world.robot_models[index];
+		if (PL_unify_integer(args, robot.team)
+				&& PL_unify_integer(args + 1, robot.id)
+				&& PL_unify_integer(args + 2, (int) robot.pos.x)
+				&& PL_unify_integer(args + 3, (int) robot.pos.y)
+				&& PL_unify_integer(args + 4, (int) robot.speed.x)
+				&& PL_unify_integer(args + 5, (int) robot.speed.y)
+				&& PL_unify_integer(args + 6, 1)) {
+			PL_close_foreign_frame(frame);
+			if (index + 1 < world.robot_models.size())
+				PL_retry(index + 1);
+			PL_succeed;
+		}
+		PL_rewind_foreign_frame(frame);
+	}
+	PL_close_foreign_frame(frame);
+	PL_fail;
+}
+
+/**
+ * ball_in_field: ball is inside the field lines
+ */
+foreign_t SSL_Refbox_Rules::pl_ball_in_field(term_t args, int arity, control_t ctx) {
+	return engine_rules->memo.get_ball_in_field();
+}
+
+/**
+ * ball_in_goal(Side): ball is in the left (0) or right (1) goal
+ */
+foreign_t SSL_Refbox_Rules::pl_ball_in_goal(term_t args, int arity, control_t ctx) {
+	int side;
+	if (!PL_get_integer(args, &side))
+		PL_fail;
+	return engine_rules->memo.get_ball_in_goal(side);
+}
+
+/**
+ * robot_ball_distance(Team,ID,Dist), Team and ID have to be bound
+ */
+foreign_t SSL_Refbox_Rules::pl_robot_ball_distance(term_t args, int arity, control_t ctx) {
+	int team, id;
+	double dist;
+	if (!PL_get_integer(args, &team) || !PL_get_integer(args + 1, &id) || !engine_rules->memo.get_ball_distance(team, id, dist))
+		PL_fail;
+	return PL_unify_float(args + 2, dist);
+}
+
+/**
+ * robot_def_area_distance(Team,ID,Dist_left,Dist_right), Team and ID have to be bound
+ */
+foreign_t SSL_Refbox_Rules::pl_robot_def_area_distance(term_t args, int arity, control_t ctx) {
+	int team, id;
+	double left, right;
+	if (!PL_get_integer(args, &team) || !PL_get_integer(args + 1, &id)
+			|| !engine_rules->memo.get_def_area_distance(team, id, left, right))
+		PL_fail;
+	return PL_unify_float(args + 2, left) && PL_unify_float(args + 3, right);
+}
+
+/**
+ * robot_goal_distance(Team,ID,Dist_left,Dist_right), distance to the middle
+ * of the goal lines, Team and ID have to be bound
+ */
+foreign_t SSL_Refbox_Rules::pl_robot_goal_distance(term_t args, int arity, control_t ctx) {
+	int team, id;
+	double left, right;
+	if (!PL_get_integer(args, &team) || !PL_get_integer(args + 1, &id)
+			|| !engine_rules->memo.get_goal_distance(team, id, left, right))
+		PL_fail;
+	return PL_unify_float(args + 2, left) && PL_unify_float(args + 3, right);
+}
 
 SSL_Refbox_Rules::SSL_Refbox_Rules(QWaitCondition* rules_wait_condition_, Filter_Data* filter_data_,
-		BSmart::Game_States* gamestate_) {
+		BSmart::Game_States* gamestate_, const ConfigFile& config) {
 	rules_wait_condition = rules_wait_condition_;
 	filter_data = filter_data_;
 	gamestate = gamestate_;
@@ -22,25 +137,312 @@ SSL_Refbox_Rules::SSL_Refbox_Rules(QWaitCondition* rules_wait_condition_, Filter
 	last_break = -1;
 	touches = 0;
 	internal_play_states = BSmart::Int_Vector(0, 0);
+
+	max_robots = config.read<int>("max_robots", 6);
+	record_file = config.read<std::string>("record_tracked_state", "");
+
+	std::string engine = config.read<std::string>("rule_engine", "prolog");
+	if (engine == "native") {
+		rule_engine = NATIVE_ENGINE;
+	} else if (engine == "compare") {
+		rule_engine = COMPARE_ENGINES;
+	} else {
+		if (engine != "prolog")
+			LOG4CXX_WARN( logger, "Unknown rule_engine " + engine + ", using prolog");
+		rule_engine = PROLOG_ENGINE;
+	}
+	LOG4CXX_INFO( logger, "Rule engine: " + engine);
+	compared_checks = 0;
+	divergent_checks = 0;
+	replay_source = NULL;
+	replaying = false;
+	report = NULL;
+	replay_frames = 0;
+	replay_broken_rules = 0;
+
+	// dump with kill -USR1 <pid>
+	profiling = config.read<int>("rule_profile", 0) != 0;
+	profile_dumps = profile_dump_requested;
+	if (profiling) {
+		native_rules.set_profiler(&profiler);
+		signal(SIGUSR1, request_profile_dump);
+		LOG4CXX_INFO( logger, "Rule profiling on, send SIGUSR1 for a dump");
+	}
+}
+
+/**
+ * Game state of the prolog rules needed by the native rule check
+ */
+Native_Rule_Input SSL_Refbox_Rules::get_native_rule_input() {
+	static predicate_t get_rule_state = PL_predicate("get_rule_state", 11, "native rule state");
+	static predicate_t get_timeout_state = PL_predicate("get_timeout_state", 6, "native timeout state");
+	Native_Rule_Input input;
+	int value[11];
+	long time[4];
+
+	fid_t frame = PL_open_foreign_frame();
+	term_t state = PL_new_term_refs(11);
+	for (int i = 0; i < 11; ++i)
+		value[i] = -1;
+	if (PL_call_predicate(NULL, PL_Q_NORMAL, get_rule_state, state)) {
+		for (int i = 0; i < 11; ++i)
+			PL_get_integer(state + i, &value[i]);
+	}
+	input.local_play_state = value[0];
+	input.left_team = value[1];
+	input.left_goalie = BSmart::Int_Vector(value[2], value[3]);
+	input.right_goalie = BSmart::Int_Vector(value[4], value[5]);
+	input.last_touched = BSmart::Int_Vector(value[6], value[7]);
+	input.ball_status = value[8];
+	input.touches = value[9];
+	input.check_offside = value[10] == 1;
+
+	term_t timeouts = PL_new_term_refs(6);
+	for (int i = 0; i < 4; ++i)
+		time[i] = 0;
+	input.timeouts[0] = input.timeouts[1] = 0;
+	if (PL_call_predicate(NULL, PL_Q_NORMAL, get_timeout_state, timeouts)) {
+		for (int i = 0; i < 4; ++i)
+			PL_get_long(timeouts + i, &time[i]);
+		PL_get_integer(timeouts + 4, &input.timeouts[0]);
+		PL_get_integer(timeouts + 5, &input.timeouts[1]);
+	}
+	input.timeout_start[0] = time[0];
+	input.timeout_start[1] = time[1];
+	input.timeout_total[0] = time[2];
+	input.timeout_total[1] = time[3];
+	PL_discard_foreign_frame(frame);
+
+	input.timestamp = cur_timestamp;
+	input.max_robots = max_robots;
+	return input;
+}
+
+/**
+ * Write the changes of a native rule check back to the prolog game state,
+ * in the order the prolog rules make them
+ */
+void SSL_Refbox_Rules::apply_native_result(const Native_Rule_Result& native) {
+	static predicate_t reset_check_offside = PL_predicate("reset_check_offside", 0, "reset offside check");
+	static predicate_t set_rule_breaker = PL_predicate("set_rule_breaker", 2, "set rule breaker");
+	static predicate_t set_freekick_pos = PL_predicate("set_freekick_pos", 3, "set freekick pos");
+	static predicate_t goal = PL_predicate("goal", 1, "goal");
+	static predicate_t set_next_play_state = PL_predicate("set_next_play_state", 1, "set next play state");
+	static predicate_t set_local_play_state = PL_predicate("set_local_play_state", 1, "set local play state");
+	static predicate_t set_local_next_play_state = PL_predicate("set_local_next_play_state", 1,
+			"set local next play state");
+
+	fid_t frame = PL_open_foreign_frame();
+	if (native.reset_offside)
+		PL_call_predicate(NULL, PL_Q_NORMAL, reset_check_offside, NULL);
+	if (native.has_rule_breaker) {
+		term_t breaker = PL_new_term_refs(2);
+		PL_put_integer(breaker, native.rule_breaker.x);
+		PL_put_integer(breaker + 1, native.rule_breaker.y);
+		PL_call_predicate(NULL, PL_Q_NORMAL, set_rule_breaker, breaker);
+	}
+	if (native.local_play_state != -1) {
+		term_t state = PL_new_term_refs(1);
+		PL_put_integer(state, native.local_play_state);
+		PL_call_predicate(NULL, PL_Q_NORMAL, set_local_play_state, state);
+	}
+	if (native.local_next_play_state != -1) {
+		term_t state = PL_new_term_refs(1);
+		PL_put_integer(state, native.local_next_play_state);
+		PL_call_predicate(NULL, PL_Q_NORMAL, set_local_next_play_state, state);
+	}
+	if (native.goal != -1) {
+		term_t team = PL_new_term_refs(1);
+		PL_put_integer(team, native.goal);
+		PL_call_predicate(NULL, PL_Q_NORMAL, goal, team);
+	}
+	if (native.has_freekick_pos) {
+		term_t pos = PL_new_term_refs(3);
+		PL_put_integer(pos, native.freekick_pos.x);
+		PL_put_integer(pos + 1, native.freekick_pos.y);
+		PL_put_integer(pos + 2, 0);
+		PL_call_predicate(NULL, PL_Q_NORMAL, set_freekick_pos, pos);
+	}
+	if (native.next_play_state != -1) {
+		term_t state = PL_new_term_refs(1);
+		PL_put_integer(state, native.next_play_state);
+		PL_call_predicate(NULL, PL_Q_NORMAL, set_next_play_state, state);
+	}
+	PL_discard_foreign_frame(frame);
+}
+
+/**
+ * Differential check of both engines: the broken rule and the rule breaker
+ * and freekick position, if the GUI shows them for that rule. Replaying a log
+ * with rule_engine=compare reports every divergence.
+ */
+void SSL_Refbox_Rules::compare_engines(int rule, const Native_Rule_Result& native) {
+	static predicate_t get_rule_breaker = PL_predicate("get_rule_breaker", 2, "Robot which breaks a rule");
+	static predicate_t get_freekick_pos = PL_predicate("get_freekick_pos", 3, "get_freekick_pos");
+
+	compared_checks++;
+	std::ostringstream o;
+	if (rule != native.rule) {
+		o << "rule " << rule << " native rule " << native.rule;
+	} else if (rule != -42 && rule != 27 && rule != 28) {
+		fid_t frame = PL_open_foreign_frame();
+		int team = -42, id = -42;
+		term_t breaker = PL_new_term_refs(2);
+		if (PL_call_predicate(NULL, PL_Q_NORMAL, get_rule_breaker, breaker)) {
+			PL_get_integer(breaker, &team);
+			PL_get_integer(breaker + 1, &id);
+		}
+		if (team != native.rule_breaker.x || id != native.rule_breaker.y) {
+			o << "rule " << rule << " broken by " << team << " | " << id << " native " << native.rule_breaker.x
+					<< " | " << native.rule_breaker.y;
+		}
+		if (rule == 19 || rule == 29 || rule == 30 || rule == 42) {
+			double x = -42, y = -42;
+			term_t pos = PL_new_term_refs(3);
+			if (PL_call_predicate(NULL, PL_Q_NORMAL, get_freekick_pos, pos)) {
+				PL_get_float(pos, &x);
+				PL_get_float(pos + 1, &y);
+			}
+			if ((int) x != native.freekick_pos.x || (int) y != native.freekick_pos.y) {
+				o << " rule " << rule << " freekick " << (int) x << " " << (int) y << " native "
+						<< native.freekick_pos.x << " " << native.freekick_pos.y;
+			}
+		}
+		PL_discard_foreign_frame(frame);
+	}
+	if (!o.str().empty()) {
+		divergent_checks++;
+		std::ostringstream w;
+		w << cur_timestamp << " " << cur_frm << " engines differ: " << o.str() << " (" << divergent_checks << " of "
+				<< compared_checks << " checks)";
+		LOG4CXX_WARN( logger, w.str());
+	}
 }
 
 SSL_Refbox_Rules::~SSL_Refbox_Rules() {
-	PL_halt(0);
+	if (profiling)
+		LOG4CXX_INFO( logger, "Rule profile:\n" + profiler.dump());
 }
 
-void SSL_Refbox_Rules::run() {
-	int result; // currently not really needed, but is used to eliminate warning
+/**
+ * Run the rules on a file recorded with record_tracked_state instead of the
+ * pipeline, as fast as possible. run() returns at the end of the file.
+ * Every new broken rule and every change of the ball status is written as
+ * one line to report (also set_report for the live pipeline):
+ * frame timestamp rule number breaker_team breaker_id freekick_x freekick_y
+ * frame timestamp ball status last_touched_team last_touched_id
+ */
+bool SSL_Refbox_Rules::set_replay(const std::string& file, std::ostream* report_) {
+	if (!replay_log.open_read(file)) {
+		LOG4CXX_ERROR( logger, "Could not read tracked state file " + file);
+		return false;
+	}
+	set_replay(&replay_log, report_);
+	return true;
+}
+
+/**
+ * Run the rules on the states of source, as set_replay of a file
+ */
+void SSL_Refbox_Rules::set_replay(Tracked_State_Source* source, std::ostream* report_) {
+	replay_source = source;
+	replaying = true;
+	report = report_;
+	replay_frames = 0;
+	replay_broken_rules = 0;
+}
+
+void SSL_Refbox_Rules::request_profile_dump(int) {
+	profile_dump_requested++;
+}
+
+/**
+ * PL_call_predicate, timed in profiling mode
+ */
+int SSL_Refbox_Rules::call_predicate(predicate_t predicate, term_t args, const char* section) {
+	if (!profiling)
+		return PL_call_predicate(NULL, PL_Q_NORMAL, predicate, args);
+	long long start = Rule_Profiler::now();
+	int res = PL_call_predicate(NULL, PL_Q_NORMAL, predicate, args);
+	profiler.add(section, Rule_Profiler::now() - start, res);
+	return res;
+}
+
+/**
+ * check_rules(X). In profiling mode the rules are called one by one in the
+ * order of check_rules, so every rule gets its own time.
+ */
+int SSL_Refbox_Rules::call_check_rules(predicate_t check_rules, term_t broken_rule) {
+	// same order as check_rules in ssl_refbox_rules_prolog.pl
+	static const struct {
+		int rule;
+		const char* name;
+	} rules[] = { { 29, "rule_twentynine" }, { 30, "rule_thirty" }, { 16, "rule_sixteen" },
+			{ 15, "rule_fifteen" }, { 14, "rule_fourteen" }, { 17, "rule_seventeen" }, { 19, "rule_nineteen" },
+			{ 3, "rule_three" }, { 28, "rule_twentyeight" }, { 27, "rule_twentyseven" },
+			{ 18, "rule_eighteen" }, { 22, "rule_twentytwo" }, { 1, "rule_one" }, { 42, "rule_fourtytwo" } };
+
+	if (!profiling)
+		return PL_call_predicate(NULL, PL_Q_NORMAL, check_rules, broken_rule);
+
+	long long start = Rule_Profiler::now();
+	int res = 0;
+	for (unsigned int i = 0; i < sizeof(rules) / sizeof(rules[0]) && !res; ++i) {
+		std::ostringstream name;
+		name << "rule " << rules[i].rule;
+		if (call_predicate(PL_predicate(rules[i].name, 0, "user"), NULL, name.str().c_str()))
+			res = PL_unify_integer(broken_rule, rules[i].rule);
+	}
+	profiler.add("check_rules", Rule_Profiler::now() - start, res);
+	return res;
+}
+
+/**
+ * Register the foreign predicates and initialize prolog with the rules
+ * linked into program. The engines of the rules threads are created from it.
+ */
+bool SSL_Refbox_Rules::init_prolog(const char* program) {
+	static bool initialised = false;
+	if (initialised)
+		return true;
 
 	/* Construction of arguments to initialize Prolog */
-	char* program = argv_global;
 	char *plav[2];
-	plav[0] = program;
+	plav[0] = const_cast<char*> (program);
 	plav[1] = NULL;
 
+	/* World model, read by the rules directly from the snapshot */
+
+	PL_register_foreign("ball_location", 7, (void*) pl_ball_location, PL_FA_VARARGS);
+	PL_register_foreign("roboter", 7, (void*) pl_roboter, PL_FA_VARARGS | PL_FA_NONDETERMINISTIC);
+	PL_register_foreign("ball_in_field", 0, (void*) pl_ball_in_field, PL_FA_VARARGS);
+	PL_register_foreign("ball_in_goal", 1, (void*) pl_ball_in_goal, PL_FA_VARARGS);
+	PL_register_foreign("robot_ball_distance", 3, (void*) pl_robot_ball_distance, PL_FA_VARARGS);
+	PL_register_foreign("robot_def_area_distance", 4, (void*) pl_robot_def_area_distance, PL_FA_VARARGS);
+	PL_register_foreign("robot_goal_distance", 4, (void*) pl_robot_goal_distance, PL_FA_VARARGS);
+
 	/* Initialization of Prolog */
 
-	if (!PL_initialise(1, plav))
-		PL_halt(1);
+	if (!PL_initialise(1, plav)) {
+		LOG4CXX_ERROR( logger, "Could not initialise prolog");
+		return false;
+	}
+	initialised = true;
+	return true;
+}
+
+void SSL_Refbox_Rules::run() {
+	int result; // currently not really needed, but is used to eliminate warning
+
+	/* Own engine, all facts of the game are thread_local in prolog */
+
+	PL_engine_t engine = PL_create_engine(NULL);
+	if (engine == NULL || PL_set_engine(engine, NULL) != PL_ENGINE_SET) {
+		LOG4CXX_ERROR( logger, "Could not create a prolog engine, call init_prolog first");
+		return;
+	}
+	engine_rules = this;
+	Trace::set_thread_name("rules");
 
 	/* Field definitions */
 
@@ -63,7 +465,7 @@ void SSL_Refbox_Rules::run() {
 	predicate_t set_field = PL_predicate("define_field", 8, "field_definition");
 	PL_call_predicate(NULL, PL_Q_NORMAL, set_field, field_width);
 
-	/* Constants definitions */
+	/* Constants definitions, shared with the native rules */
 	term_t OpponentsBeforeKickOff = PL_new_term_refs(20);
 	term_t BallOtOufPlay = OpponentsBeforeKickOff + 1;
 	term_t OpponentAtDefArea = OpponentsBeforeKickOff + 2;
@@ -84,60 +486,48 @@ void SSL_Refbox_Rules::run() {
 	term_t GoalKickOppRob = OpponentsBeforeKickOff + 17;
 	term_t CornerKick = OpponentsBeforeKickOff + 18;
 	term_t CornerKickOppRob = OpponentsBeforeKickOff + 19;
-	result = PL_put_integer(OpponentsBeforeKickOff, 500);
-	result = PL_put_integer(BallOtOufPlay, 500);
-	result = PL_put_integer(OpponentAtDefArea, 200);
-	result = PL_put_integer(BallNotEnterInTime, 10);
-	result = PL_put_integer(BallNotEnterDist, 500);
-	result = PL_put_integer(DribblingTooMuch, 500);
-	result = PL_put_integer(BallTooHighIntoGoal, 150);
-	result = PL_put_integer(BallSpeed, 8);
-	result = PL_put_integer(FreeKickInDefAreaFromGoal, 600);
-	result = PL_put_integer(FreeKickInDefAreaFromTouch, 100);
-	result = PL_put_integer(FreeKickInDefAreaAttack, 700);
-	result = PL_put_integer(FreeKickOtherRob, 500);
-	result = PL_put_integer(PenaltyKickOtherRob, 400);
-	result = PL_put_integer(ThrowIn, 100);
-	result = PL_put_integer(ThrowInOtherRob, 500);
-	result = PL_put_integer(GoalKickFromLine, 500);
-	result = PL_put_integer(GoalKickFromTouch, 100);
-	result = PL_put_integer(GoalKickOppRob, 500);
-	result = PL_put_integer(CornerKick, 100);
-	result = PL_put_integer(CornerKickOppRob, 500);
+	result = PL_put_integer(OpponentsBeforeKickOff, Rule_Constants::OPPONENTS_BEFORE_KICK_OFF);
+	result = PL_put_integer(BallOtOufPlay, Rule_Constants::BALL_OUT_OF_PLAY);
+	result = PL_put_integer(OpponentAtDefArea, Rule_Constants::OPPONENT_AT_DEF_AREA);
+	result = PL_put_integer(BallNotEnterInTime, Rule_Constants::BALL_NOT_ENTER_IN_TIME);
+	result = PL_put_integer(BallNotEnterDist, Rule_Constants::BALL_NOT_ENTER_DIST);
+	result = PL_put_integer(DribblingTooMuch, Rule_Constants::DRIBBLING_TOO_MUCH);
+	result = PL_put_integer(BallTooHighIntoGoal, Rule_Constants::BALL_TOO_HIGH_INTO_GOAL);
+	result = PL_put_integer(BallSpeed, Rule_Constants::BALL_SPEED);
+	result = PL_put_integer(FreeKickInDefAreaFromGoal, Rule_Constants::FREE_KICK_IN_DEF_AREA_FROM_GOAL);
+	result = PL_put_integer(FreeKickInDefAreaFromTouch, Rule_Constants::FREE_KICK_IN_DEF_AREA_FROM_TOUCH);
+	result = PL_put_integer(FreeKickInDefAreaAttack, Rule_Constants::FREE_KICK_IN_DEF_AREA_ATTACK);
+	result = PL_put_integer(FreeKickOtherRob, Rule_Constants::FREE_KICK_OTHER_ROB);
+	result = PL_put_integer(PenaltyKickOtherRob, Rule_Constants::PENALTY_KICK_OTHER_ROB);
+	result = PL_put_integer(ThrowIn, Rule_Constants::THROW_IN);
+	result = PL_put_integer(ThrowInOtherRob, Rule_Constants::THROW_IN_OTHER_ROB);
+	result = PL_put_integer(GoalKickFromLine, Rule_Constants::GOAL_KICK_FROM_LINE);
+	result = PL_put_integer(GoalKickFromTouch, Rule_Constants::GOAL_KICK_FROM_TOUCH);
+	result = PL_put_integer(GoalKickOppRob, Rule_Constants::GOAL_KICK_OPP_ROB);
+	result = PL_put_integer(CornerKick, Rule_Constants::CORNER_KICK);
+	result = PL_put_integer(CornerKickOppRob, Rule_Constants::CORNER_KICK_OPP_ROB);
 
 	predicate_t set_constants = PL_predicate("define_constants", 20, "constants_def");
 	PL_call_predicate(NULL, PL_Q_NORMAL, set_constants, OpponentsBeforeKickOff);
 
+	/* Robots per team, depends on division */
+	term_t max_robots_term = PL_new_term_refs(1);
+	result = PL_put_integer(max_robots_term, max_robots);
+	predicate_t set_max_robots = PL_predicate("set_max_robots", 1, "max_robots_def");
+	PL_call_predicate(NULL, PL_Q_NORMAL, set_max_robots, max_robots_term);
+
 	/* Game initialization, Preparing variables */
 
 	predicate_t game_init = PL_predicate("game_init", 0, "Game initialization");
 	PL_call_predicate(NULL, PL_Q_NORMAL, game_init, NULL);
 
-	/* ball */
-
-	Ball_Sample ball_model;
-	term_t ball_pos_x = PL_new_term_refs(9);
-	term_t ball_pos_y = ball_pos_x + 1;
-	term_t ball_pos_z = ball_pos_x + 2;
-	term_t ball_speed_x = ball_pos_x + 3;
-	term_t ball_speed_y = ball_pos_x + 4;
-	term_t ball_speed_z = ball_pos_x + 5;
-	term_t ball_last_touched_team = ball_pos_x + 6;
-	term_t ball_last_touched_id = ball_pos_x + 7;
-	term_t ball_status = ball_pos_x + 8;
-	predicate_t set_ball_stuff = PL_predicate("set_ball_stuff", 9, "set_ball_variable");
-
-	/* robots */
-	Robot_Sample robot_model;
-	bool robot_seen_tmp;
-	term_t robot_team = PL_new_term_refs(7);
-	term_t robot_id = robot_team + 1;
-	term_t robot_pos_x = robot_team + 2;
-	term_t robot_pos_y = robot_team + 3;
-	term_t robot_speed_x = robot_team + 4;
-	term_t robot_speed_y = robot_team + 5;
-	term_t robot_seen = robot_team + 6;
-	predicate_t set_robot = PL_predicate("set_robot", 7, "set_robot_variable");
+	/* ball: position and robots come from the snapshot, only the status is
+	 * kept in prolog, because touches are counted there */
+
+	term_t ball_last_touched_team = PL_new_term_refs(3);
+	term_t ball_last_touched_id = ball_last_touched_team + 1;
+	term_t ball_status = ball_last_touched_team + 2;
+	predicate_t set_ball_status = PL_predicate("set_ball_status", 3, "set_ball_status");
 
 	/* timestamp */
 	term_t timestamp = PL_new_term_refs(1);
@@ -182,117 +572,148 @@ void SSL_Refbox_Rules::run() {
 
 	// Drawing of messages for broken rules on GUI
 	Broken_Rule broken_rule_gui;
-	std::vector<Broken_Rule> broken_rule_vector;
+	// broken rules of the last 5 seconds, the GUI gets changes as events
+	std::deque<Broken_Rule> recent_broken_rules;
+
+	// input of one cycle, from the pipeline or from a recorded file
+	Tracked_State state;
+	if (!replaying && !record_file.empty()) {
+		if (record_log.open_write(record_file))
+			LOG4CXX_INFO( logger, "Recording tracked state to " + record_file);
+		else
+			LOG4CXX_WARN( logger, "Could not open " + record_file + " for recording tracked state");
+	}
+	long long replay_start = Rule_Profiler::now();
+	int report_ball_status = -1;
 
 	QMutex rules_mutex;
 	for (;;) {
 
-		rules_mutex.lock();
-		rules_wait_condition->wait(&rules_mutex);
+		if (replaying) {
+			if (!replay_source->read(state))
+				break;
+			replay_frames++;
+		} else {
+			rules_mutex.lock();
+			long long wait_start = Trace::enabled() ? Rule_Profiler::now() : 0;
+			rules_wait_condition->wait(&rules_mutex);
+			state.world = filter_data->acquire_world_snapshot(Filter_Data::RULES_READER);
+			if (Trace::enabled())
+				Trace::complete("wait_for_filter", wait_start, Rule_Profiler::now(), state.world.frame, -1);
+			BSmart::Game_States::State game_state = gamestate->get_state();
+			state.play_state = game_state.play_state;
+			state.refbox_cmd = game_state.refbox_cmd;
+			record_log.write(state);
+		}
+		if (report && state.world.ball_model.status != report_ball_status) {
+			report_ball_status = state.world.ball_model.status;
+			*report << state.world.frame << " " << state.world.timestamp << " ball " << report_ball_status << " "
+					<< state.world.ball_model.last_touched_robot.x << " "
+					<< state.world.ball_model.last_touched_robot.y << std::endl;
+		}
+
+		long long cycle_start = Rule_Profiler::now();
+		if (profile_dumps != profile_dump_requested) {
+			profile_dumps = profile_dump_requested;
+			LOG4CXX_INFO( logger, "Rule profile:\n" + profiler.dump());
+		}
+
+		// World model of this cycle
+		world = state.world;
+		memo.update(world);
+		long long setters_start = profiling ? Rule_Profiler::now() : 0;
 
 		// Timestamp
-		cur_timestamp = filter_data->get_timestamp();
+		cur_timestamp = world.timestamp;
 		result = PL_put_integer(timestamp, cur_timestamp);
-		PL_call_predicate(NULL, PL_Q_NORMAL, set_timestamp, timestamp);
-		cur_frm = filter_data->get_frame();
+		call_predicate(set_timestamp, timestamp, "set_timestamp");
+		cur_frm = world.frame;
 
 		// Playstate
-		play_state_tmp = gamestate->get_play_state();
+		play_state_tmp = state.play_state;
 		result = PL_put_integer(global_play_state, play_state_tmp);
-		PL_call_predicate(NULL, PL_Q_NORMAL, set_global_play_state, global_play_state);
+		call_predicate(set_global_play_state, global_play_state, "set_global_play_state");
 		if (play_state_tmp != play_state_old) {
 			play_state_old = play_state_tmp;
-			PL_call_predicate(NULL, PL_Q_NORMAL, set_local_play_state_from_outside, global_play_state);
+			call_predicate(set_local_play_state_from_outside, global_play_state,
+					"set_local_play_state_from_outside");
 			local_play_state_alt = play_state_tmp;
 		}
-		refbox_cmd = gamestate->get_refbox_cmd();
+		refbox_cmd = state.refbox_cmd;
 		if (refbox_cmd != refbox_cmd_alt) {
 			switch (refbox_cmd) {
 			// timeout yellow start
 			case 't':
-				PL_call_predicate(NULL, PL_Q_NORMAL, start_yellow_timeout, NULL);
+				call_predicate(start_yellow_timeout, NULL, "start_yellow_timeout");
 				break;
 				// timeout blue start
 			case 'T':
-				PL_call_predicate(NULL, PL_Q_NORMAL, start_blue_timeout, NULL);
+				call_predicate(start_blue_timeout, NULL, "start_blue_timeout");
 				break;
 				// timeout yellow end
 			case 'z':
-				PL_call_predicate(NULL, PL_Q_NORMAL, end_yellow_timeout, NULL);
+				call_predicate(end_yellow_timeout, NULL, "end_yellow_timeout");
 				break;
 				// timeout blue end
 			case 'Z':
-				PL_call_predicate(NULL, PL_Q_NORMAL, end_blue_timeout, NULL);
+				call_predicate(end_blue_timeout, NULL, "end_blue_timeout");
 				break;
 			case 'h':
-				PL_call_predicate(NULL, PL_Q_NORMAL, end_first_half, NULL);
+				call_predicate(end_first_half, NULL, "end_first_half");
 			}
 			refbox_cmd_alt = refbox_cmd;
 		}
 
-		// Ball
-		ball_model = filter_data->get_ball_model();
-		result = PL_put_integer(ball_pos_x, ball_model.pos.x);
-		result = PL_put_integer(ball_pos_y, ball_model.pos.y);
-		result = PL_put_integer(ball_pos_z, ball_model.pos.z);
-		result = PL_put_integer(ball_speed_x, ball_model.speed.x);
-		result = PL_put_integer(ball_speed_y, ball_model.speed.y);
-		result = PL_put_integer(ball_speed_z, ball_model.speed.z);
-		result = PL_put_integer(ball_last_touched_team, ball_model.last_touched_robot.x);
-		result = PL_put_integer(ball_last_touched_id, ball_model.last_touched_robot.y);
-		result = PL_put_integer(ball_status, ball_model.status);
-		PL_call_predicate(NULL, PL_Q_NORMAL, set_ball_stuff, ball_pos_x);
-
-		// Robots
-		for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-			for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-				robot_model = filter_data->get_robot_model(team, id);
-				robot_seen_tmp = filter_data->get_robot_seen(team, id);
-				result = PL_put_integer(robot_team, team);
-				result = PL_put_integer(robot_id, id);
-				result = PL_put_integer(robot_pos_x, robot_model.pos.x);
-				result = PL_put_integer(robot_pos_y, robot_model.pos.y);
-				result = PL_put_integer(robot_speed_x, robot_model.speed.x);
-				result = PL_put_integer(robot_speed_y, robot_model.speed.y);
-				result = PL_put_integer(robot_seen, (int) robot_seen_tmp);
-
-				PL_call_predicate(NULL, PL_Q_NORMAL, set_robot, robot_team);
-			}
+		// Ball status
+		result = PL_put_integer(ball_last_touched_team, world.ball_model.last_touched_robot.x);
+		result = PL_put_integer(ball_last_touched_id, world.ball_model.last_touched_robot.y);
+		result = PL_put_integer(ball_status, world.ball_model.status);
+		call_predicate(set_ball_status, ball_last_touched_team, "set_ball_status");
+		if (profiling)
+			profiler.add("setters", Rule_Profiler::now() - setters_start, true);
+
+		// Forget old broken rules, the GUI does the same with its copy
+		for (std::deque<Broken_Rule>::iterator brit = recent_broken_rules.begin();
+				brit != recent_broken_rules.end();) {
+			if ((cur_timestamp - brit->when_broken) > 5000)
+				brit = recent_broken_rules.erase(brit);
+			else
+				++brit;
 		}
-
-		// Load and save GUI-update for broken rules
-		broken_rule_vector.clear();
-		broken_rule_vector = filter_data->get_broken_rules();
-		// vektor will not be cleared. All ever broken rules are contained in the vektor
-//        for ( std::vector<Broken_Rule>::iterator brit =
-//                    broken_rule_vector.begin(); brit != broken_rule_vector.end(); ) {
-//            if ( ( cur_timestamp - brit->when_broken ) > 5000 ) {
-//                std::ostringstream o;
-//                o << cur_timestamp << " - " << brit->when_broken
-//                << " rule " << brit->rule_number << " removed";
-//                LOG4CXX_DEBUG ( logger, o.str() );
-//                broken_rule_vector.erase ( brit );
-//            } else {
-//                brit++;
-//            }
-//        }
 		broken_rule_gui.rule_number = -42;
 
 		// Only check rules, if internal and external state is equal
-		if (PL_call_predicate(NULL, PL_Q_NORMAL, rule_zero, NULL)) {
-			PL_call_predicate(NULL, PL_Q_NORMAL, game_control, NULL);
+		if (call_predicate(rule_zero, NULL, "rule_zero")) {
+			call_predicate(game_control, NULL, "game_control");
+
+			// the native check reads the game state before prolog changes it
+			Native_Rule_Result native_result;
+			if (rule_engine != PROLOG_ENGINE) {
+				long long native_start = profiling ? Rule_Profiler::now() : 0;
+				native_result = native_rules.check_rules(world, memo, get_native_rule_input());
+				if (rule_engine == NATIVE_ENGINE)
+					apply_native_result(native_result);
+				if (profiling)
+					profiler.add("native check_rules", Rule_Profiler::now() - native_start,
+							native_result.rule != -42);
+			}
 
 			term_t broken_rule = PL_new_term_refs(1);
-
-			if (PL_call_predicate(NULL, PL_Q_NORMAL, check_rules, broken_rule)) {
-				int rule = -42;
+			int rule = -42;
+			if (rule_engine == NATIVE_ENGINE)
+				rule = native_result.rule;
+			else if (call_check_rules(check_rules, broken_rule))
 				result = PL_get_integer(broken_rule, &rule);
+			if (rule_engine == COMPARE_ENGINES)
+				compare_engines(rule, native_result);
+
+			if (rule != -42) {
 
 				int team = -42;
 				int id = -42;
 				term_t rule_breaker_team = PL_new_term_refs(2);
 				term_t rule_breaker_id = rule_breaker_team + 1;
-				PL_call_predicate(NULL, PL_Q_NORMAL, get_rule_breaker, rule_breaker_team);
+				call_predicate(get_rule_breaker, rule_breaker_team, "get_rule_breaker");
 				result = PL_get_integer(rule_breaker_team, &team);
 				result = PL_get_integer(rule_breaker_id, &id);
 
@@ -301,25 +722,24 @@ void SSL_Refbox_Rules::run() {
 				if (rule != last_break || (cur_frm - last_msg) > 100) {
 					int local_play_state_test = -42;
 					term_t local_play_state_test_term = PL_new_term_refs(1);
-					PL_call_predicate(NULL, PL_Q_NORMAL, get_local_play_state, local_play_state_test_term);
+					call_predicate(get_local_play_state, local_play_state_test_term, "get_local_play_state");
 					result = PL_get_integer(local_play_state_test_term, &local_play_state_test);
 					int left = -42;
 					term_t left_team = PL_new_term_refs(1);
-					PL_call_predicate(NULL, PL_Q_NORMAL, get_left, left_team);
+					call_predicate(get_left, left_team, "get_left");
 					result = PL_get_integer(left_team, &left);
 
 					last_break = rule;
 					last_msg = cur_frm;
-					std::ostringstream o;
-					o << cur_timestamp << " " << cur_frm << " Rule " << rule << " broken by " << team << " | " << id;
-					LOG4CXX_DEBUG( logger, o.str());
+					Async_Log::debug(logger, "{} {} Rule {} broken by {} | {}", cur_timestamp, cur_frm, rule, team,
+							id);
 				}
 
 				// new broken rule
 				if (rule != -42) {
-					int x_tmp = -42;
-					int y_tmp = -42;
-					int z_tmp = -42;
+					double x_tmp = -42;
+					double y_tmp = -42;
+					double z_tmp = -42;
 					int left = -42;
 					int local_play_state_test_gui = -42;
 					int standing_yellow = -42;
@@ -331,17 +751,18 @@ void SSL_Refbox_Rules::run() {
 					term_t local_play_state_test_term_gui = PL_new_term_refs(1);
 					term_t t_standing_yellow = PL_new_term_refs(2);
 					term_t t_standing_blue = t_standing_yellow + 1;
-					PL_call_predicate(NULL, PL_Q_NORMAL, get_freekick_pos, freekick_pos_x);
-					PL_call_predicate(NULL, PL_Q_NORMAL, get_left, left_team);
-					PL_call_predicate(NULL, PL_Q_NORMAL, get_local_play_state, local_play_state_test_term_gui);
-					PL_call_predicate(NULL, PL_Q_NORMAL, get_standing, t_standing_yellow);
-					result = PL_get_integer(freekick_pos_x, &x_tmp);
-					result = PL_get_integer(freekick_pos_y, &y_tmp);
-					result = PL_get_integer(freekick_pos_z, &z_tmp);
+					call_predicate(get_freekick_pos, freekick_pos_x, "get_freekick_pos");
+					call_predicate(get_left, left_team, "get_left");
+					call_predicate(get_local_play_state, local_play_state_test_term_gui, "get_local_play_state");
+					call_predicate(get_standing, t_standing_yellow, "get_standing");
+					// not integer, if computed as a middle between robots
+					result = PL_get_float(freekick_pos_x, &x_tmp);
+					result = PL_get_float(freekick_pos_y, &y_tmp);
+					result = PL_get_float(freekick_pos_z, &z_tmp);
 					result = PL_get_integer(local_play_state_test_term_gui, &local_play_state_test_gui);
 					result = PL_get_integer(t_standing_yellow, &standing_yellow);
 					result = PL_get_integer(t_standing_blue, &standing_blue);
-					BSmart::Int_Vector freekick_pos(x_tmp, y_tmp);
+					BSmart::Int_Vector freekick_pos((int) x_tmp, (int) y_tmp);
 					result = PL_get_integer(left_team, &left);
 
 					broken_rule_gui.rule_number = rule;
@@ -430,11 +851,8 @@ void SSL_Refbox_Rules::run() {
 		}
 
 		bool broken_rule_modified = false;
-		for (std::vector<Broken_Rule>::reverse_iterator brit = broken_rule_vector.rbegin();
-				brit != broken_rule_vector.rend(); ++brit) {
-			if ((cur_timestamp - brit->when_broken) > 5000) {
-				break;
-			}
+		for (std::deque<Broken_Rule>::iterator brit = recent_broken_rules.begin();
+				brit != recent_broken_rules.end(); ++brit) {
 			if (broken_rule_gui.rule_number == brit->rule_number) {
 //                std::ostringstream o;
 //                o << cur_timestamp << " rule " << broken_rule_gui.rule_number <<
@@ -447,31 +865,38 @@ void SSL_Refbox_Rules::run() {
 				brit->defense_area = broken_rule_gui.defense_area;
 				brit->line_for_smth = broken_rule_gui.line_for_smth;
 				brit->standing = broken_rule_gui.standing;
+				filter_data->add_broken_rule_event(*brit, true);
 				broken_rule_modified = true;
 			}
 		}
 		if (!broken_rule_modified && broken_rule_gui.rule_number != -42) {
-			broken_rule_vector.push_back(broken_rule_gui);
-			std::ostringstream o;
-			o << cur_timestamp << " rule " << broken_rule_gui.rule_number << " broken" << "Broken rules: "
-					<< broken_rule_vector.size();
-			LOG4CXX_DEBUG( logger, o.str());
+			filter_data->add_broken_rule_event(broken_rule_gui, false);
+			recent_broken_rules.push_back(broken_rule_gui);
+			if (recent_broken_rules.size() > MAX_RECENT_BROKEN_RULES)
+				recent_broken_rules.pop_front();
+			Async_Log::debug(logger, "{} rule {} broken, broken rules: {}", cur_timestamp,
+					broken_rule_gui.rule_number, recent_broken_rules.size());
+			if (report)
+				*report << cur_frm << " " << cur_timestamp << " rule " << broken_rule_gui.rule_number << " "
+						<< broken_rule_gui.rule_breaker.x << " " << broken_rule_gui.rule_breaker.y << " "
+						<< broken_rule_gui.freekick_pos.x << " " << broken_rule_gui.freekick_pos.y << std::endl;
+			if (replaying)
+				replay_broken_rules++;
 			if (broken_rule_gui.rule_number > 0 && broken_rule_gui.rule_number <= 42) {
 				emit new_broken_rule(&broken_rule_gui);
 			} else {
-				LOG4CXX_WARN( logger, "Invalid rule number");
+				Async_Log::warn(logger, "Invalid rule number {}", broken_rule_gui.rule_number);
 			}
 		}
-		filter_data->set_broken_rules(broken_rule_vector);
 
 		int local_play_state_test = -42;
 		term_t local_play_state_test_term = PL_new_term_refs(1);
-		PL_call_predicate(NULL, PL_Q_NORMAL, get_local_play_state, local_play_state_test_term);
+		call_predicate(get_local_play_state, local_play_state_test_term, "get_local_play_state");
 		result = PL_get_integer(local_play_state_test_term, &local_play_state_test);
 
 		int local_next_play_state_test = -42;
 		term_t local_next_play_state_test_term = PL_new_term_refs(1);
-		PL_call_predicate(NULL, PL_Q_NORMAL, get_local_next_play_state, local_next_play_state_test_term);
+		call_predicate(get_local_next_play_state, local_next_play_state_test_term, "get_local_next_play_state");
 		result = PL_get_integer(local_next_play_state_test_term, &local_next_play_state_test);
 
 		internal_play_states.x = local_play_state_test;
@@ -482,8 +907,29 @@ void SSL_Refbox_Rules::run() {
 			local_play_state_alt = local_play_state_test;
 		}
 
+		long long cycle_end = Rule_Profiler::now();
+		if (profiling)
+			profiler.add("cycle", cycle_end - cycle_start, true);
+		if (!replaying) {
+			Metrics::rule_evaluation.record(cycle_end - cycle_start);
+			if (world.received_us != 0)
+				Metrics::end_to_end.record(cycle_end - world.received_us);
+			if (Trace::enabled())
+				Trace::complete("rules_cycle", cycle_start, cycle_end, world.frame, -1);
+		}
+
 		emit
 		new_filter_data();
-		rules_mutex.unlock();
+		if (!replaying)
+			rules_mutex.unlock();
 	}
+
+	std::ostringstream o;
+	o << "Replayed " << replay_frames << " frames in " << (Rule_Profiler::now() - replay_start) / 1000 << " ms, "
+			<< replay_broken_rules << " broken rules";
+	LOG4CXX_INFO( logger, o.str());
+
+	engine_rules = 0;
+	PL_set_engine(NULL, NULL);
+	PL_destroy_engine(engine);
 }
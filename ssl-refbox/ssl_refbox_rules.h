@@ -5,20 +5,40 @@
 #include <QWaitCondition>
 #include <libbsmart/game_states.h>
 #include "filter_data.h"
+#include "rule_memo.h"
+#include "native_rules.h"
+#include "rule_profiler.h"
+#include "tracked_state_log.h"
+#include <ostream>
+#include <deque>
+#include <csignal>
 #include <string.h>
 #include "../ConfigFile/ConfigFile.h"
 #include <log4cxx/logger.h>
-
-extern char* argv_global;
+#include <SWI-Prolog.h>
 
 class SSL_Refbox_Rules : public QThread
 {
     Q_OBJECT
 
 public:
-    SSL_Refbox_Rules(QWaitCondition*, Filter_Data*, BSmart::Game_States*);
+    SSL_Refbox_Rules(QWaitCondition*, Filter_Data*, BSmart::Game_States*, const ConfigFile&);
     ~SSL_Refbox_Rules();
+    // once per process before any rules thread starts, program is argv[0]
+    static bool init_prolog(const char* program);
+    // every instance runs the rules in its own prolog engine
     void run();
+    // headless replay of a recorded tracked state file
+    bool set_replay(const std::string& file, std::ostream* report);
+    // headless replay of any source, e.g. Pipeline_Replay
+    void set_replay(Tracked_State_Source*, std::ostream* report);
+    // the lines of the replay report for the live pipeline, see set_replay
+    void set_report(std::ostream* report_) { report = report_; }
+    int get_replay_frames() const { return replay_frames; }
+    int get_replay_broken_rules() const { return replay_broken_rules; }
+    // checks of both engines and those which differ, with rule_engine=compare
+    int get_compared_checks() const { return compared_checks; }
+    int get_divergent_checks() const { return divergent_checks; }
     static log4cxx::LoggerPtr logger;
 
 signals:
@@ -26,7 +46,58 @@ signals:
     void new_broken_rule(Broken_Rule*);
 
 private:
-    char* argv_tmp[];
+    // world model for the foreign predicates ball_location/7 and roboter/7,
+    // they read it from the instance running in the calling thread
+    World_Snapshot world;
+    static foreign_t pl_ball_location(term_t, int, control_t);
+    static foreign_t pl_roboter(term_t, int, control_t);
+    // derived facts of the snapshot, see rule_memo.h
+    Rule_Memo memo;
+    static foreign_t pl_ball_in_field(term_t, int, control_t);
+    static foreign_t pl_ball_in_goal(term_t, int, control_t);
+    static foreign_t pl_robot_ball_distance(term_t, int, control_t);
+    static foreign_t pl_robot_def_area_distance(term_t, int, control_t);
+    static foreign_t pl_robot_goal_distance(term_t, int, control_t);
+
+    // bound of the broken rules kept for the GUI
+    enum {
+        MAX_RECENT_BROKEN_RULES = 32
+    };
+
+    // rule_engine from config: prolog, native or compare (both, prolog decides)
+    enum Rule_Engine {
+        PROLOG_ENGINE, NATIVE_ENGINE, COMPARE_ENGINES
+    };
+    Rule_Engine rule_engine;
+    Native_Rules native_rules;
+    Native_Rule_Input get_native_rule_input();
+    void apply_native_result(const Native_Rule_Result&);
+    void compare_engines(int rule, const Native_Rule_Result&);
+    int compared_checks;
+    int divergent_checks;
+
+    // rule_profile from config: time every predicate call and every rule
+    bool profiling;
+    Rule_Profiler profiler;
+    // counts the SIGUSR1, every instance dumps once per signal
+    static volatile sig_atomic_t profile_dump_requested;
+    sig_atomic_t profile_dumps;
+    static void request_profile_dump(int);
+    int call_predicate(predicate_t, term_t, const char* section);
+    int call_check_rules(predicate_t check_rules, term_t broken_rule);
+
+    // record_tracked_state from config, replay see set_replay
+    std::string record_file;
+    Tracked_State_Log record_log;
+    Tracked_State_Log replay_log;
+    Tracked_State_Source* replay_source;
+    bool replaying;
+    // broken rules and ball status changes, NULL: none
+    std::ostream* report;
+    int replay_frames;
+    int replay_broken_rules;
+
+    int max_robots;
     QWaitCondition* rules_wait_condition;
     Filter_Data* filter_data;
     BSmart::Game_States* gamestate;
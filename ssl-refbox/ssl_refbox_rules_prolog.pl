@@ -6,8 +6,11 @@
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
+%All facts of the game are thread_local: every pipeline runs the rules in
+%its own engine (ssl_refbox_rules.cc) and sees only its own facts.
+
 %Position, e.g. for saving freekick position
-:- dynamic position/4.
+:- thread_local position/4.
 set_freekick_pos(Pos_x,Pos_y,Pos_z) :- 
 	not(position('freekick_pos',_,_,_)) , 
 	assert(position('freekick_pos',Pos_x,Pos_y,Pos_z)) , 
@@ -19,7 +22,7 @@ get_freekick_pos(Pos_x,Pos_y,Pos_z) :-
 	position('freekick_pos',Pos_x,Pos_y,Pos_z).
 
 %Field
-:- dynamic field/9.
+:- thread_local field/9.
 define_field(Field_width,Field_height,Goal_width,Goal_Depth,Goal_Height,Defense_radius,Defense_line,Penalty_mark) :- 
 	not(field('field',_,_,_,_,_,_,_,_)) , 
 	assert(field('field',Field_width,Field_height,Goal_width,Goal_Depth,Goal_Height,Defense_radius,Defense_line,Penalty_mark)).
@@ -46,7 +49,7 @@ define_field(Field_width,Field_height,Goal_width,Goal_Depth,Goal_Height,Defense_
 %@param CornerKick - Law 17 - 100mm
 %@param CornerKickOppRob - Law 17 - 500mm
 
-:- dynamic constants/21.
+:- thread_local constants/21.
 define_constants(OpponentsBeforeKickOff,BallOtOufPlay, OpponentAtDefArea, BallNotEnterInTime, BallNotEnterDist, DribblingTooMuch, BallTooHighIntoGoal,
 		BallSpeed, FreeKickInDefAreaFromGoal, FreeKickInDefAreaFromTouch, FreeKickInDefAreaAttack, FreeKickOtherRob, PenaltyKickOtherRob, ThrowIn,
 		ThrowInOtherRob, GoalKickFromLine, GoalKickFromTouch, GoalKickOppRob, CornerKick, CornerKickOppRob) :- 
@@ -56,25 +59,14 @@ define_constants(OpponentsBeforeKickOff,BallOtOufPlay, OpponentAtDefArea, BallNo
 		BallSpeed, FreeKickInDefAreaFromGoal, FreeKickInDefAreaFromTouch, FreeKickInDefAreaAttack, FreeKickOtherRob, PenaltyKickOtherRob, ThrowIn,
 		ThrowInOtherRob, GoalKickFromLine, GoalKickFromTouch, GoalKickOppRob, CornerKick, CornerKickOppRob)).
 
-%Ball
-set_ball_stuff(Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z,Last_touched_team,Last_touched_id,Status) :- 
-	set_ball_location(Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z) , 
-	set_ball_status(Last_touched_team,Last_touched_id,Status).
-
 %Ballvariable
-:- dynamic ball_location/7.
-set_ball_location(Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z) :- 
-	not(ball_location('ball',_,_,_,_,_,_)) ,
-	assert(ball_location('ball',Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z)) , 
-	!.
-set_ball_location(Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z) :- 
-	retract(ball_location('ball',_,_,_,_,_,_)) , 
-	assert(ball_location('ball',Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z)).
+%ball_location('ball',Pos_x,Pos_y,Pos_z,Speed_x,Speed_y,Speed_z) is a foreign predicate,
+%it reads the ball model of the current world snapshot (ssl_refbox_rules.cc)
 
 %Ball status
-:- dynamic ball_status/5.
+:- thread_local ball_status/5.
 %Variable für Abseits
-:- dynamic check_offside/1.
+:- thread_local check_offside/1.
 %Neuer Last_touched, Status += 1
 set_ball_status(Ltt_1,Ltid_1,Status) :- 
 	ball_status('ball',Ltt_2,Ltid_2,_,X) , 
@@ -116,17 +108,18 @@ get_ball_status(Ltt,Ltid,Status,Touch) :-
 	ball_status('ball',Ltt,Ltid,Status,Touch).
 
 %Robotervariable
-:- dynamic roboter/7.
-set_robot(Team,ID,Pos_x,Pos_y,Speed_x,Speed_y,Visible) :- 
-	not(roboter(Team,ID,_,_,_,_,_))  ,
-	assert(roboter(Team,ID,Pos_x,Pos_y,Speed_x,Speed_y,Visible)) , 
-	!.
-set_robot(Team,ID,Pos_x,Pos_y,Speed_x,Speed_y,Visible) :- 
-	retract(roboter(Team,ID,_,_,_,_,_)), 
-	assert(roboter(Team,ID,Pos_x,Pos_y,Speed_x,Speed_y,Visible)).
+%roboter(Team,ID,Pos_x,Pos_y,Speed_x,Speed_y,Visible) is a foreign predicate,
+%it enumerates the seen robots of the current world snapshot (ssl_refbox_rules.cc)
+
+%Maximum number of robots per team (Division B: 6, Division A: 8),
+%set by every engine with set_max_robots
+:- thread_local max_robots/1.
+set_max_robots(Max) :- 
+	retractall(max_robots(_)) , 
+	assert(max_robots(Max)).
 
 %Roboter who breaks the rule
-:- dynamic rule_breaker/3.
+:- thread_local rule_breaker/3.
 set_rule_breaker(Team,ID) :- 
 	not(rule_breaker('rule_breaker',_,_)) ,
 	assert(rule_breaker('rule_breaker',Team,ID)) , 
@@ -138,7 +131,7 @@ get_rule_breaker(Team,ID) :-
 	rule_breaker('rule_breaker',Team,ID).
 
 %timestamp
-:- dynamic timestamp/2.
+:- thread_local timestamp/2.
 %aktueller Timestamp gesetzt von außen
 set_timestamp(Timestamp) :- 
 	not(timestamp('timestamp',_)) , 
@@ -303,7 +296,7 @@ get_blue_timeout_total(Timediff) :-
 	timestamp('timeout_time_blue',Timediff).
 
 %Timeouts
-:- dynamic timeouts/3.
+:- thread_local timeouts/3.
 
 %called from outside
 start_yellow_timeout :- 
@@ -338,10 +331,10 @@ end_blue_timeout     :-
 	assert(timestamp('timeout_start_blue',0)).
 
 %play_state: global_play_state, local_play_state, local_next_play_state
-:- dynamic play_state/2.
-:- dynamic left_team/2.
-:- dynamic goalie/3.
-:- dynamic result/3.
+:- thread_local play_state/2.
+:- thread_local left_team/2.
+:- thread_local goalie/3.
+:- thread_local result/3.
 
 %called from outside
 get_standing(X,Y) :- 
@@ -398,6 +391,27 @@ check_rules(X) :- rule_one , ! , X is 1.
 check_rules(X) :- rule_fourtytwo , ! , X is 42.
 %check_rules(X) :- rule_twentyfour , ! , X is 24.
 
+%State for the native rule check (native_rules.cc), unknown teams and ids are -1
+%called from outside
+get_rule_state(Local,Left,Left_goalie_team,Left_goalie_id,Right_goalie_team,Right_goalie_id,Ltt,Ltid,Status,Touch,Offside) :- 
+	get_local_play_state(Local) , 
+	( get_left(Left) ; Left = -1 ) , 
+	( goalie('left_goalie',Left_goalie_team,Left_goalie_id) ; (Left_goalie_team = -1 , Left_goalie_id = -1) ) , 
+	( goalie('right_goalie',Right_goalie_team,Right_goalie_id) ; (Right_goalie_team = -1 , Right_goalie_id = -1) ) , 
+	get_ball_status(Ltt,Ltid,Status,Touch) , 
+	check_offside(Offside) , 
+	!.
+get_timeout_state(Start_yellow,Start_blue,Total_yellow,Total_blue,Yellow,Blue) :- 
+	get_timeout_start_yellow(Start_yellow) , 
+	get_timeout_start_blue(Start_blue) , 
+	( get_yellow_timeout_total(Total_yellow) ; Total_yellow = 0 ) , 
+	( get_blue_timeout_total(Total_blue) ; Total_blue = 0 ) , 
+	timeouts('timeouts',Yellow,Blue) , 
+	!.
+reset_check_offside :- 
+	retract(check_offside(_)) , 
+	assert(check_offside(0)).
+
 %Starten des Spiels (nur wenn der Ball liegt = Regel31 + 21)
 %aus stopped in before
 start_game :- 
@@ -594,23 +608,21 @@ find_goalies :-
 	find_left_goalie , 
 	find_right_goalie.
 find_left_goalie :- 
-	field('field',Field_width,_,_,_,_,_,_,_) , 
 	left_team('left_team',Left_team) , 
-	roboter(Left_team,Id1,Pos_x1,Pos_y1,_,_,1) , 
-	distance(Pos_x1,Pos_y1,-(Field_width/2),0,Dist1) , 
-	not((roboter(Left_team,Id2,Pos_x2,Pos_y2,_,_,1) , 
+	roboter(Left_team,Id1,_,_,_,_,1) , 
+	robot_goal_distance(Left_team,Id1,Dist1,_) , 
+	not((roboter(Left_team,Id2,_,_,_,_,1) , 
 	Id1 =\= Id2 , 
-	distance(Pos_x2,Pos_y2,-(Field_width/2),0,Dist2) , Dist2 < Dist1)) , 
+	robot_goal_distance(Left_team,Id2,Dist2,_) , Dist2 < Dist1)) , 
 	set_left_goalie(Left_team,Id1).
 find_right_goalie :- 
-	field('field',Field_width,_,_,_,_,_,_,_) , 
 	left_team('left_team',Left_team) , 
-	roboter(Team,Id1,Pos_x1,Pos_y1,_,_,1) , 
+	roboter(Team,Id1,_,_,_,_,1) , 
 	Team =\= Left_team , 
-	distance(Pos_x1,Pos_y1,(Field_width/2),0,Dist1) , 
-	not((roboter(Team,Id2,Pos_x2,Pos_y2,_,_,1) , 
+	robot_goal_distance(Team,Id1,_,Dist1) , 
+	not((roboter(Team,Id2,_,_,_,_,1) , 
 	Id1 =\= Id2 , 
-	distance(Pos_x2,Pos_y2,(Field_width/2),0,Dist2) , Dist2 < Dist1)) , 
+	robot_goal_distance(Team,Id2,_,Dist2) , Dist2 < Dist1)) , 
 	set_right_goalie(Team,Id1).
 set_left_goalie(Team, Id) :- 
 	not(goalie('left_goalie',_,_)) ,
@@ -628,6 +640,11 @@ set_right_goalie(Team, Id) :-
 	assert(goalie('right_goalie',Team,Id)).
 
 %testing and helping
+%Derived facts of the current world snapshot are foreign predicates, computed
+%at most once per snapshot and only for robots that moved (rule_memo.cc):
+%ball_in_field, ball_in_goal(Side), robot_ball_distance(Team,ID,Dist),
+%robot_def_area_distance(Team,ID,Dist_left,Dist_right),
+%robot_goal_distance(Team,ID,Dist_left,Dist_right)
 distance(X1,Y1,X2,Y2,Dist) :- 
 	Dist is sqrt((X2-X1)*(X2-X1)+(Y2-Y1)*(Y2-Y1)).
 distance_to_left_def_area(X1,Y1,Dist) :- 
@@ -677,9 +694,7 @@ rule_thirty_before :-
 
 rule_thirty :- 
 	rule_thirty_before , 
-	field('field',Field_width,Field_height,_,_,_,_,_,_) , 
-	ball_location('ball',Pos_x,Pos_y,_,_,_,_) , 
-	not(ball_in_game(Field_width,Field_height,Pos_x,Pos_y)) , 
+	not(ball_in_field) , 
 	rule_thirty_after.
 
 rule_thirty_after :- 
@@ -804,9 +819,8 @@ goal_out_right(Pos_x,Pos_y,Last_touched_team) :-
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 rule_sixteen :- 
 	get_local_play_state(1) , 
-	roboter(Team,ID,Pos_x_bot,Pos_y_bot,_,_,1) , 
-	ball_location('ball',Pos_x_ball,Pos_y_ball,_,_,_,_) , 
-	distance(Pos_x_bot,Pos_y_bot,Pos_x_ball,Pos_y_ball,Dist) , 
+	roboter(Team,ID,_,_,_,_,1) , 
+	robot_ball_distance(Team,ID,Dist) , 
 	Dist < 500 , 
 	set_rule_breaker(Team,ID).
 
@@ -839,28 +853,27 @@ rule_fifteen :-
 	rule_fifteen_before , 
 	rule_fifteen_distance_to_opp_defence_area.
 rule_fifteen_distance_to_ball :- 
-	roboter(Team,ID,Pos_x_bot,Pos_y_bot,_,_,1) , 
+	roboter(Team,ID,_,_,_,_,1) , 
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,FreeKickOtherRob,_,_,_,_,_,_,_,_) ,
 	Team =:= 0 , 
 	freekick_blue , 
-	ball_location('ball',Pos_x_ball,Pos_y_ball,_,_,_,_) , 
-	distance(Pos_x_bot,Pos_y_bot,Pos_x_ball,Pos_y_ball,Dist) , 
+	robot_ball_distance(Team,ID,Dist) , 
 	Dist < FreeKickOtherRob , 
 	set_rule_breaker(Team,ID).
 rule_fifteen_distance_to_ball :- 
-	roboter(Team,ID,Pos_x_bot,Pos_y_bot,_,_,1) , 
+	roboter(Team,ID,_,_,_,_,1) , 
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,FreeKickOtherRob,_,_,_,_,_,_,_,_) ,
 	Team =:= 1 , 
 	freekick_yellow , 
-	ball_location('ball',Pos_x_ball,Pos_y_ball,_,_,_,_) , 
-	distance(Pos_x_bot,Pos_y_bot,Pos_x_ball,Pos_y_ball,Dist) , 
+	robot_ball_distance(Team,ID,Dist) , 
 	Dist < FreeKickOtherRob , 
 	set_rule_breaker(Team,ID).
 rule_fifteen_distance_to_opp_defence_area :- 
-	roboter(Team,ID,Pos_x,Pos_y,_,_,1) ,
+	roboter(Team,ID,_,_,_,_,1) ,
 	get_left(Left_team) ,
-	( (Left_team =:= Team , distance_to_right_def_area(Pos_x,Pos_y,Dist)) ;
-		(Left_team =\= Team , distance_to_left_def_area(Pos_x,Pos_y,Dist)) ) ,
+	robot_def_area_distance(Team,ID,Dist_left,Dist_right) ,
+	( (Left_team =:= Team , Dist = Dist_right) ;
+		(Left_team =\= Team , Dist = Dist_left) ) ,
 	Dist =< 200 ,
 	set_rule_breaker(Team,ID).
 
@@ -890,26 +903,22 @@ rule_fourteen :-
 rule_three :- 
 	(check_left_goalie ; check_right_goalie).
 check_left_goalie :- 
-	field('field',Field_width,_,_,_,_,_,_,_) , 
 	get_left(Left_team) , 
 	goalie('left_goalie',Left_team,Id1) , 
-	roboter(Left_team,Id1,Pos_x1,Pos_y1,_,_,1) , 
-	distance(Pos_x1,Pos_y1,-(Field_width/2),0,Dist1) , 
-	roboter(Left_team,Id2,Pos_x2,Pos_y2,_,_,1) , 
+	robot_goal_distance(Left_team,Id1,Dist1,_) , 
+	roboter(Left_team,Id2,_,_,_,_,1) , 
 	Id1 =\= Id2 , 
-	distance(Pos_x2,Pos_y2,-(Field_width/2),0,Dist2) , 
+	robot_goal_distance(Left_team,Id2,Dist2,_) , 
 	Dist2 < Dist1 , 
 	set_rule_breaker(Left_team,Id2).
 check_right_goalie :- 
-	field('field',Field_width,_,_,_,_,_,_,_) , 
 	get_left(Left_team) , 
 	goalie('right_goalie',Team,Id1) , 
 	Team =\= Left_team , 
-	roboter(Team,Id1,Pos_x1,Pos_y1,_,_,1) , 
-	distance(Pos_x1,Pos_y1,(Field_width/2),0,Dist1) , 
-	roboter(Team,Id2,Pos_x2,Pos_y2,_,_,1) , 
+	robot_goal_distance(Team,Id1,_,Dist1) , 
+	roboter(Team,Id2,_,_,_,_,1) , 
 	Id1 =\= Id2 , 
-	distance(Pos_x2,Pos_y2,(Field_width/2),0,Dist2) , 
+	robot_goal_distance(Team,Id2,_,Dist2) , 
 	Dist2 < Dist1 , 
 	set_rule_breaker(Team,Id2).
 
@@ -919,21 +928,9 @@ check_right_goalie :-
 %% nur im running, nur wenn oft genug berührt und nur wenn nicht Flying (Also auch Regel 13 erfüllt)			%%
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 ball_in_right_goal :- 
-	field('field',Field_width,_,Goal_width,Goal_Depth,Goal_Height,_,_,_) , 
-	ball_location('ball',Pos_x,Pos_y,Pos_z,_,_,_) , 
-	Pos_x > (Field_width/2) , 
-	Pos_x < ((Field_width/2)+Goal_Depth) , 
-	Pos_y > -(Goal_width/2) , 
-	Pos_y < (Goal_width/2) , 
-	Pos_z < Goal_Height.
+	ball_in_goal(1).
 ball_in_left_goal :- 
-	field('field',Field_width,_,Goal_width,Goal_Depth,Goal_Height,_,_,_) , 
-	ball_location('ball',Pos_x,Pos_y,Pos_z,_,_,_) , 
-	Pos_x < -(Field_width/2) , 
-	Pos_x > -((Field_width/2)+Goal_Depth) , 
-	Pos_y > -(Goal_width/2) , 
-	Pos_y < (Goal_width/2) , 
-	Pos_z < Goal_Height.
+	ball_in_goal(0).
 second_touch :- 
 	ball_status('ball',Ltt,Ltid,Status,X) , 
 	Status =\= 3 , 
@@ -1006,7 +1003,7 @@ penalty_blue_on_left_goal :-
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,_,PenaltyKickOtherRob,_,_,_,_,_,_,_) ,
 	Min_dist is ((-(Field_width))+Penalty_mark+PenaltyKickOtherRob) , 
 	not((roboter(1,_,Pos_x_kicker,_,_,_,1) , Pos_x_kicker < Min_dist)) , 
-	set_rule_breaker(1,12).
+	set_rule_breaker(1,-1).
 penalty_blue_on_left_goal :- 
 	field('field',Field_width,_,_,_,_,_,_,Penalty_mark) , 
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,_,PenaltyKickOtherRob,_,_,_,_,_,_,_) ,
@@ -1034,7 +1031,7 @@ penalty_yellow_on_left_goal :-
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,_,PenaltyKickOtherRob,_,_,_,_,_,_,_) ,
 	Min_dist is ((-(Field_width))+Penalty_mark+PenaltyKickOtherRob) , 
 	not((roboter(0,_,Pos_x_kicker,_,_,_,1) , Pos_x_kicker < Min_dist)) , 
-	set_rule_breaker(0,12).
+	set_rule_breaker(0,-1).
 penalty_yellow_on_left_goal :- 
 	field('field',Field_width,_,_,_,_,_,_,Penalty_mark) , 
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,_,PenaltyKickOtherRob,_,_,_,_,_,_,_) ,
@@ -1063,7 +1060,7 @@ penalty_blue_on_right_goal :-
 	Min_dist is (Field_width-Penalty_mark-PenaltyKickOtherRob) , 
 	not((roboter(1,_,Pos_x_kicker,_,_,_,1) , 
 	Pos_x_kicker > Min_dist)) , 
-	set_rule_breaker(1,12).
+	set_rule_breaker(1,-1).
 penalty_blue_on_right_goal :- 
 	field('field',Field_width,_,_,_,_,_,_,Penalty_mark) , 
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,_,PenaltyKickOtherRob,_,_,_,_,_,_,_) ,
@@ -1092,7 +1089,7 @@ penalty_yellow_on_right_goal :-
 	Min_dist is (Field_width-Penalty_mark-PenaltyKickOtherRob) , 
 	not((roboter(0,_,Pos_x_kicker,_,_,_,1) , 
 	Pos_x_kicker > Min_dist)) , 
-	set_rule_breaker(0,12).
+	set_rule_breaker(0,-1).
 penalty_yellow_on_right_goal :- 
 	field('field',Field_width,_,_,_,_,_,_,Penalty_mark) , 
 	constants('constants',_,_,_,_,_,_,_,_,_,_,_,_,PenaltyKickOtherRob,_,_,_,_,_,_,_) ,
@@ -1113,14 +1110,14 @@ rule_twentyeight :-
 	get_timeout_start_yellow(Start) , 
 	Start =\= 0 , 
 	get_timestamp(Timestamp) , 
-	get_timeout_time_yellow(Old) , 
+	( get_yellow_timeout_total(Old) ; Old = 0 ) , 
 	New is Old+(Timestamp-Start) , 
 	New > 300000.
 rule_twentyeight :- 
 	get_timeout_start_blue(Start) , 
 	Start =\= 0 , 
 	get_timestamp(Timestamp) , 
-	get_timeout_time_blue(Old) , 
+	( get_blue_timeout_total(Old) ; Old = 0 ) , 
 	New is Old+(Timestamp-Start) , 
 	New > 300000.
 
@@ -1159,17 +1156,17 @@ rule_twentyfour :-
 rule_eighteen :- 
 	get_local_play_state(2) , 
 	goalie('left_goalie',Team,Id1) , 
-	roboter(Team,Id2,Pos_x2,Pos_y2,_,_,1) , 
+	roboter(Team,Id2,_,_,_,_,1) , 
 	Id1 =\= Id2 , 
-	distance_to_left_def_area(Pos_x2,Pos_y2,Dist) , 
+	robot_def_area_distance(Team,Id2,Dist,_) , 
 	Dist < 0 , 
 	set_rule_breaker(Team,Id2).
 rule_eighteen :- 
 	get_local_play_state(2) , 
 	goalie('right_goalie',Team,Id1) , 
-	roboter(Team,Id2,Pos_x2,Pos_y2,_,_,1) , 
+	roboter(Team,Id2,_,_,_,_,1) , 
 	Id1 =\= Id2 , 
-	distance_to_right_def_area(Pos_x2,Pos_y2,Dist) , 
+	robot_def_area_distance(Team,Id2,_,Dist) , 
 	Dist < 0 , 
 	set_rule_breaker(Team,Id2).
 
@@ -1198,7 +1195,7 @@ rule_nineteen :-
 	roboter(Team1,Id1,Pos_x1,Pos_y1,_,_,1) , 
 	roboter(Team2,Id2,Pos_x2,Pos_y2,_,_,1) , 
 	Team1 =\= Team2 , 
-	distance_to_left_def_area(Pos_x2,Pos_y2,Dist1) , 
+	robot_def_area_distance(Team2,Id2,Dist1,_) , 
 	Dist1 < 0 , 
 	distance(Pos_x1,Pos_y1,Pos_x2,Pos_y2,Dist2) , 
 	Dist2 < 200 , 
@@ -1214,7 +1211,7 @@ rule_nineteen :-
 	roboter(Team1,Id1,Pos_x1,Pos_y1,_,_,1) , 
 	roboter(Team2,Id2,Pos_x2,Pos_y2,_,_,1) , 
 	Team1 =\= Team2 , 
-	distance_to_right_def_area(Pos_x2,Pos_y2,Dist1) , 
+	robot_def_area_distance(Team2,Id2,_,Dist1) , 
 	Dist1 < 0 , 
 	distance(Pos_x1,Pos_y1,Pos_x2,Pos_y2,Dist2) , 
 	Dist2 < 200 , 
@@ -1239,19 +1236,17 @@ rule_twentytwo :-
 	set_rule_breaker(Ltt,Ltid).
 
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%% Regel1: Es sind nur max 6 Roboter pro Team erlaubt									%%
+%% Regel1: Es sind nur max_robots Roboter pro Team erlaubt								%%
 %% coresspond to law 3: The Number of Robots										%%
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 rule_one :- rule_one(0) ; rule_one(1).
 rule_one(Team) :- 
-	roboter(Team,ID1,_,_,_,_,1) , 
-	roboter(Team,ID2,_,_,_,_,1) , ID1 =\= ID2 ,
-	roboter(Team,ID3,_,_,_,_,1) , ID1 =\= ID3 , ID2 =\= ID3 ,
-	roboter(Team,ID4,_,_,_,_,1) , ID1 =\= ID4 , ID2 =\= ID4 , ID3 =\= ID4 ,
-	roboter(Team,ID5,_,_,_,_,1) , ID1 =\= ID5 , ID2 =\= ID5 , ID3 =\= ID5 , ID4 =\= ID5 ,
-	roboter(Team,ID6,_,_,_,_,1) , ID1 =\= ID6 , ID2 =\= ID6 , ID3 =\= ID6 , ID4 =\= ID6 , ID5 =\= ID6 ,
-	roboter(Team,ID7,_,_,_,_,1) , ID1 =\= ID7 , ID2 =\= ID7 , ID3 =\= ID7 , ID4 =\= ID7 , ID5 =\= ID7 , ID6 =\= ID7 ,
-	set_rule_breaker(Team,ID7).	
+	max_robots(Max) , 
+	findall(ID,roboter(Team,ID,_,_,_,_,1),IDs) , 
+	length(IDs,Number) , 
+	Number > Max , 
+	last(IDs,Last_id) , 
+	set_rule_breaker(Team,Last_id).	
 	
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %% Regel42: Abseits													%%
@@ -12,6 +12,10 @@
 #include <string>
 #include "../ConfigFile/ConfigFile.h"
 #include "global.h"
+#include "rule_profiler.h"
+#include "latency_histogram.h"
+#include "trace.h"
+#include "async_log.h"
 
 // log4cxx
 using namespace log4cxx;
@@ -24,9 +28,14 @@ LoggerPtr SSLVision::logger(Logger::getLogger("SSLVision"));
  * @param data_
  * @param gamestate_
  * @param new_data_wait_condition_
+ * @param config settings of the pipeline
+ * @param start_log_ log file to play on start, empty for live vision
  */
-SSLVision::SSLVision(Pre_Filter_Data* data_, BSmart::Game_States* gamestate_, QWaitCondition* new_data_wait_condition_) :
-                data(data_), gamestate(gamestate_) {
+SSLVision::SSLVision(Pre_Filter_Data* data_, BSmart::Game_States* gamestate_, QWaitCondition* new_data_wait_condition_,
+                const ConfigFile& config, const QString& start_log_) :
+                data(data_), gamestate(gamestate_),
+                // robots with higher ids are ignored
+                decoder(data_, config.read<int>("robot_ids", Filter_Data::NUMBER_OF_IDS)), start_log(start_log_) {
         LOG4CXX_DEBUG( logger, "create SSLVisison object");
 
         std::ostringstream o;
@@ -36,8 +45,8 @@ SSLVision::SSLVision(Pre_Filter_Data* data_, BSmart::Game_States* gamestate_, QW
         robot_r = 20;
         string message = "";
 
-        cam_height = Global::config.read<int>("cam_height", 580);
-        cam_width = Global::config.read<int>("cam_width", 780);
+        cam_height = config.read<int>("cam_height", 580);
+        cam_width = config.read<int>("cam_width", 780);
         o.str("");
         o << "cam_height=" << cam_height << " cam_width=" << cam_width;
         LOG4CXX_INFO( logger, o.str());
@@ -45,8 +54,8 @@ SSLVision::SSLVision(Pre_Filter_Data* data_, BSmart::Game_States* gamestate_, QW
         socket = 0;
         buffer = new char[MaxDataGramSize];
 
-        string ssl_vision_ip = Global::config.read<string>("ssl_vision_ip", "224.5.23.2");
-        uint16_t ssl_vision_port = Global::config.read<uint16_t>("ssl_vision_port", 40101);
+        string ssl_vision_ip = config.read<string>("ssl_vision_ip", "224.5.23.2");
+        uint16_t ssl_vision_port = config.read<uint16_t>("ssl_vision_port", 40101);
 
         o.str("");
         if (!(o << ssl_vision_port))
@@ -71,12 +80,8 @@ SSLVision::SSLVision(Pre_Filter_Data* data_, BSmart::Game_States* gamestate_, QW
         rec = false;
         play = false;
         log_control = new Log_Control();
-        reset_transformed_percept(transformed_percept);
+        Vision_Decoder::reset_transformed_percept(transformed_percept);
         standard_sleep_time = 25;
-        queue_filled = false;
-        tf_percept_queue_all.clear();
-        for (int i = 0; i < 2; i++)
-                tf_percept_queue_one_ball[i].clear();
         //    current_frame = 0;
         LOG4CXX_DEBUG( logger, "End create SSLVision");
 }
@@ -94,15 +99,23 @@ SSLVision::~SSLVision() {
  */
 void SSLVision::run() {
         LOG4CXX_DEBUG( logger, "run()");
+        Trace::set_thread_name("vision");
 
-        if (Global::logFile != NULL) {
-                play_record(Global::logFile);
+        if (!start_log.isEmpty()) {
+                play_record(start_log);
+                //could not be read
+                if (!play)
+                        end_play_record();
         }
 
         while (1) {
-                reset_transformed_percept(transformed_percept);
+                Vision_Decoder::reset_transformed_percept(transformed_percept);
                 // see if new frame has been received
+                long long execute_start = Trace::enabled() ? Rule_Profiler::now() : 0;
                 int exec = execute(transformed_percept);
+                if (exec == 1 && Trace::enabled())
+                        Trace::complete("vision_receive", execute_start, Rule_Profiler::now(),
+                                        transformed_percept.current_frame, transformed_percept.cam_id);
                 //transformed_percept.sleep_time = time;
 
                 // fill queue
@@ -113,122 +126,21 @@ void SSLVision::run() {
                 case -1: //no frame received
                         break;
                 default: // frame received
-                        // check done for heuristical reasons
-                        analyse_percepts();
-                        tf_percept_queue_all.push_back(transformed_percept);
-                }
-
-                // queue is filled when greater than 30 and will be set not filled, if below 10 again
-                if (queue_filled) {
-                        if (tf_percept_queue_all.size() < 10) {
-                                queue_filled = false;
-                                //LOG4CXX_DEBUG(logger, "queue empty");
-                        }
-                } else if (tf_percept_queue_all.size() > 30) {
-                        queue_filled = true;
-                        //LOG4CXX_DEBUG(logger, "queue filled");
+                        decoder.push(transformed_percept);
                 }
 
                 // process percept through Particle Filter and other system
-                if (queue_filled) {
-                        // take current frame out of buffer and delete it from buffer
-                        transformed_percept = tf_percept_queue_all.front();
-                        tf_percept_queue_all.erase(tf_percept_queue_all.begin());
-
-                        // if there are more with only one ball
-                        if (tf_percept_queue_one_ball[transformed_percept.cam_id].size() > 0) {
-                                // if the first is the same as the current
-                                if (transformed_percept.current_frame
-                                                == tf_percept_queue_one_ball[transformed_percept.cam_id][0].current_frame) {
-                                        // delete first and go on
-                                        tf_percept_queue_one_ball[transformed_percept.cam_id].erase(
-                                                        tf_percept_queue_one_ball[transformed_percept.cam_id].begin());
-                                        // if there is still a frame
-                                        if (tf_percept_queue_one_ball[transformed_percept.cam_id].size() > 0) {
-                                                int index = 0;
-                                                if (tf_percept_queue_one_ball[transformed_percept.cam_id].size() > 1)
-                                                        index = 1;
-                                                // prepare collision heuristic
-                                                transformed_percept.ball_direction_after =
-                                                                (tf_percept_queue_one_ball[transformed_percept.cam_id][index].balls[0]
-                                                                                - transformed_percept.balls[0]);
-                                                int timediff = tf_percept_queue_one_ball[transformed_percept.cam_id][index].frame_received
-                                                                - transformed_percept.frame_received;
-                                                if (timediff == 0) {
-                                                        transformed_percept.ball_direction_after = BSmart::Pose(0., 0., 0.);
-                                                } else {
-                                                        transformed_percept.ball_direction_after /= timediff;
-                                                }
-                                        }
-                                }
-                        }
-                        // if only one robot percept is found
-                        for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-                                for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-                                        if (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size() > 0) {
-                                                // if first is the same as current
-                                                if (transformed_percept.current_frame
-                                                                == tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][0].current_frame) {
-                                                        // delete first and go on
-                                                        tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].erase(
-                                                                        tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].begin());
-                                                        if (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size() > 0) {
-                                                                int index = 0;
-                                                                if (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size() > 1)
-                                                                        index = 1;
-
-                                                                int timediff =
-                                                                                (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][index].frame_received
-                                                                                                - transformed_percept.frame_received);
-
-                                                                if (timediff == 0) {
-                                                                        ; //robot_direction_before is used.
-                                                                } else {
-                                                                        transformed_percept.robot_direction[team][id] =
-                                                                                        (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][index].robots[team][id][0]
-                                                                                                        - transformed_percept.robots[team][id][0]);
-                                                                        transformed_percept.robot_direction[team][id] /= timediff;
-                                                                }
-                                                        }
-                                                }
-                                        }
-                                }
-                        }
-
-                        //write data from transformed_percept into pf_data
-                        reset_data(transformed_percept.cam_id);
-
-                        //set frame number
-                        data->set_newest_frame(transformed_percept.current_frame);
-                        data->set_timestamp(transformed_percept.frame_received);
-
-                        if (transformed_percept.balls.size() == 0) {
-                                data->set_ball_framenumber(transformed_percept.cam_id, transformed_percept.ball_frame_number);
-                                data->set_ball_timestamp(transformed_percept.cam_id, transformed_percept.frame_received);
-                        } else {
-                                data->clear_balls(transformed_percept.cam_id);
-                                data->set_balls(transformed_percept.cam_id, transformed_percept.balls);
-                        }
-
-                        if (transformed_percept.has_one_ball) {
-                                data->set_ball_direction_before(transformed_percept.ball_direction_before);
-                                data->set_ball_direction_after(transformed_percept.ball_direction_after);
-                        }
-
-                        for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-                                for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-                                        data->set_robots(transformed_percept.cam_id, team, id, transformed_percept.robots[team][id]);
-                                        if (transformed_percept.has_one_robot[team][id]) {
-                                                data->set_robot_direction(team, id, transformed_percept.robot_direction[team][id]);
-                                        }
-                                }
-                        }
-
+                if (decoder.pop(transformed_percept)) {
                         if (play) {
                                 emit new_refbox_cmd(transformed_percept.refbox_cmd[0]);
                                 emit update_frame(transformed_percept.current_frame);
                         }
 
+                        long long queued_us = Rule_Profiler::now();
+                        Metrics::vision_receive.record(queued_us - transformed_percept.received_us);
+                        data->set_latency_stamps(transformed_percept.received_us, queued_us);
+                        Trace::instant("wake_filter", transformed_percept.current_frame);
+
                         new_data_wait_condition->wakeAll();
                         emit
                         new_frame();
@@ -257,19 +169,15 @@ int SSLVision::execute(Transformed_Percept& trans_perc) {
                 //test camera_id
                 if (frame.camera_id() > 1) {
                         trans_perc.sleep_time = standard_sleep_time;
-                        std::ostringstream o;
-                        o << "Got Percept from CAM: ";
-                        o << frame.camera_id();
-                        LOG4CXX_DEBUG( logger, o.str());
+                        Async_Log::debug(logger, "Got Percept from CAM: {}", frame.camera_id());
                         return -2;
                 }
                 npc = 0;
 
                 // process frame
                 trans_perc.frame_received = frame.t_capture();
-                process_balls(trans_perc);
-                process(trans_perc, 1); // blue
-                process(trans_perc, 0); // yellow
+                trans_perc.received_us = Rule_Profiler::now();
+                decoder.decode(frame, trans_perc);
 
                 if (rec) {
                         logs.add_log();
@@ -302,9 +210,8 @@ int SSLVision::execute(Transformed_Percept& trans_perc) {
 
                         // process frame
                         trans_perc.frame_received = BSmart::Systemcall::get_current_system_time();
-                        process_balls(trans_perc);
-                        process(trans_perc, 1); // blue
-                        process(trans_perc, 0); // yellow
+                        trans_perc.received_us = Rule_Profiler::now();
+                        decoder.decode(frame, trans_perc);
                 }
 
                 trans_perc.current_frame = log_control->get_current_frame();
@@ -365,6 +272,9 @@ int SSLVision::recv(SSL_DetectionFrame& frame) {
                 for (int i = 0; i < n_cams; ++i) {
                         SSL_GeometryCameraCalibration cam = geo_data.calib(i);
                         int camID = cam.camera_id();
+                        // only two cameras are tracked, as in execute
+                        if (camID > 1)
+                                continue;
                         BSmart::Pose3D cam_pos(cam.derived_camera_world_tx(), cam.derived_camera_world_ty(),
                                         cam.derived_camera_world_tz());
                         data->set_camera_pos(camID, cam_pos);
@@ -382,194 +292,6 @@ int SSLVision::recv(SSL_DetectionFrame& frame) {
         }
 }
 
-/**
- * @brief Process ball(s) by assigning trans_perc values to the Ball Percept
- * @param trans_perc
- */
-void SSLVision::process_balls(Transformed_Percept& trans_perc) {
-        int n_balls = frame.balls_size();
-        Ball_Percept pBall;
-
-        trans_perc.cam_id = frame.camera_id();
-
-        if (n_balls == 0) {
-                trans_perc.ball_frame_number = frame.frame_number();
-        } else {
-                for (int i = 0; i < n_balls; ++i) {
-                        SSL_DetectionBall ball = frame.balls(i);
-                        pBall.x = ball.x();
-                        pBall.y = ball.y();
-                        pBall.confidence = ball.confidence() * 100;
-                        pBall.framenumber = frame.frame_number();
-                        pBall.cam = frame.camera_id();
-                        pBall.timestamp = frame.t_capture() * 1000;
-
-                        if (!(pBall.x == 0. && pBall.y == 0.))
-                                trans_perc.balls.push_back(pBall);
-                }
-        }
-}
-
-/**
- * @brief Process robots of the team with the given color.
- * Create a robot percept and assign to it the values from the trans_perc.<br />
- * @param trans_perc Transformed_Percept
- * @param color 1 -> blue, 0 -> yellow
- */
-void SSLVision::process(Transformed_Percept& trans_perc, char color) {
-        int n_bots = color == 1 ? frame.robots_blue_size() : frame.robots_yellow_size();
-
-        for (int i = 0; i < n_bots; ++i) {
-                SSL_DetectionRobot robot = color == 1 ? frame.robots_blue(i) : frame.robots_yellow(i);
-
-                /* following code doesn't work anymore...
-                 * It seems, that it expects the origin of coordinates not in the
-                 * middle of the field and thus are not negative...
-                 * Anyway, without this code, everything runs fine :)
-                 */
-//              if ( (robot.pixel_y() + robot_r > cam_height)
-//              || (robot.pixel_y() - robot_r < 0)
-//              || (robot.pixel_x() + robot_r > cam_width)
-//              || (robot.pixel_x() - robot_r < 0) ) {
-//              continue;
-//              }
-                Robot_Percept pRobot;
-                pRobot.x = robot.x();
-                pRobot.y = robot.y();
-                pRobot.id = robot.robot_id();
-                pRobot.color = color == 1 ? SSLRefbox::Colors::BLUE : SSLRefbox::Colors::YELLOW;
-                pRobot.rotation_known = robot.has_orientation();
-                if (pRobot.rotation_known) {
-                        pRobot.rotation = robot.orientation();
-                        //LOG4CXX_DEBUG(logger, pRobot.rotation);
-                }
-
-                pRobot.confidence = robot.confidence() * 100;
-                pRobot.framenumber = frame.frame_number();
-                pRobot.cam = frame.camera_id();
-                pRobot.timestamp = frame.t_capture() * 1000;
-
-                trans_perc.robots[(int) color][pRobot.id].push_back(pRobot);
-        }
-}
-
-/**
- * @brief Reset data (balls and robots)
- * @param cam Camera id
- */
-void SSLVision::reset_data(int cam) {
-        //LOG4CXX_DEBUG ( logger, "reset_data" );
-        //Ball_Percept pBall;
-        //clear ball vector
-        data->clear_balls(cam);
-        //clear robots
-        data->clear_robots(cam);
-}
-
-/**
- * @brief Reset everything in tranformed_percept.
- * @param trans_perc
- */
-void SSLVision::reset_transformed_percept(Transformed_Percept& trans_perc) {
-        trans_perc.cam_id = 0;
-        trans_perc.ball_frame_number = 0;
-        trans_perc.balls.clear();
-        trans_perc.has_one_ball = false;
-        trans_perc.ball_direction_before.x = 0.;
-        trans_perc.ball_direction_before.y = 0.;
-        trans_perc.ball_direction_after.x = 0.;
-        trans_perc.ball_direction_after.y = 0.;
-
-        for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-                for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-                        trans_perc.robots[team][id].clear();
-                        trans_perc.has_one_robot[team][id] = false;
-                        trans_perc.robot_direction[team][id].x = 0.;
-                        trans_perc.robot_direction[team][id].y = 0.;
-                }
-        }
-
-        trans_perc.refbox_cmd = "";
-        trans_perc.current_frame = 0;
-        trans_perc.sleep_time = 0;
-        trans_perc.frame_received = 0;
-}
-
-/**
- * @brief Analyze transformed_percept and set some values
- * Robots and ball will be analyzed.
- */
-void SSLVision::analyse_percepts() {
-
-        // if only one ball in percept found
-        if (transformed_percept.balls.size() == 1) {
-                transformed_percept.has_one_ball = true;
-
-                int size_one_ball = tf_percept_queue_one_ball[transformed_percept.cam_id].size();
-
-                if (size_one_ball == 1) {
-                        transformed_percept.ball_direction_before = (transformed_percept.balls[0]
-                                        - tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].balls[0]);
-                        int timediff = (transformed_percept.frame_received
-                                        - tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].frame_received);
-
-                        if (timediff == 0) {
-                                transformed_percept.ball_direction_before =
-                                                tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].ball_direction_before;
-                        } else {
-                                transformed_percept.ball_direction_before /= timediff;
-                        }
-                } else if (size_one_ball > 1) {
-                        int diff = 2;
-                        if (size_one_ball > 2)
-                                diff = 3;
-                        transformed_percept.ball_direction_before =
-                                        (tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].balls[0]
-                                                        - tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - diff].balls[0]);
-                        int timediff = (tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].frame_received
-                                        - tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - diff].frame_received);
-
-                        if (timediff == 0) {
-                                transformed_percept.ball_direction_before =
-                                                tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - diff].ball_direction_before;
-                        } else {
-                                transformed_percept.ball_direction_before /= timediff;
-                        }
-
-                }
-                tf_percept_queue_one_ball[transformed_percept.cam_id].push_back(transformed_percept);
-        }
-
-        //if only one robot percept per robot is found
-        for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
-                for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
-                        if (transformed_percept.robots[team][id].size() == 1) {
-                                transformed_percept.has_one_robot[team][id] = true;
-
-                                int size_one_robot = tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size();
-                                if (size_one_robot > 0) {
-                                        transformed_percept.robot_direction[team][id] =
-                                                        (transformed_percept.robots[team][id][0]
-                                                                        - tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][size_one_robot
-                                                                                        - 1].robots[team][id][0]);
-                                        int timediff =
-                                                        (transformed_percept.frame_received
-                                                                        - tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][size_one_robot
-                                                                                        - 1].frame_received);
-
-                                        if (timediff == 0) {
-                                                transformed_percept.robot_direction[team][id] =
-                                                                tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][size_one_robot - 1].robot_direction[team][id];
-                                        } else {
-                                                transformed_percept.robot_direction[team][id] /= timediff;
-                                        }
-                                }
-                                tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].push_back(transformed_percept);
-                        }
-                }
-        }
-}
-
 /**
  * @brief Start or stop record depending on `rec` and `play` flags
  */
@@ -740,12 +462,14 @@ void SSLVision::end_play_record() {
         play = false;
         log_control->reset(0);
         //    current_frame = 0;
-        reset_data(0);
-        reset_data(1);
+        decoder.reset_data(0);
+        decoder.reset_data(1);
         logs.clear_log();
         emit
         showLogControl(false);
         emit
         change_play_button("Play Record");
+        emit
+        play_record_ended();
         LOG4CXX_DEBUG( logger, "End end_play_record");
 }
@@ -16,31 +16,10 @@
 #include <libbsmart/multicast_socket.h>
 #include <libbsmart/game_states.h>
 #include "pre_filter_data.h"
+#include "vision_decoder.h"
 #include "log_control.h"
 #include <log4cxx/logger.h>
-
-/**
- * @brief data store for current data received from SSL-vision/log file
- */
-struct Transformed_Percept
-{
-    int cam_id;
-    unsigned int ball_frame_number;
-    Ball_Percept_List balls;
-    bool has_one_ball;
-    BSmart::Pose ball_direction_before;
-    BSmart::Pose ball_direction_after;
-
-    Robot_Percept_List robots[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
-    bool has_one_robot[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
-    BSmart::Pose robot_direction[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
-
-    std::string refbox_cmd;
-    int current_frame;
-    int sleep_time;
-    BSmart::Time_Value frame_received;
-
-};
+#include "../ConfigFile/ConfigFile.h"
 
 /**
  * @class SSLVision
@@ -52,7 +31,9 @@ class SSLVision : public QThread
     Q_OBJECT
 
 public:
-    SSLVision(Pre_Filter_Data*, BSmart::Game_States*, QWaitCondition*);
+    // start_log is played when the thread starts, if not empty
+    SSLVision(Pre_Filter_Data*, BSmart::Game_States*, QWaitCondition*, const ConfigFile&,
+              const QString& start_log = "");
     ~SSLVision();
     void run();
     Log_Control* log_control;
@@ -75,6 +56,8 @@ signals:
     //change Button text
     void change_record_button(QString);
     void change_play_button(QString);
+    //end of the log file or of its play, e.g. for --headless
+    void play_record_ended();
     //refboxlistener
     void new_refbox_cmd(char);
 
@@ -85,22 +68,11 @@ private:
     QWaitCondition* new_data_wait_condition;
 
     int  recv(SSL_DetectionFrame&);
-    void process_balls(Transformed_Percept&);
-    void process(Transformed_Percept&, char);
-    void process_blue(Transformed_Percept&);
-    void process_yellow(Transformed_Percept&);
-    void reset_data(int);
     int npc;
 
     BSmart::Multicast_Socket* socket;
 
-    bool queue_filled;
     Transformed_Percept transformed_percept;
-    std::vector<Transformed_Percept> tf_percept_queue_all;
-    std::vector<Transformed_Percept> tf_percept_queue_one_ball[2];
-    std::vector<Transformed_Percept> tf_percept_queue_one_robot[2][Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
-    void reset_transformed_percept(Transformed_Percept&);
-    void analyse_percepts();
 
     int robot_r;
     int cam_height;
@@ -112,6 +84,7 @@ private:
 
     Pre_Filter_Data* data;
     BSmart::Game_States* gamestate;
+    Vision_Decoder decoder;
 
     Refbox_Log logs;
 //    int current_frame;
@@ -122,6 +95,7 @@ private:
     int start_play_record(QString logFile = "");
     void end_play_record();
     QString fileName;
+    QString start_log;
 };
 
 #endif //SSLVISION
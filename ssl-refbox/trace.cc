@@ -0,0 +1,153 @@
+#include "trace.h"
+#include "rule_profiler.h"
+#include <fstream>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Trace::logger(Logger::getLogger("Trace"));
+
+volatile bool Trace::active = false;
+volatile sig_atomic_t Trace::write_requested = 0;
+volatile bool Trace::stopping = false;
+Trace::Writer* Trace::writer = 0;
+std::string Trace::file;
+QMutex Trace::buffers_mutex;
+std::vector<Trace::Buffer*> Trace::buffers;
+__thread Trace::Buffer* Trace::buffer = 0;
+
+void Trace::start(const std::string& file_) {
+	file = file_;
+	active = true;
+	signal(SIGUSR2, request_write);
+	stopping = false;
+	writer = new Writer();
+	writer->start();
+	LOG4CXX_INFO( logger, "Tracing to " + file + ", written on SIGUSR2 and at exit");
+}
+
+void Trace::stop() {
+	if (!writer)
+		return;
+	stopping = true;
+	writer->wait();
+	delete writer;
+	writer = 0;
+	write();
+}
+
+/**
+ * The buffer of a thread is created with its first event and lives until
+ * the end of the program
+ */
+Trace::Buffer* Trace::thread_buffer() {
+	if (!buffer) {
+		buffer = new Buffer();
+		buffer->tid = syscall(SYS_gettid);
+		buffer->count = 0;
+		buffers_mutex.lock();
+		buffers.push_back(buffer);
+		buffers_mutex.unlock();
+	}
+	return buffer;
+}
+
+void Trace::set_thread_name(const char* name) {
+	if (!active)
+		return;
+	Buffer* b = thread_buffer();
+	buffers_mutex.lock();
+	b->thread_name = name;
+	buffers_mutex.unlock();
+}
+
+inline void Trace::add(const Event& event) {
+	Buffer* b = thread_buffer();
+	b->events[b->count % RING_SIZE] = event;
+	// the event is complete before it is counted
+	__sync_synchronize();
+	b->count = b->count + 1;
+}
+
+void Trace::complete(const char* name, long long begin_us, long long end_us, int frame, int cam) {
+	if (!active)
+		return;
+	Event event = { name, begin_us, end_us, frame, cam };
+	add(event);
+}
+
+void Trace::instant(const char* name, int frame) {
+	if (!active)
+		return;
+	Event event = { name, Rule_Profiler::now(), -1, frame, -1 };
+	add(event);
+}
+
+void Trace::request_write(int) {
+	write_requested = 1;
+}
+
+void Trace::Writer::run() {
+	while (!stopping) {
+		msleep(200);
+		if (write_requested) {
+			write_requested = 0;
+			write();
+		}
+	}
+}
+
+/**
+ * Events a thread records while it is written may be missing, the oldest
+ * events of a full ring are skipped since they may be overwritten right now
+ */
+bool Trace::write() {
+	if (!active)
+		return false;
+	std::ofstream out(file.c_str());
+	if (!out) {
+		LOG4CXX_ERROR( logger, "Could not write " + file);
+		return false;
+	}
+	int pid = getpid();
+	bool first = true;
+	out << "{\"traceEvents\":[\n";
+	buffers_mutex.lock();
+	for (unsigned int i = 0; i < buffers.size(); ++i) {
+		Buffer* b = buffers[i];
+		if (!b->thread_name.empty()) {
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":"
+					<< b->tid << ",\"args\":{\"name\":\"" << b->thread_name << "\"}}";
+			first = false;
+		}
+		unsigned long end = b->count;
+		__sync_synchronize();
+		unsigned long begin = end > RING_SIZE - 1024 ? end - (RING_SIZE - 1024) : 0;
+		for (unsigned long n = begin; n < end; ++n) {
+			const Event& event = b->events[n % RING_SIZE];
+			out << (first ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"pid\":" << pid << ",\"tid\":"
+					<< b->tid << ",\"ts\":" << event.begin_us;
+			if (event.end_us < 0)
+				out << ",\"ph\":\"i\",\"s\":\"p\"";
+			else
+				out << ",\"ph\":\"X\",\"dur\":" << event.end_us - event.begin_us;
+			out << ",\"args\":{\"frame\":" << event.frame << ",\"cam\":" << event.cam << "}}";
+			first = false;
+		}
+	}
+	buffers_mutex.unlock();
+	out << "\n]}\n";
+	LOG4CXX_INFO( logger, "Trace written to " + file);
+	return true;
+}
+
+Trace_Scope::Trace_Scope(const char* name_, int frame_, int cam_) :
+	name(name_), frame(frame_), cam(cam_) {
+	begin_us = Trace::enabled() ? Rule_Profiler::now() : 0;
+}
+
+Trace_Scope::~Trace_Scope() {
+	if (Trace::enabled())
+		Trace::complete(name, begin_us, Rule_Profiler::now(), frame, cam);
+}
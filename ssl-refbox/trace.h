@@ -0,0 +1,95 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QMutex>
+#include <QThread>
+#include <string>
+#include <vector>
+#include <csignal>
+#include <log4cxx/logger.h>
+
+/**
+ * @class Trace
+ * @brief Timeline of the pipeline threads for chrome://tracing or Perfetto.
+ * Off unless started (trace_file in the config). Every thread records into
+ * its own ring of the last RING_SIZE events without locks. The file is
+ * written on SIGUSR2 and by stop().
+ */
+class Trace
+{
+public:
+    enum {
+        RING_SIZE = 1 << 16
+    };
+
+    static void start(const std::string& file);
+    //stops the writer thread and writes the file, before main returns
+    static void stop();
+    static bool enabled() { return active; }
+
+    //name of the calling thread in the timeline
+    static void set_thread_name(const char*);
+    //a section of the calling thread, name has to be a literal
+    static void complete(const char* name, long long begin_us, long long end_us, int frame, int cam);
+    //a point in time, e.g. a wakeAll
+    static void instant(const char* name, int frame = -1);
+
+    //JSON of all threads, false if the file could not be written
+    static bool write();
+
+private:
+    struct Event {
+        const char* name;
+        long long begin_us;
+        long long end_us; // -1: instant
+        int frame;
+        int cam;
+    };
+
+    struct Buffer {
+        int tid;
+        std::string thread_name;
+        Event events[RING_SIZE];
+        //events written, the last RING_SIZE are kept
+        volatile unsigned long count;
+    };
+
+    class Writer : public QThread
+    {
+    public:
+        void run();
+    };
+
+    static Buffer* thread_buffer();
+    static void add(const Event&);
+    static void request_write(int);
+
+    static log4cxx::LoggerPtr logger;
+    static volatile bool active;
+    static volatile sig_atomic_t write_requested;
+    static volatile bool stopping;
+    static Writer* writer;
+    static std::string file;
+    static QMutex buffers_mutex;
+    static std::vector<Buffer*> buffers;
+    static __thread Buffer* buffer;
+};
+
+/**
+ * @class Trace_Scope
+ * @brief Records the lifetime of the object as a section of the timeline
+ */
+class Trace_Scope
+{
+public:
+    Trace_Scope(const char* name_, int frame_ = -1, int cam_ = -1);
+    ~Trace_Scope();
+
+private:
+    const char* name;
+    int frame;
+    int cam;
+    long long begin_us;
+};
+
+#endif //TRACE_H
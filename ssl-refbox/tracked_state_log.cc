@@ -0,0 +1,150 @@
+#include "tracked_state_log.h"
+#include <cstring>
+
+// file format version 1
+const char Tracked_State_Log::magic[8] = { 'S', 'S', 'L', 'T', 'R', 'K', '0', '1' };
+
+Tracked_State_Log::Tracked_State_Log() {
+}
+
+Tracked_State_Log::~Tracked_State_Log() {
+	close();
+}
+
+bool Tracked_State_Log::open_write(const std::string& file) {
+	close();
+	out.open(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+	out.write(magic, sizeof(magic));
+	return out.good();
+}
+
+bool Tracked_State_Log::open_read(const std::string& file) {
+	close();
+	in.open(file.c_str(), std::ios::in | std::ios::binary);
+	if (!in)
+		return false;
+	char header[sizeof(magic)];
+	in.read(header, sizeof(header));
+	if (!in || memcmp(header, magic, sizeof(magic)) != 0) {
+		in.close();
+		return false;
+	}
+	return true;
+}
+
+void Tracked_State_Log::close() {
+	if (out.is_open())
+		out.close();
+	if (in.is_open())
+		in.close();
+}
+
+bool Tracked_State_Log::is_open() {
+	return out.is_open() || in.is_open();
+}
+
+void Tracked_State_Log::put(int value, int bytes) {
+	char buf[4];
+	for (int i = 0; i < bytes; ++i)
+		buf[i] = (char) ((value >> (8 * i)) & 0xff);
+	out.write(buf, bytes);
+}
+
+bool Tracked_State_Log::get(int& value, int bytes) {
+	unsigned char buf[4];
+	if (!in.read((char*) buf, bytes))
+		return false;
+	unsigned int tmp = 0;
+	for (int i = 0; i < bytes; ++i)
+		tmp |= (unsigned int) buf[i] << (8 * i);
+	// sign extension
+	if (bytes < 4 && (tmp & (1u << (8 * bytes - 1))))
+		tmp |= ~0u << (8 * bytes);
+	value = (int) tmp;
+	return true;
+}
+
+/**
+ * one frame:
+ * timestamp(8) frame(4) play_state(1) refbox_cmd(1)
+ * ball: pos x,y,z(4) speed x,y,z(4) status(1) last_touched(1) robot team(1) id(1)
+ * number of robots(1), each: team(1) id(1) pos x,y(4) rotation mrad(2) speed x,y(4)
+ */
+void Tracked_State_Log::write(const Tracked_State& state) {
+	if (!out.is_open())
+		return;
+	const World_Snapshot& world = state.world;
+	put((int) (world.timestamp & 0xffffffff), 4);
+	put((int) (world.timestamp >> 32), 4);
+	put(world.frame, 4);
+	put(state.play_state, 1);
+	put(state.refbox_cmd, 1);
+
+	const Ball_Sample& ball = world.ball_model;
+	put((int) ball.pos.x, 4);
+	put((int) ball.pos.y, 4);
+	put((int) ball.pos.z, 4);
+	put((int) ball.speed.x, 4);
+	put((int) ball.speed.y, 4);
+	put((int) ball.speed.z, 4);
+	put(ball.status, 1);
+	put(ball.last_touched, 1);
+	put(ball.last_touched_robot.x, 1);
+	put(ball.last_touched_robot.y, 1);
+
+	put(world.robot_models.size(), 1);
+	for (Robot_Sample_List::const_iterator it = world.robot_models.begin(); it != world.robot_models.end(); ++it) {
+		put(it->team, 1);
+		put(it->id, 1);
+		put((int) it->pos.x, 4);
+		put((int) it->pos.y, 4);
+		put((int) (it->pos.rotation * 1000), 2);
+		put((int) it->speed.x, 4);
+		put((int) it->speed.y, 4);
+	}
+}
+
+bool Tracked_State_Log::read(Tracked_State& state) {
+	if (!in.is_open())
+		return false;
+	World_Snapshot& world = state.world;
+	int low, high, value;
+	int x, y, z;
+	if (!get(low, 4) || !get(high, 4))
+		return false;
+	world.timestamp = ((BSmart::Time_Value) high << 32) | (unsigned int) low;
+	bool ok = get(world.frame, 4);
+	ok = ok && get(value, 1);
+	state.play_state = (BSmart::Game_States::Play_State) value;
+	ok = ok && get(value, 1);
+	state.refbox_cmd = (char) value;
+
+	Ball_Sample& ball = world.ball_model;
+	ok = ok && get(x, 4) && get(y, 4) && get(z, 4);
+	ball.pos = BSmart::Pose3D(x, y, z);
+	ok = ok && get(x, 4) && get(y, 4) && get(z, 4);
+	ball.speed = BSmart::Pose3D(x, y, z);
+	ok = ok && get(value, 1);
+	ball.status = (Sample::Status) value;
+	ok = ok && get(value, 1);
+	ball.last_touched = (Sample::Last_Touched) value;
+	ok = ok && get(x, 1) && get(y, 1);
+	ball.last_touched_robot = BSmart::Int_Vector(x, y);
+
+	int robots = 0;
+	ok = ok && get(robots, 1);
+	robots &= 0xff;
+	world.robot_models.clear();
+	for (int i = 0; ok && i < robots; ++i) {
+		Robot_Sample robot;
+		int rotation, speed_x, speed_y;
+		ok = get(robot.team, 1) && get(robot.id, 1) && get(x, 4) && get(y, 4) && get(rotation, 2)
+				&& get(speed_x, 4) && get(speed_y, 4);
+		robot.pos = BSmart::Pose(x, y, rotation / 1000.);
+		robot.speed = BSmart::Pose(speed_x, speed_y);
+		world.robot_models.push_back(robot);
+	}
+	return ok;
+}
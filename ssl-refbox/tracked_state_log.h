@@ -0,0 +1,63 @@
+#ifndef TRACKED_STATE_LOG_H
+#define TRACKED_STATE_LOG_H
+
+#include <fstream>
+#include <string>
+#include <libbsmart/game_states.h>
+#include "filter_data.h"
+
+/**
+ * @brief Everything SSL_Refbox_Rules reads in one cycle
+ */
+struct Tracked_State {
+    World_Snapshot world;
+    BSmart::Game_States::Play_State play_state;
+    char refbox_cmd;
+};
+
+/**
+ * @class Tracked_State_Source
+ * @brief Input of a replay of the rules, see SSL_Refbox_Rules::set_replay
+ */
+class Tracked_State_Source
+{
+public:
+    virtual ~Tracked_State_Source() {}
+    //false at the end of the replay
+    virtual bool read(Tracked_State&) = 0;
+};
+
+/**
+ * @class Tracked_State_Log
+ * @brief File of the per cycle input of the rules, for replaying the rules
+ * without vision and particle filter.
+ * Positions and speeds are stored as integer millimetres, which is all the
+ * rules look at, so a replay gives the same results as the recorded run.
+ * All numbers are little endian.
+ */
+class Tracked_State_Log : public Tracked_State_Source
+{
+public:
+    Tracked_State_Log();
+    ~Tracked_State_Log();
+
+    bool open_write(const std::string& file);
+    bool open_read(const std::string& file);
+    void close();
+    bool is_open();
+
+    void write(const Tracked_State&);
+    //false at the end of the file or if the file is broken
+    bool read(Tracked_State&);
+
+private:
+    static const char magic[8];
+
+    void put(int value, int bytes);
+    bool get(int& value, int bytes);
+
+    std::ofstream out;
+    std::ifstream in;
+};
+
+#endif //TRACKED_STATE_LOG_H
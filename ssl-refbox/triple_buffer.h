@@ -0,0 +1,46 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <QAtomicInt>
+
+/**
+ * @class Triple_Buffer
+ * @brief Hands values from one writer thread to one reader thread without
+ * locks. The writer fills back() and publishes it, the reader takes the
+ * newest published value with acquire() and reads it with front() until
+ * its next acquire(). Neither side ever waits for the other.
+ */
+template<class T>
+class Triple_Buffer
+{
+public:
+    Triple_Buffer() : back_index(0), middle(1), front_index(2) {}
+
+    //writer
+    T& back() { return buffers[back_index]; }
+    void publish() { back_index = middle.fetchAndStoreOrdered(back_index | FRESH) & INDEX; }
+
+    //reader, false if nothing was published since the last acquire
+    bool acquire()
+    {
+        if (!(middle & FRESH))
+            return false;
+        front_index = middle.fetchAndStoreOrdered(front_index) & INDEX;
+        return true;
+    }
+    const T& front() const { return buffers[front_index]; }
+
+private:
+    enum {
+        INDEX = 3,
+        FRESH = 4
+    };
+
+    T buffers[3];
+    int back_index;
+    //index of the buffer in between, FRESH if the writer put a new value there
+    QAtomicInt middle;
+    int front_index;
+};
+
+#endif //TRIPLE_BUFFER_H
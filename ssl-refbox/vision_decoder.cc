@@ -0,0 +1,353 @@
+#include "vision_decoder.h"
+#include "trace.h"
+#include "async_log.h"
+
+// log4cxx
+using namespace log4cxx;
+LoggerPtr Vision_Decoder::logger(Logger::getLogger("Vision_Decoder"));
+
+Vision_Decoder::Vision_Decoder(Pre_Filter_Data* data_, int number_of_ids_) :
+	data(data_), number_of_ids(number_of_ids_) {
+	if (number_of_ids < 1 || number_of_ids > Filter_Data::NUMBER_OF_IDS) {
+		Async_Log::warn(logger, "robot_ids={} out of range, using {}", number_of_ids, Filter_Data::NUMBER_OF_IDS);
+		number_of_ids = Filter_Data::NUMBER_OF_IDS;
+	}
+	queue_filled = false;
+}
+
+/**
+ * @brief Decode the balls and robots of a frame
+ * @param frame
+ * @param trans_perc Transformed_Percept to store the percepts
+ */
+void Vision_Decoder::decode(const SSL_DetectionFrame& frame, Transformed_Percept& trans_perc) {
+	process_balls(frame, trans_perc);
+	process(frame, trans_perc, 1); // blue
+	process(frame, trans_perc, 0); // yellow
+}
+
+/**
+ * @brief Queue a decoded frame, the directions are analysed against the queued ones
+ * @param trans_perc
+ */
+void Vision_Decoder::push(const Transformed_Percept& trans_perc) {
+	Transformed_Percept transformed_percept = trans_perc;
+	// check done for heuristical reasons
+	analyse_percepts(transformed_percept);
+	tf_percept_queue_all.push_back(transformed_percept);
+}
+
+/**
+ * @brief Take the oldest frame out of the queue and write it into pf_data
+ * @param transformed_percept the frame written
+ * @param drain take frames even if the queue is not filled, e.g. at the end of a log file
+ * @return true if a frame was written
+ */
+bool Vision_Decoder::pop(Transformed_Percept& transformed_percept, bool drain) {
+	// queue is filled when greater than 30 and will be set not filled, if below 10 again
+	if (queue_filled) {
+		if (tf_percept_queue_all.size() < 10) {
+			queue_filled = false;
+			//LOG4CXX_DEBUG(logger, "queue empty");
+		}
+	} else if (tf_percept_queue_all.size() > 30) {
+		queue_filled = true;
+		//LOG4CXX_DEBUG(logger, "queue filled");
+	}
+	if (!queue_filled && !(drain && !tf_percept_queue_all.empty()))
+		return false;
+
+	// take current frame out of buffer and delete it from buffer
+	transformed_percept = tf_percept_queue_all.front();
+	tf_percept_queue_all.erase(tf_percept_queue_all.begin());
+	Trace_Scope trace_scope("vision_handoff", transformed_percept.current_frame,
+				transformed_percept.cam_id);
+
+	// if there are more with only one ball
+	if (tf_percept_queue_one_ball[transformed_percept.cam_id].size() > 0) {
+		// if the first is the same as the current
+		if (transformed_percept.current_frame
+				== tf_percept_queue_one_ball[transformed_percept.cam_id][0].current_frame) {
+			// delete first and go on
+			tf_percept_queue_one_ball[transformed_percept.cam_id].erase(
+					tf_percept_queue_one_ball[transformed_percept.cam_id].begin());
+			// if there is still a frame
+			if (tf_percept_queue_one_ball[transformed_percept.cam_id].size() > 0) {
+				int index = 0;
+				if (tf_percept_queue_one_ball[transformed_percept.cam_id].size() > 1)
+					index = 1;
+				// prepare collision heuristic
+				transformed_percept.ball_direction_after =
+						(tf_percept_queue_one_ball[transformed_percept.cam_id][index].balls[0]
+								- transformed_percept.balls[0]);
+				int timediff = tf_percept_queue_one_ball[transformed_percept.cam_id][index].frame_received
+						- transformed_percept.frame_received;
+				if (timediff == 0) {
+					transformed_percept.ball_direction_after = BSmart::Pose(0., 0., 0.);
+				} else {
+					transformed_percept.ball_direction_after /= timediff;
+				}
+			}
+		}
+	}
+	// if only one robot percept is found
+	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
+		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
+			if (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size() > 0) {
+				// if first is the same as current
+				if (transformed_percept.current_frame
+						== tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][0].current_frame) {
+					// delete first and go on
+					tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].erase(
+							tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].begin());
+					if (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size() > 0) {
+						int index = 0;
+						if (tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size() > 1)
+							index = 1;
+
+						int timediff =
+								(tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][index].frame_received
+										- transformed_percept.frame_received);
+
+						if (timediff == 0) {
+							; //robot_direction_before is used.
+						} else {
+							transformed_percept.robot_direction[team][id] =
+									(tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][index].robots[team][id][0]
+											- transformed_percept.robots[team][id][0]);
+							transformed_percept.robot_direction[team][id] /= timediff;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	//write data from transformed_percept into pf_data
+	reset_data(transformed_percept.cam_id);
+
+	//set frame number
+	data->set_newest_frame(transformed_percept.current_frame);
+	data->set_timestamp(transformed_percept.frame_received);
+
+	if (transformed_percept.balls.size() == 0) {
+		data->set_ball_framenumber(transformed_percept.cam_id, transformed_percept.ball_frame_number);
+		data->set_ball_timestamp(transformed_percept.cam_id, transformed_percept.frame_received);
+	} else {
+		data->clear_balls(transformed_percept.cam_id);
+		data->set_balls(transformed_percept.cam_id, transformed_percept.balls);
+	}
+
+	if (transformed_percept.has_one_ball) {
+		data->set_ball_direction_before(transformed_percept.ball_direction_before);
+		data->set_ball_direction_after(transformed_percept.ball_direction_after);
+	}
+
+	for (unsigned int i = 0; i < transformed_percept.percepted_robots.size(); ++i) {
+		int team = transformed_percept.percepted_robots[i].x;
+		int id = transformed_percept.percepted_robots[i].y;
+		data->set_robots(transformed_percept.cam_id, team, id, transformed_percept.robots[team][id]);
+		if (transformed_percept.has_one_robot[team][id]) {
+			data->set_robot_direction(team, id, transformed_percept.robot_direction[team][id]);
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Process ball(s) by assigning trans_perc values to the Ball Percept
+ * @param frame
+ * @param trans_perc
+ */
+void Vision_Decoder::process_balls(const SSL_DetectionFrame& frame, Transformed_Percept& trans_perc) {
+	int n_balls = frame.balls_size();
+	Ball_Percept pBall;
+
+	trans_perc.cam_id = frame.camera_id();
+
+	if (n_balls == 0) {
+		trans_perc.ball_frame_number = frame.frame_number();
+	} else {
+		for (int i = 0; i < n_balls; ++i) {
+			const SSL_DetectionBall& ball = frame.balls(i);
+			pBall.x = ball.x();
+			pBall.y = ball.y();
+			pBall.confidence = ball.confidence() * 100;
+			pBall.framenumber = frame.frame_number();
+			pBall.cam = frame.camera_id();
+			pBall.timestamp = frame.t_capture() * 1000;
+
+			if (!(pBall.x == 0. && pBall.y == 0.))
+				trans_perc.balls.push_back(pBall);
+		}
+	}
+}
+
+/**
+ * @brief Process robots of the team with the given color.
+ * Create a robot percept and assign to it the values from the trans_perc.<br />
+ * @param frame
+ * @param trans_perc Transformed_Percept
+ * @param color 1 -> blue, 0 -> yellow
+ */
+void Vision_Decoder::process(const SSL_DetectionFrame& frame, Transformed_Percept& trans_perc, char color) {
+	int n_bots = color == 1 ? frame.robots_blue_size() : frame.robots_yellow_size();
+
+	for (int i = 0; i < n_bots; ++i) {
+		const SSL_DetectionRobot& robot = color == 1 ? frame.robots_blue(i) : frame.robots_yellow(i);
+
+		/* following code doesn't work anymore...
+		 * It seems, that it expects the origin of coordinates not in the
+		 * middle of the field and thus are not negative...
+		 * Anyway, without this code, everything runs fine :)
+		 */
+//              if ( (robot.pixel_y() + robot_r > cam_height)
+//              || (robot.pixel_y() - robot_r < 0)
+//              || (robot.pixel_x() + robot_r > cam_width)
+//              || (robot.pixel_x() - robot_r < 0) ) {
+//              continue;
+//              }
+		Robot_Percept pRobot;
+		pRobot.x = robot.x();
+		pRobot.y = robot.y();
+		pRobot.id = robot.robot_id();
+		if (pRobot.id < 0 || pRobot.id >= number_of_ids) {
+			Async_Log::debug(logger, "Dropped robot with id {} (robot_ids={})", pRobot.id, number_of_ids);
+			continue;
+		}
+		pRobot.color = color == 1 ? SSLRefbox::Colors::BLUE : SSLRefbox::Colors::YELLOW;
+		pRobot.rotation_known = robot.has_orientation();
+		if (pRobot.rotation_known) {
+			pRobot.rotation = robot.orientation();
+			//LOG4CXX_DEBUG(logger, pRobot.rotation);
+		}
+
+		pRobot.confidence = robot.confidence() * 100;
+		pRobot.framenumber = frame.frame_number();
+		pRobot.cam = frame.camera_id();
+		pRobot.timestamp = frame.t_capture() * 1000;
+
+		if (trans_perc.robots[(int) color][pRobot.id].empty())
+			trans_perc.percepted_robots.push_back(BSmart::Int_Vector(color, pRobot.id));
+		trans_perc.robots[(int) color][pRobot.id].push_back(pRobot);
+	}
+}
+
+/**
+ * @brief Reset data (balls and robots)
+ * @param cam Camera id
+ */
+void Vision_Decoder::reset_data(int cam) {
+	//LOG4CXX_DEBUG ( logger, "reset_data" );
+	//Ball_Percept pBall;
+	//clear ball vector
+	data->clear_balls(cam);
+	//clear robots
+	data->clear_robots(cam);
+}
+
+/**
+ * @brief Reset everything in tranformed_percept.
+ * @param trans_perc
+ */
+void Vision_Decoder::reset_transformed_percept(Transformed_Percept& trans_perc) {
+	trans_perc.cam_id = 0;
+	trans_perc.ball_frame_number = 0;
+	trans_perc.balls.clear();
+	trans_perc.has_one_ball = false;
+	trans_perc.ball_direction_before.x = 0.;
+	trans_perc.ball_direction_before.y = 0.;
+	trans_perc.ball_direction_after.x = 0.;
+	trans_perc.ball_direction_after.y = 0.;
+
+	for (int team = 0; team < Filter_Data::NUMBER_OF_TEAMS; ++team) {
+		for (int id = 0; id < Filter_Data::NUMBER_OF_IDS; ++id) {
+			trans_perc.robots[team][id].clear();
+			trans_perc.has_one_robot[team][id] = false;
+			trans_perc.robot_direction[team][id].x = 0.;
+			trans_perc.robot_direction[team][id].y = 0.;
+		}
+	}
+	trans_perc.percepted_robots.clear();
+
+	trans_perc.refbox_cmd = "";
+	trans_perc.current_frame = 0;
+	trans_perc.sleep_time = 0;
+	trans_perc.frame_received = 0;
+}
+
+/**
+ * @brief Analyze transformed_percept and set some values
+ * Robots and ball will be analyzed.
+ * @param transformed_percept
+ */
+void Vision_Decoder::analyse_percepts(Transformed_Percept& transformed_percept) {
+
+	// if only one ball in percept found
+	if (transformed_percept.balls.size() == 1) {
+		transformed_percept.has_one_ball = true;
+
+		int size_one_ball = tf_percept_queue_one_ball[transformed_percept.cam_id].size();
+
+		if (size_one_ball == 1) {
+			transformed_percept.ball_direction_before = (transformed_percept.balls[0]
+					- tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].balls[0]);
+			int timediff = (transformed_percept.frame_received
+					- tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].frame_received);
+
+			if (timediff == 0) {
+				transformed_percept.ball_direction_before =
+						tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].ball_direction_before;
+			} else {
+				transformed_percept.ball_direction_before /= timediff;
+			}
+		} else if (size_one_ball > 1) {
+			int diff = 2;
+			if (size_one_ball > 2)
+				diff = 3;
+			transformed_percept.ball_direction_before =
+					(tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].balls[0]
+							- tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - diff].balls[0]);
+			int timediff = (tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - 1].frame_received
+					- tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - diff].frame_received);
+
+			if (timediff == 0) {
+				transformed_percept.ball_direction_before =
+						tf_percept_queue_one_ball[transformed_percept.cam_id][size_one_ball - diff].ball_direction_before;
+			} else {
+				transformed_percept.ball_direction_before /= timediff;
+			}
+
+		}
+		tf_percept_queue_one_ball[transformed_percept.cam_id].push_back(transformed_percept);
+	}
+
+	//if only one robot percept per robot is found
+	for (unsigned int i = 0; i < transformed_percept.percepted_robots.size(); ++i) {
+		int team = transformed_percept.percepted_robots[i].x;
+		int id = transformed_percept.percepted_robots[i].y;
+		if (transformed_percept.robots[team][id].size() == 1) {
+			transformed_percept.has_one_robot[team][id] = true;
+
+			int size_one_robot = tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].size();
+			if (size_one_robot > 0) {
+				transformed_percept.robot_direction[team][id] =
+						(transformed_percept.robots[team][id][0]
+								- tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][size_one_robot
+										- 1].robots[team][id][0]);
+				int timediff =
+						(transformed_percept.frame_received
+								- tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][size_one_robot
+										- 1].frame_received);
+
+				if (timediff == 0) {
+					transformed_percept.robot_direction[team][id] =
+							tf_percept_queue_one_robot[transformed_percept.cam_id][team][id][size_one_robot - 1].robot_direction[team][id];
+				} else {
+					transformed_percept.robot_direction[team][id] /= timediff;
+				}
+			}
+			tf_percept_queue_one_robot[transformed_percept.cam_id][team][id].push_back(transformed_percept);
+		}
+	}
+}
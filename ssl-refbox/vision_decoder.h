@@ -0,0 +1,76 @@
+#ifndef VISION_DECODER_H
+#define VISION_DECODER_H
+
+#include <vector>
+#include <string>
+#include <proto/messages_robocup_ssl_detection.pb.h>
+#include "pre_filter_data.h"
+#include <log4cxx/logger.h>
+
+/**
+ * @brief data store for current data received from SSL-vision/log file
+ */
+struct Transformed_Percept
+{
+    int cam_id;
+    unsigned int ball_frame_number;
+    Ball_Percept_List balls;
+    bool has_one_ball;
+    BSmart::Pose ball_direction_before;
+    BSmart::Pose ball_direction_after;
+
+    Robot_Percept_List robots[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+    bool has_one_robot[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+    BSmart::Pose robot_direction[Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+    //(team, id) of all robots in robots[][], so empty slots can be skipped
+    std::vector<BSmart::Int_Vector> percepted_robots;
+
+    std::string refbox_cmd;
+    int current_frame;
+    int sleep_time;
+    BSmart::Time_Value frame_received;
+    //monotonic us when the frame was received, for the latency metrics
+    long long received_us;
+
+};
+
+/**
+ * @class Vision_Decoder
+ * @brief Turns detection frames into the percepts of Pre_Filter_Data.
+ * The frames are queued, so the ball and robot directions are estimated from
+ * the frames before and after. SSLVision feeds it from ssl-vision or a log
+ * file, Pipeline_Replay from a log file as fast as possible.
+ */
+class Vision_Decoder
+{
+public:
+    // robots with ids from number_of_ids are dropped
+    Vision_Decoder(Pre_Filter_Data*, int number_of_ids);
+
+    static void reset_transformed_percept(Transformed_Percept&);
+    // adds the ball and robot percepts of the frame to trans_perc
+    void decode(const SSL_DetectionFrame&, Transformed_Percept&);
+    // queues a decoded frame
+    void push(const Transformed_Percept&);
+    // writes the oldest queued frame to Pre_Filter_Data once the queue is
+    // filled, with drain as long as there is one; false: nothing written
+    bool pop(Transformed_Percept&, bool drain = false);
+    void reset_data(int cam);
+
+private:
+    static log4cxx::LoggerPtr logger;
+
+    void process_balls(const SSL_DetectionFrame&, Transformed_Percept&);
+    void process(const SSL_DetectionFrame&, Transformed_Percept&, char);
+    void analyse_percepts(Transformed_Percept&);
+
+    Pre_Filter_Data* data;
+    int number_of_ids;
+
+    bool queue_filled;
+    std::vector<Transformed_Percept> tf_percept_queue_all;
+    std::vector<Transformed_Percept> tf_percept_queue_one_ball[2];
+    std::vector<Transformed_Percept> tf_percept_queue_one_robot[2][Filter_Data::NUMBER_OF_TEAMS][Filter_Data::NUMBER_OF_IDS];
+};
+
+#endif //VISION_DECODER_H
@@ -0,0 +1,79 @@
+/**
+ * @file main.cc
+ * @brief Synthetic ssl-vision for load tests of the refbox
+ */
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vision_sim.h"
+
+using namespace std;
+
+/**
+ * @brief Returns the value of option i, exits if it is missing
+ */
+static const char* value(int argc, char* argv[], int i) {
+	if (i + 1 >= argc) {
+		fprintf(stderr, "Missing parameter for option %s\n", argv[i]);
+		exit(1);
+	}
+	return argv[i + 1];
+}
+
+int main(int argc, char* argv[]) {
+	Vision_Sim::Settings settings;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+			printf("Following options are available:\n");
+			printf("%-20s %s\n", "-h (--help)", "Print this help");
+			printf("%-20s %s\n", "--ip address", "Multicast group (default 224.5.23.2)");
+			printf("%-20s %s\n", "--port port", "Port, ssl_vision_port of the refbox (default 40101)");
+			printf("%-20s %s\n", "--cameras n", "Cameras, each sees one strip of the field (default 2,");
+			printf("%-20s %s\n", "", "the refbox uses cameras 0 and 1)");
+			printf("%-20s %s\n", "--robots n", "Robots per team (default 6)");
+			printf("%-20s %s\n", "--rate hz", "Frames per second and camera (default 60)");
+			printf("%-20s %s\n", "--noise mm", "Standard deviation of the positions (default 3)");
+			printf("%-20s %s\n", "--loss percent", "Lost packets (default 0)");
+			printf("%-20s %s\n", "--reorder percent", "Packets sent after the next one (default 0)");
+			printf("%-20s %s\n", "--duration s", "Stop after s seconds (default: never)");
+			printf("%-20s %s\n", "--script file", "Ball events, one per line: <s> place <x mm> <y mm>,");
+			printf("%-20s %s\n", "", "<s> kick <vx m/s> <vy m/s>, <s> chip <vx> <vy> <vz m/s>");
+			printf("%-20s %s\n", "", "(default: a kick or chip every 3 s)");
+			printf("%-20s %s\n", "--seed n", "Seed of the noise, robots and kicks (default 42)");
+			exit(0);
+		} else if (strcmp(argv[i], "--ip") == 0) {
+			settings.ip = value(argc, argv, i++);
+		} else if (strcmp(argv[i], "--port") == 0) {
+			settings.port = atoi(value(argc, argv, i++));
+		} else if (strcmp(argv[i], "--cameras") == 0) {
+			settings.cameras = atoi(value(argc, argv, i++));
+		} else if (strcmp(argv[i], "--robots") == 0) {
+			settings.robots = atoi(value(argc, argv, i++));
+		} else if (strcmp(argv[i], "--rate") == 0) {
+			settings.rate = atof(value(argc, argv, i++));
+		} else if (strcmp(argv[i], "--noise") == 0) {
+			settings.noise = atof(value(argc, argv, i++));
+		} else if (strcmp(argv[i], "--loss") == 0) {
+			settings.loss = atof(value(argc, argv, i++)) / 100.;
+		} else if (strcmp(argv[i], "--reorder") == 0) {
+			settings.reorder = atof(value(argc, argv, i++)) / 100.;
+		} else if (strcmp(argv[i], "--duration") == 0) {
+			settings.duration = atof(value(argc, argv, i++));
+		} else if (strcmp(argv[i], "--script") == 0) {
+			settings.script = value(argc, argv, i++);
+		} else if (strcmp(argv[i], "--seed") == 0) {
+			settings.seed = atoi(value(argc, argv, i++));
+		} else {
+			fprintf(stderr, "Unknown option %s, see --help\n", argv[i]);
+			exit(1);
+		}
+	}
+	if (settings.cameras < 1 || settings.robots < 0 || settings.rate <= 0.) {
+		fprintf(stderr, "Need at least one camera, no negative robots and a positive rate\n");
+		exit(1);
+	}
+
+	Vision_Sim sim(settings);
+	return sim.run() ? 0 : 1;
+}
@@ -0,0 +1,415 @@
+#include "vision_sim.h"
+#include <proto/messages_robocup_ssl_wrapper.pb.h>
+#include <libbsmart/field.h>
+#include <libbsmart/math.h>
+#include <libbsmart/systemcall.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <time.h>
+
+Vision_Sim::Settings::Settings() :
+	ip("224.5.23.2"), script("") {
+	port = 40101;
+	cameras = 2;
+	robots = 6;
+	rate = 60.;
+	noise = 3.;
+	loss = 0.;
+	reorder = 0.;
+	duration = 0.;
+	seed = 42;
+}
+
+Vision_Sim::Vision_Sim(const Settings& settings_) :
+	settings(settings_) {
+	socket = 0;
+	next = 0;
+	next_kick = KICK_INTERVAL / 1000.;
+	kicks = 0;
+	time = 0.;
+	sent = lost = reordered = 0;
+	ball.x = ball.y = ball.z = 0.;
+	ball.vx = ball.vy = ball.vz = 0.;
+}
+
+Vision_Sim::~Vision_Sim() {
+	delete socket;
+}
+
+/**
+ * One event per line: <seconds> place <x mm> <y mm>, <seconds> kick <vx m/s>
+ * <vy m/s> or <seconds> chip <vx m/s> <vy m/s> <vz m/s>, # starts a comment
+ */
+bool Vision_Sim::read_script() {
+	std::ifstream in(settings.script.c_str());
+	if (!in) {
+		std::cerr << "Could not read script " << settings.script << std::endl;
+		return false;
+	}
+	std::string line;
+	int number = 0;
+	while (std::getline(in, line)) {
+		++number;
+		std::string::size_type comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+		std::istringstream fields(line);
+		Event event;
+		std::string type;
+		if (!(fields >> event.time))
+			continue;
+		event.z = 0.;
+		fields >> type;
+		if (type == "place") {
+			event.type = Event::PLACE;
+			fields >> event.x >> event.y;
+		} else if (type == "kick") {
+			event.type = Event::KICK;
+			fields >> event.x >> event.y;
+		} else if (type == "chip") {
+			event.type = Event::CHIP;
+			fields >> event.x >> event.y >> event.z;
+		} else {
+			fields.setstate(std::ios::failbit);
+		}
+		if (!fields) {
+			std::cerr << settings.script << ":" << number << ": unknown event" << std::endl;
+			return false;
+		}
+		events.push_back(event);
+	}
+	std::stable_sort(events.begin(), events.end(), earlier);
+	return true;
+}
+
+/**
+ * Yellow in the left half, blue in the right half, each robot on its own
+ * circle with its own speed
+ */
+void Vision_Sim::create_robots() {
+	for (int team = 0; team < 2; ++team) {
+		for (int id = 0; id < settings.robots; ++id) {
+			Robot robot;
+			robot.id = id;
+			robot.blue = team == 1;
+			double side = robot.blue ? 1. : -1.;
+			robot.cx = side * (500. + uniform() * (BSmart::Field::half_field_width - 1000.));
+			robot.cy = (uniform() * 2. - 1.) * (BSmart::Field::half_field_height - 700.);
+			robot.radius = 200. + uniform() * 400.;
+			robot.phase = uniform() * BSmart::pi2;
+			// up to 2 m/s
+			robot.omega = (0.5 + uniform() * 1.5) * 1000. / robot.radius * (uniform() < 0.5 ? -1. : 1.);
+			robots.push_back(robot);
+		}
+	}
+	step(0.);
+}
+
+bool Vision_Sim::earlier(const Event& a, const Event& b) {
+	return a.time < b.time;
+}
+
+void Vision_Sim::apply(const Event& event) {
+	switch (event.type) {
+	case Event::PLACE:
+		ball.x = event.x;
+		ball.y = event.y;
+		ball.z = 0.;
+		ball.vx = ball.vy = ball.vz = 0.;
+		break;
+	case Event::CHIP:
+		ball.vz = event.z * 1000.;
+		// no break, a chip is a kick upwards
+	case Event::KICK:
+		ball.vx = event.x * 1000.;
+		ball.vy = event.y * 1000.;
+		break;
+	}
+}
+
+/**
+ * The events of the script up to time, without a script a kick or every
+ * third time a chip in a random direction every KICK_INTERVAL
+ */
+void Vision_Sim::next_event(double now) {
+	if (!settings.script.empty()) {
+		while (next < events.size() && events[next].time <= now)
+			apply(events[next++]);
+		return;
+	}
+	if (now < next_kick)
+		return;
+	next_kick += KICK_INTERVAL / 1000.;
+	Event event;
+	event.time = now;
+	event.type = ++kicks % 3 == 0 ? Event::CHIP : Event::KICK;
+	double direction = uniform() * BSmart::pi2;
+	double speed = 2. + uniform() * 4.;
+	event.x = cos(direction) * speed;
+	event.y = sin(direction) * speed;
+	event.z = 3.;
+	apply(event);
+}
+
+void Vision_Sim::step(double dt) {
+	time += dt;
+	for (unsigned int i = 0; i < robots.size(); ++i) {
+		Robot& robot = robots[i];
+		double angle = robot.phase + robot.omega * time;
+		robot.x = robot.cx + cos(angle) * robot.radius;
+		robot.y = robot.cy + sin(angle) * robot.radius;
+		robot.orientation = BSmart::normalize(angle + (robot.omega > 0. ? BSmart::pi_2 : -BSmart::pi_2));
+	}
+
+	const double gravity = 9810.; // mm/s^2
+	const double rolling_friction = 500.; // mm/s^2
+	ball.x += ball.vx * dt;
+	ball.y += ball.vy * dt;
+	if (ball.z > 0. || ball.vz != 0.) {
+		ball.z += ball.vz * dt;
+		ball.vz -= gravity * dt;
+		if (ball.z <= 0.) {
+			// bounces with half the speed until it rolls
+			ball.z = 0.;
+			ball.vz = ball.vz < -500. ? -ball.vz * 0.5 : 0.;
+		}
+	} else {
+		double speed = sqrt(ball.vx * ball.vx + ball.vy * ball.vy);
+		double slower = speed > 0. ? std::max(0., speed - rolling_friction * dt) / speed : 0.;
+		ball.vx *= slower;
+		ball.vy *= slower;
+	}
+
+	// the boundary reflects the ball
+	double max_x = BSmart::Field::half_field_width + BSmart::Field::off_width;
+	double max_y = BSmart::Field::half_field_height + BSmart::Field::off_width;
+	if (fabs(ball.x) > max_x) {
+		ball.x = ball.x > 0. ? max_x : -max_x;
+		ball.vx = -ball.vx * 0.5;
+	}
+	if (fabs(ball.y) > max_y) {
+		ball.y = ball.y > 0. ? max_y : -max_y;
+		ball.vy = -ball.vy * 0.5;
+	}
+}
+
+double Vision_Sim::strip_min(int camera) const {
+	double width = BSmart::Field::width / (double) settings.cameras;
+	return -BSmart::Field::width / 2. + camera * width;
+}
+
+double Vision_Sim::strip_max(int camera) const {
+	return strip_min(camera + 1);
+}
+
+bool Vision_Sim::sees(int camera, double x) const {
+	return x >= strip_min(camera) - OVERLAP && x <= strip_max(camera) + OVERLAP;
+}
+
+void Vision_Sim::fill_detection(SSL_WrapperPacket& packet, int camera, unsigned int frame_number,
+		double t_capture) {
+	SSL_DetectionFrame* frame = packet.mutable_detection();
+	frame->set_frame_number(frame_number);
+	frame->set_t_capture(t_capture);
+	frame->set_camera_id(camera);
+
+	// image coordinates of a 780x580 camera over the strip
+	double pixels_per_mm_x = 780. / (strip_max(camera) - strip_min(camera) + 2 * OVERLAP);
+	double pixels_per_mm_y = 580. / BSmart::Field::height;
+	double pixel_x0 = strip_min(camera) - OVERLAP;
+	double pixel_y0 = -BSmart::Field::height / 2.;
+
+	if (sees(camera, ball.x)) {
+		// ssl-vision projects a ball in the air onto the ground, away from the camera
+		double camera_x = (strip_min(camera) + strip_max(camera)) / 2.;
+		double scale = CAMERA_HEIGHT / (CAMERA_HEIGHT - std::min(ball.z, CAMERA_HEIGHT - 100.));
+		SSL_DetectionBall* detected = frame->add_balls();
+		double x = camera_x + (ball.x - camera_x) * scale + gaussian() * settings.noise;
+		double y = ball.y * scale + gaussian() * settings.noise;
+		detected->set_confidence(0.9 + 0.1 * uniform());
+		detected->set_x(x);
+		detected->set_y(y);
+		detected->set_pixel_x((x - pixel_x0) * pixels_per_mm_x);
+		detected->set_pixel_y((y - pixel_y0) * pixels_per_mm_y);
+		detected->set_area(80);
+	}
+	for (unsigned int i = 0; i < robots.size(); ++i) {
+		const Robot& robot = robots[i];
+		if (!sees(camera, robot.x))
+			continue;
+		SSL_DetectionRobot* detected = robot.blue ? frame->add_robots_blue() : frame->add_robots_yellow();
+		double x = robot.x + gaussian() * settings.noise;
+		double y = robot.y + gaussian() * settings.noise;
+		detected->set_confidence(0.9 + 0.1 * uniform());
+		detected->set_robot_id(robot.id);
+		detected->set_x(x);
+		detected->set_y(y);
+		detected->set_orientation(BSmart::normalize(robot.orientation + gaussian() * settings.noise * 0.005));
+		detected->set_pixel_x((x - pixel_x0) * pixels_per_mm_x);
+		detected->set_pixel_y((y - pixel_y0) * pixels_per_mm_y);
+		detected->set_height(150.);
+	}
+	frame->set_t_sent(now());
+}
+
+void Vision_Sim::fill_geometry(SSL_WrapperPacket& packet) {
+	SSL_GeometryData* geometry = packet.mutable_geometry();
+	SSL_GeometryFieldSize* field = geometry->mutable_field();
+	field->set_line_width(10);
+	field->set_field_length(BSmart::Field::field_width);
+	field->set_field_width(BSmart::Field::field_height);
+	field->set_boundary_width(BSmart::Field::off_width);
+	field->set_referee_width(425);
+	field->set_goal_width(700);
+	field->set_goal_depth(180);
+	field->set_goal_wall_width(20);
+	field->set_center_circle_radius(500);
+	field->set_defense_radius(500);
+	field->set_defense_stretch(350);
+	field->set_free_kick_from_defense_dist(200);
+	field->set_penalty_spot_from_field_line_dist(450);
+	field->set_penalty_line_from_spot_dist(400);
+
+	// every camera CAMERA_HEIGHT above the middle of its strip
+	for (int camera = 0; camera < settings.cameras; ++camera) {
+		SSL_GeometryCameraCalibration* calib = geometry->add_calib();
+		calib->set_camera_id(camera);
+		calib->set_focal_length(500.);
+		calib->set_principal_point_x(390.);
+		calib->set_principal_point_y(290.);
+		calib->set_distortion(0.);
+		calib->set_q0(1.);
+		calib->set_q1(0.);
+		calib->set_q2(0.);
+		calib->set_q3(0.);
+		calib->set_tx(0.);
+		calib->set_ty(0.);
+		calib->set_tz(CAMERA_HEIGHT);
+		calib->set_derived_camera_world_tx((strip_min(camera) + strip_max(camera)) / 2.);
+		calib->set_derived_camera_world_ty(0.);
+		calib->set_derived_camera_world_tz(CAMERA_HEIGHT);
+	}
+}
+
+/**
+ * Loses the packet with the probability loss. With the probability reorder
+ * the packet waits and is sent after the next one.
+ */
+void Vision_Sim::send(const SSL_WrapperPacket& packet) {
+	if (uniform() < settings.loss) {
+		++lost;
+		return;
+	}
+	std::string data;
+	packet.SerializeToString(&data);
+	if (held.empty() && uniform() < settings.reorder) {
+		held = data;
+		++reordered;
+		return;
+	}
+	write(data);
+	if (!held.empty()) {
+		write(held);
+		held.clear();
+	}
+}
+
+void Vision_Sim::write(const std::string& data) {
+	try {
+		socket->write(data.data(), data.size());
+		++sent;
+	} catch (BSmart::IO_Exception e) {
+		std::cerr << "send: " << e.what() << std::endl;
+	}
+}
+
+double Vision_Sim::gaussian() {
+	// polar method, as Sample::fuettere_polarbaer
+	double q = 0., a1 = 0., a2 = 0.;
+	while (q <= 0. || q > 1.) {
+		a1 = 2. * uniform() - 1.;
+		a2 = 2. * uniform() - 1.;
+		q = a1 * a1 + a2 * a2;
+	}
+	return a1 * sqrt(-2. * log(q) / q);
+}
+
+double Vision_Sim::uniform() {
+	return rand() / ((double) RAND_MAX + 1.);
+}
+
+//wall clock in s, as t_capture of ssl-vision
+double Vision_Sim::now() {
+	return BSmart::Systemcall::get_timef() / 1000.;
+}
+
+/**
+ * The cameras take turns, camera c sends at c / cameras of the frame
+ * period. The world moves between two cameras.
+ */
+bool Vision_Sim::run() {
+	srand(settings.seed);
+	if (!settings.script.empty() && !read_script())
+		return false;
+	try {
+		socket = new BSmart::Multicast_Socket();
+		socket->set_target(settings.ip.c_str(), settings.port);
+	} catch (BSmart::IO_Exception e) {
+		std::cerr << "Could not open " << settings.ip << ":" << settings.port << ": " << e.what() << std::endl;
+		return false;
+	}
+	create_robots();
+
+	std::cout << "Sending " << settings.cameras << " cameras at " << settings.rate << " Hz with "
+			<< settings.robots << " robots per team to " << settings.ip << ":" << settings.port << std::endl;
+
+	const double slot = 1. / (settings.rate * settings.cameras);
+	std::vector<unsigned int> frame_numbers(settings.cameras, 0);
+	double next_geometry = 0.;
+	double next_report = 1.;
+	unsigned long reported = 0;
+
+	struct timespec wakeup;
+	clock_gettime(CLOCK_MONOTONIC, &wakeup);
+	for (long n = 0; settings.duration <= 0. || time < settings.duration; ++n) {
+		int camera = n % settings.cameras;
+		next_event(time);
+
+		if (time >= next_geometry) {
+			SSL_WrapperPacket geometry;
+			fill_geometry(geometry);
+			std::string data;
+			geometry.SerializeToString(&data);
+			write(data);
+			next_geometry += GEOMETRY_INTERVAL / 1000.;
+		}
+
+		SSL_WrapperPacket packet;
+		fill_detection(packet, camera, frame_numbers[camera]++, now());
+		send(packet);
+
+		if (time >= next_report) {
+			std::cout << (int) time << " s: " << sent - reported << " packets/s, " << lost << " lost, "
+					<< reordered << " reordered" << std::endl;
+			reported = sent;
+			next_report += 1.;
+		}
+
+		// absolute deadlines, so the rate does not drift
+		wakeup.tv_nsec += (long) (slot * 1e9);
+		while (wakeup.tv_nsec >= 1000000000L) {
+			wakeup.tv_nsec -= 1000000000L;
+			++wakeup.tv_sec;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, 0);
+		step(slot);
+	}
+	if (!held.empty())
+		write(held);
+	std::cout << sent << " packets sent, " << lost << " lost, " << reordered << " reordered" << std::endl;
+	return true;
+}
@@ -0,0 +1,126 @@
+#ifndef VISION_SIM_H
+#define VISION_SIM_H
+
+#include <string>
+#include <vector>
+#include <libbsmart/multicast_socket.h>
+
+class SSL_WrapperPacket;
+
+/**
+ * @class Vision_Sim
+ * @brief Publishes synthetic ssl-vision frames (SSL_WrapperPacket) over
+ * multicast, for load tests of the refbox without a field.
+ * The field is split along its length into one strip per camera, every
+ * camera sends the ball and robots of its strip (with some overlap) at
+ * its own offset within the frame period. Positions get gaussian noise,
+ * packets can be lost or reordered. The ball rolls, flies with gravity
+ * and is kicked or chipped by a script, or every few seconds without one.
+ */
+class Vision_Sim
+{
+public:
+    struct Settings {
+        std::string ip;
+        int port;
+        int cameras;
+        //per team
+        int robots;
+        //frames per second and camera
+        double rate;
+        //standard deviation of the positions in mm
+        double noise;
+        //probability of a lost packet
+        double loss;
+        //probability of a packet sent after the next one
+        double reorder;
+        //seconds, 0: until interrupted
+        double duration;
+        std::string script;
+        int seed;
+
+        Settings();
+    };
+
+    explicit Vision_Sim(const Settings&);
+    ~Vision_Sim();
+
+    //false if the script or the socket could not be opened
+    bool run();
+
+private:
+    enum {
+        //mm of the neighbouring strips a camera also sees
+        OVERLAP = 250,
+        //mm above the field
+        CAMERA_HEIGHT = 4000,
+        //ms between geometry packets
+        GEOMETRY_INTERVAL = 1000,
+        //ms between kicks without a script
+        KICK_INTERVAL = 3000
+    };
+
+    struct Event {
+        double time; // s
+        enum Type {
+            PLACE, KICK, CHIP
+        } type;
+        // mm for PLACE, m/s for KICK and CHIP
+        double x, y, z;
+    };
+
+    struct Robot {
+        int id;
+        bool blue;
+        // on a circle around cx, cy
+        double cx, cy, radius, phase, omega;
+        double x, y, orientation;
+    };
+
+    struct Ball {
+        // mm, mm/s
+        double x, y, z;
+        double vx, vy, vz;
+    };
+
+    bool read_script();
+    static bool earlier(const Event&, const Event&);
+    void create_robots();
+    void step(double dt);
+    void apply(const Event&);
+    void next_event(double time);
+
+    void fill_detection(SSL_WrapperPacket&, int camera, unsigned int frame_number, double t_capture);
+    void fill_geometry(SSL_WrapperPacket&);
+    void send(const SSL_WrapperPacket&);
+    void write(const std::string& data);
+    //camera of the strip, x range with overlap
+    double strip_min(int camera) const;
+    double strip_max(int camera) const;
+    bool sees(int camera, double x) const;
+
+    double gaussian();
+    double uniform();
+
+    static double now();
+
+    Settings settings;
+    BSmart::Multicast_Socket* socket;
+
+    std::vector<Event> events;
+    unsigned int next;
+    double next_kick;
+    int kicks;
+
+    std::vector<Robot> robots;
+    Ball ball;
+    double time;
+
+    // reordering: the packet waiting for the next one
+    std::string held;
+    unsigned long sent;
+    unsigned long lost;
+    unsigned long reordered;
+};
+
+#endif //VISION_SIM_H